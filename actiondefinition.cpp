@@ -0,0 +1,125 @@
+#include "actiondefinition.h"
+#include <QHash>
+#include <QJsonDocument>
+
+bool InputDefinition::typeFromString(const QString &text, Type *type)
+{
+    static const QHash<QString, Type> Types = {
+        { "text", Text }, { "string", Text }, { "file", File }, { "folder", Folder },
+        { "number", Number }, { "bool", Bool }, { "checkbox", Bool }, { "choice", Choice }
+    };
+
+    auto it = Types.constFind(text.isEmpty() ? QStringLiteral("text") : text);
+    if (it == Types.constEnd()) return false;
+    *type = it.value();
+    return true;
+}
+
+InputDefinition InputDefinition::fromJson(const QJsonObject &object)
+{
+    InputDefinition input;
+    input.id = object.value("id").toString();
+    input.name = object.value("name").toString(input.id);
+    typeFromString(object.value("type").toString(), &input.type);
+    input.required = object.value("required").toBool(false);
+    if (object.contains("default")) input.defaultValue = object.value("default").toVariant();
+    input.trueValue = object.value("true_value").toString(input.trueValue);
+    input.falseValue = object.value("false_value").toString(input.falseValue);
+
+    const QJsonValue filters = object.value("filters");
+    if (filters.isString()) {
+        input.filters.append(filters.toString());
+    } else {
+        for (const QJsonValue &filter : filters.toArray()) input.filters.append(filter.toString());
+    }
+    for (const QJsonValue &choice : object.value("choices").toArray()) input.choices.append(choice.toString());
+    return input;
+}
+
+ActionDefinition ActionDefinition::fromJson(const QJsonObject &object)
+{
+    ActionDefinition action;
+    action.id = object.value("id").toString();
+    action.name = object.value("name").toString();
+    action.icon = object.value("icon").toString();
+    action.category = object.value("category").toString("tools");
+    action.description = object.value("description").toString();
+    action.type = object.value("type").toString();
+    action.kind = kindFromType(action.type);
+    action.command = object.value("command").toString();
+    action.commandTemplate = CommandTemplate::compile(action.command);
+    action.setInputs(object.value("inputs").toArray());
+    action.pool = object.value("pool").toString();
+    action.cacheable = object.value("cacheable").toBool(false);
+    action.limits = JobLimits::fromJson(object.value("limits").toObject());
+    // GUI launchers outlive the click; only what needs a job is tracked unasked
+    const bool needsJob = !action.pool.isEmpty() || action.cacheable || !action.limits.isEmpty();
+    action.detached = object.value("detached").toBool(!needsJob);
+    action.schedule = object.value("schedule").toString();
+    action.watch = object.value("watch").toObject();
+    action.batchMode = object.value("batch").toString() == "chunked" ? Chunked : PerFile;
+    action.maxParallel = qMax(0, object.value("max_parallel").toInt());
+    action.source = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    return action;
+}
+
+ActionDefinition::Kind ActionDefinition::kindFromType(const QString &type)
+{
+    if (type == "exe") return Exe;
+    if (type == "exe_with_args" || type == "exe_with_input") return ExeWithArgs;
+    if (type == "exe_in_cmd") return ExeInCmd;
+    if (type == "exe_admin") return ExeAdmin;
+    if (type == "workflow") return Workflow;
+    return UnknownKind;
+}
+
+void ActionDefinition::setInputs(const QJsonArray &declared)
+{
+    inputs = declared;
+    inputDefs.clear();
+    inputDefs.reserve(declared.size());
+    hasNonFileInputs = false;
+
+    for (const QJsonValue &value : declared) {
+        InputDefinition input = InputDefinition::fromJson(value.toObject());
+        if (input.id != "file") hasNonFileInputs = true;
+        inputDefs.append(std::move(input));
+    }
+}
+
+bool ActionDefinition::resolveInputs(const QVariantMap &given, QVariantMap *resolved, QString *error,
+                                     bool pathsProvided) const
+{
+    *resolved = given;
+
+    for (const InputDefinition &input : inputDefs) {
+        if (pathsProvided && input.isPath()) continue;
+
+        auto it = resolved->find(input.id);
+        if (it == resolved->end() || it.value().toString().isEmpty()) {
+            if (input.defaultValue.isValid()) {
+                it = resolved->insert(input.id, input.defaultValue);
+            } else if (input.required) {
+                if (error) *error = QString("Input '%1' is required").arg(input.id);
+                return false;
+            } else {
+                continue;
+            }
+        }
+
+        if (input.type == InputDefinition::Bool) {
+            // Checkboxes hand over real booleans, the command line wants text
+            const QVariant value = it.value();
+            const bool checked = value.typeId() == QMetaType::Bool
+                                     ? value.toBool()
+                                     : (value.toString() == "true" || value.toString() == "1");
+            it.value() = checked ? input.trueValue : input.falseValue;
+        }
+    }
+    return true;
+}
+
+QJsonObject ActionDefinition::object() const
+{
+    return QJsonDocument::fromJson(source).object();
+}
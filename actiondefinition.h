@@ -0,0 +1,97 @@
+#ifndef ACTIONDEFINITION_H
+#define ACTIONDEFINITION_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVariantMap>
+#include <QVector>
+
+#include "commandtemplate.h"
+#include "joblimits.h"
+
+// One entry of an action's "inputs", resolved at load time
+struct InputDefinition
+{
+    enum Type { Text, File, Folder, Number, Bool, Choice };
+
+    QString id;
+    QString name;
+    Type type = Text;
+    bool required = false;
+    QVariant defaultValue;            // Invalid when there is none
+    QString trueValue = "true";       // Bool: text put into the command
+    QString falseValue = "false";
+    QStringList filters;              // File: name filters such as "*.txt"
+    QStringList choices;              // Choice: allowed values
+
+    bool isPath() const { return type == File || type == Folder; }
+
+    static bool typeFromString(const QString &text, Type *type);
+    static InputDefinition fromJson(const QJsonObject &object);
+};
+
+// Pre-parsed form of one entry of the "actions" array. ActionManager keeps
+// these in a contiguous table so lookups never touch the JSON again.
+struct ActionDefinition
+{
+    enum Kind {
+        UnknownKind,
+        Exe,
+        ExeWithArgs, // Also "exe_with_input"
+        ExeInCmd,
+        ExeAdmin,
+        Workflow
+    };
+
+    // How a drop of many files runs, see BatchRunner
+    enum BatchMode {
+        PerFile,
+        Chunked // "batch": "chunked" packs the files into few command lines
+    };
+
+    QString id;
+    QString name;
+    QString icon;
+    QString category;
+    QString description;
+    QString type;
+    Kind kind = UnknownKind; // "type" resolved at load time
+    QString command;
+    CommandTemplate commandTemplate; // "command" compiled at load time
+    QJsonArray inputs; // As declared, for the QML input dialog
+    QVector<InputDefinition> inputDefs;
+    bool hasNonFileInputs = false; // Something besides "file" must be asked for
+    bool detached = true; // Launch untracked; "detached": false makes it a scheduler job
+    QString pool; // Run on this warm interpreter pool instead of spawning
+    bool cacheable = false; // Pure function of its inputs; results are memoised
+    JobLimits limits; // Timeout and resource caps for scheduled runs
+    QString schedule; // Cron-like trigger, see CronExpression
+    QJsonObject watch; // File trigger: path, patterns, recursive, debounce_ms
+    BatchMode batchMode = PerFile;
+    int maxParallel = 0; // Per-file batch jobs at a time; 0 leaves it to the scheduler
+    QByteArray source; // Original object as compact JSON
+
+    static ActionDefinition fromJson(const QJsonObject &object);
+    static Kind kindFromType(const QString &type);
+
+    // Fills inputs, inputDefs and hasNonFileInputs
+    void setInputs(const QJsonArray &declared);
+
+    // Output is captured only for commands run as tracked jobs
+    bool runsAsJob() const { return kind == Exe || kind == ExeWithArgs; }
+
+    // Fills in defaults, turns booleans into their true/false text and
+    // checks required inputs. With pathsProvided, file and folder inputs
+    // are left to the caller (batches fill them per file).
+    bool resolveInputs(const QVariantMap &given, QVariantMap *resolved, QString *error,
+                       bool pathsProvided = false) const;
+
+    // Original object, handed to QML as-is; decoded from source on every
+    // call, so keep it off the execute path
+    QJsonObject object() const;
+};
+
+#endif // ACTIONDEFINITION_H
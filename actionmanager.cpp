@@ -1,21 +1,49 @@
-#include "ActionManager.h"
+#include "actionmanager.h"
+#include "jobscheduler.h"
+#include "catalogcache.h"
+#include "processlauncher.h"
+#include "workflowrunner.h"
+#include "batchrunner.h"
+#include "actionschema.h"
+#include "trace.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QJsonDocument>
 #include <QDebug>
 #include <QDir>
 #include <QProcess>
 #include <QCoreApplication>
-#include <QRegularExpression>
-#include <windows.h>
+#include <QStandardPaths>
+#include <QUrl>
 
+// Editors often save in several writes; wait for the file to settle
+static const int ReloadDebounceMs = 250;
 
 ActionManager::ActionManager(QObject *parent)
     : QObject(parent)
+    , m_watcher(nullptr)
+    , m_categoryModel(new ActionCategoryModel(this, this))
+    , m_scheduler(nullptr)
+    , m_workflows(nullptr)
+    , m_batches(nullptr)
+    , m_resultCache(new ResultCache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                                    + "/results", this))
+    , m_history(new ExecutionHistory(this, QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                                               + "/history.log", this))
 {
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(ReloadDebounceMs);
+    connect(&m_reloadTimer, &QTimer::timeout, this, &ActionManager::reloadActions);
+
+    connect(this, &ActionManager::actionExecuted, m_history, &ExecutionHistory::record);
+    connect(this, &ActionManager::actionsChanged, m_history, &ExecutionHistory::refresh);
+    connect(this, &ActionManager::actionsReloaded, m_history, &ExecutionHistory::refresh);
 }
 
 bool ActionManager::loadActions(const QString &filePath)
 {
+    TRACE_SCOPE("loadActions", "actions");
     QString actualPath = filePath;
 
     if (!QFile::exists(actualPath)) {
@@ -34,246 +62,698 @@ bool ActionManager::loadActions(const QString &filePath)
         }
     }
 
-    QFile file(actualPath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not open actions file:" << actualPath;
+    QVector<ActionDefinition> actions;
+    QJsonObject pools;
+    QStringList errors;
+    const bool read = readCatalog(actualPath, &actions, &pools, &errors);
+    m_loadErrors = errors;
+    if (!read) {
         emit actionsLoaded(false);
         return false;
     }
 
-    QByteArray data = file.readAll();
-    file.close();
+    // A fresh load replaces the catalog wholesale
+    m_actions.clear();
+    m_actionIndex.clear();
+    m_searchIndex.clear();
+    m_actionsPath = QFileInfo(actualPath).absoluteFilePath();
+    applyActions(std::move(actions));
+    applyPools(pools);
+    m_categoryModel->reset(m_categoryIds);
+    watchActionsFile();
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull() || !doc.isObject()) {
-        qWarning() << "Invalid JSON format:" << actualPath;
+    emit actionsLoaded(true);
+    emit actionsChanged();
+    emit categoriesChanged();
+    qDebug() << "Actions loaded from" << actualPath;
+    return true;
+}
+
+bool ActionManager::reloadActions()
+{
+    TRACE_SCOPE("reloadActions", "actions");
+    if (m_actionsPath.isEmpty()) return false;
+
+    // Re-arm first: a save-by-rename drops the path from the watcher
+    watchActionsFile();
+
+    QVector<ActionDefinition> actions;
+    QJsonObject pools;
+    QStringList errors;
+    const bool read = readCatalog(m_actionsPath, &actions, &pools, &errors);
+    m_loadErrors = errors;
+    if (!read) {
+        // Keep serving the previous catalog
         emit actionsLoaded(false);
         return false;
     }
 
-    QJsonObject root = doc.object();
-    if (!root.contains("actions") || !root["actions"].isArray()) {
-        qWarning() << "No actions array found in JSON";
-        emit actionsLoaded(false);
+    const QStringList previousCategories = m_categoryIds.keys();
+    const CatalogDiff diff = applyActions(std::move(actions));
+    applyPools(pools);
+
+    for (const QString &id : diff.removed) emit actionRemoved(id);
+    for (const QString &id : diff.added) emit actionAdded(id);
+    for (const QString &id : diff.updated) emit actionUpdated(id);
+
+    emit actionsLoaded(true);
+    if (!diff.isEmpty()) {
+        m_categoryModel->sync(m_categoryIds, QSet<QString>(diff.updated.cbegin(), diff.updated.cend()));
+        emit actionsReloaded(diff.added.size(), diff.removed.size(), diff.updated.size());
+        if (m_categoryIds.keys() != previousCategories) emit categoriesChanged();
+    }
+
+    qDebug() << "Actions reloaded from" << m_actionsPath << "added:" << diff.added.size()
+             << "removed:" << diff.removed.size() << "updated:" << diff.updated.size();
+    return true;
+}
+
+bool ActionManager::readCatalog(const QString &path, QVector<ActionDefinition> *actions,
+                                QJsonObject *pools, QStringList *errors) const
+{
+    // Warm start: the compiled image is current, no JSON to parse
+    {
+        TRACE_SCOPE("catalog cache load", "actions");
+        if (CatalogCache::load(path, actions, pools)) {
+            qDebug() << "Actions read from cache" << CatalogCache::cachePath(path);
+            return true;
+        }
+    }
+
+    QJsonArray array;
+    QByteArray source;
+    const bool read = readActionsFile(path, &array, pools, errors, &source);
+    if (read) *actions = parseActions(array, *pools, errors);
+
+    for (const QString &error : std::as_const(*errors)) qWarning().noquote() << path << error;
+
+    // A file with errors isn't cached, so they're reported again until fixed
+    if (read && errors->isEmpty()) {
+        TRACE_SCOPE("catalog cache save", "actions");
+        CatalogCache::save(path, source, *actions, *pools);
+    }
+    return read;
+}
+
+bool ActionManager::readActionsFile(const QString &path, QJsonArray *actions, QJsonObject *pools,
+                                    QStringList *errors, QByteArray *source) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open actions file:" << path;
         return false;
     }
 
-    m_allActions = root["actions"].toArray();
-    parseActions(m_allActions);
+    QByteArray data;
+    {
+        TRACE_SCOPE("read actions file", "actions");
+        data = file.readAll();
+        file.close();
+    }
 
-    emit actionsLoaded(true);
-    emit actionsChanged();
-    qDebug() << "Actions loaded from" << actualPath;
+    TraceSpan parseSpan("JSON parse", "actions");
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (doc.isNull() || !doc.isObject()) {
+        qWarning() << "Invalid JSON format:" << path;
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    *errors = ActionSchema::validateRoot(root);
+    if (!errors->isEmpty()) return false;
+
+    *actions = root["actions"].toArray();
+    *pools = root["pools"].toObject();
+    if (source) *source = data;
     return true;
 }
 
-void ActionManager::parseActions(const QJsonArray &actions)
+QVector<ActionDefinition> ActionManager::parseActions(const QJsonArray &actions, const QJsonObject &pools,
+                                                      QStringList *errors) const
+{
+    TRACE_SCOPE("parseActions", "actions");
+    QVector<ActionDefinition> table;
+    table.reserve(actions.size());
+    QSet<QString> ids;
+
+    for (qsizetype i = 0; i < actions.size(); ++i) {
+        const QString path = QString("$.actions[%1]").arg(i);
+        const QStringList problems = ActionSchema::validateAction(actions.at(i), path, pools);
+        if (!problems.isEmpty()) {
+            errors->append(problems);
+            continue;
+        }
+
+        ActionDefinition action = ActionDefinition::fromJson(actions.at(i).toObject());
+        if (ids.contains(action.id)) {
+            errors->append(QString("%1.id: duplicate action id \"%2\", the first one is used").arg(path, action.id));
+            continue;
+        }
+        ids.insert(action.id);
+        table.append(std::move(action));
+    }
+    return table;
+}
+
+ActionManager::CatalogDiff ActionManager::applyActions(QVector<ActionDefinition> actions)
+{
+    const QVector<ActionDefinition> previous = std::move(m_actions);
+    const QHash<QString, qsizetype> previousIndex = std::move(m_actionIndex);
+
+    m_actions = std::move(actions);
+    m_actionIndex.clear();
+    m_categoryIds.clear();
+    m_actionIndex.reserve(m_actions.size());
+
+    for (qsizetype i = 0; i < m_actions.size(); ++i) {
+        const ActionDefinition &action = m_actions.at(i);
+
+        // First definition wins, same as the old linear lookup
+        if (!m_actionIndex.contains(action.id)) {
+            m_actionIndex.insert(action.id, i);
+            m_categoryIds[action.category].append(action.id);
+        }
+    }
+
+    // Diff by id against the previous table
+    CatalogDiff diff;
+    for (auto it = m_actionIndex.constBegin(); it != m_actionIndex.constEnd(); ++it) {
+        auto old = previousIndex.constFind(it.key());
+        if (old == previousIndex.constEnd())
+            diff.added.append(it.key());
+        else if (previous.at(old.value()).source != m_actions.at(it.value()).source)
+            diff.updated.append(it.key());
+    }
+    for (auto it = previousIndex.constBegin(); it != previousIndex.constEnd(); ++it) {
+        if (!m_actionIndex.contains(it.key()))
+            diff.removed.append(it.key());
+    }
+
+    // Keep the search index in step with the diff
+    for (const QString &id : std::as_const(diff.removed)) m_searchIndex.remove(id);
+    for (const QStringList *ids : { &diff.added, &diff.updated }) {
+        for (const QString &id : *ids) {
+            const ActionDefinition &action = m_actions.at(m_actionIndex.value(id));
+            m_searchIndex.insert({ action.id, action.name, action.description, action.category });
+        }
+    }
+
+    return diff;
+}
+
+bool ActionManager::watchEnabled() const
 {
-    m_categories.clear();
+    return m_watcher != nullptr;
+}
 
-    for (const QJsonValue &value : actions) {
-        if (!value.isObject()) continue;
-        QJsonObject action = value.toObject();
-        QString category = action.value("category").toString("tools");
-        m_categories[category].append(action);
+void ActionManager::setWatchEnabled(bool enabled)
+{
+    if (watchEnabled() == enabled) return;
+
+    if (enabled) {
+        m_watcher = new QFileSystemWatcher(this);
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+            m_reloadTimer.start();
+        });
+        // A save by rename drops the file watch; the folder sees it come back
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+            if (m_watcher->files().contains(m_actionsPath) || !QFile::exists(m_actionsPath)) return;
+            watchActionsFile();
+            m_reloadTimer.start();
+        });
+        watchActionsFile();
+    } else {
+        m_reloadTimer.stop();
+        delete m_watcher;
+        m_watcher = nullptr;
     }
+    emit watchEnabledChanged();
+}
+
+QString ActionManager::actionsPath() const
+{
+    return m_actionsPath;
 }
 
-QVariantMap ActionManager::categorizedActions() const
+QStringList ActionManager::loadErrors() const
 {
-    QVariantMap map;
-    for (auto it = m_categories.constBegin(); it != m_categories.constEnd(); ++it) {
-        map[it.key()] = it.value().toVariantList();
+    return m_loadErrors;
+}
+
+void ActionManager::watchActionsFile()
+{
+    if (!m_watcher) return;
+
+    const QStringList watched = m_watcher->files();
+    for (const QString &path : watched) {
+        if (path != m_actionsPath) m_watcher->removePath(path);
+    }
+    if (!m_actionsPath.isEmpty() && !watched.contains(m_actionsPath) && QFile::exists(m_actionsPath))
+        m_watcher->addPath(m_actionsPath);
+
+    const QString directory = m_actionsPath.isEmpty() ? QString() : QFileInfo(m_actionsPath).absolutePath();
+    const QStringList directories = m_watcher->directories();
+    for (const QString &path : directories) {
+        if (path != directory) m_watcher->removePath(path);
     }
-    return map;
+    if (!directory.isEmpty() && !directories.contains(directory) && QFileInfo(directory).isDir())
+        m_watcher->addPath(directory);
+}
+
+void ActionManager::applyPools(const QJsonObject &pools)
+{
+    m_pools = pools;
+    if (!m_scheduler) return;
+
+    const QString baseDir = QFileInfo(m_actionsPath).absolutePath();
+    QHash<QString, InterpreterPool::Config> configs;
+    for (auto it = m_pools.constBegin(); it != m_pools.constEnd(); ++it) {
+        const InterpreterPool::Config config = InterpreterPool::Config::fromJson(it.value().toObject(), baseDir);
+        if (config.program.isEmpty()) {
+            qWarning() << "Interpreter pool" << it.key() << "has no program";
+            continue;
+        }
+        configs.insert(it.key(), config);
+    }
+    m_scheduler->configurePools(configs);
+}
+
+const ActionDefinition *ActionManager::findAction(const QString &actionId) const
+{
+    TRACE_SCOPE("findAction", "actions");
+    auto it = m_actionIndex.constFind(actionId);
+    if (it == m_actionIndex.constEnd()) return nullptr;
+    return &m_actions.at(it.value());
+}
+
+const QVector<ActionDefinition> &ActionManager::actions() const
+{
+    return m_actions;
+}
+
+ActionCategoryModel *ActionManager::categoryModel() const
+{
+    return m_categoryModel;
+}
+
+ResultCache *ActionManager::resultCache() const
+{
+    return m_resultCache;
+}
+
+ExecutionHistory *ActionManager::history() const
+{
+    return m_history;
 }
 
 QStringList  ActionManager::categoriesKeys() const
 {
-    return m_categories.keys();
+    return m_categoryIds.keys();
 }
 
 QJsonObject ActionManager::getAction(const QString &actionId) const
 {
-    for (const QJsonValue &val : m_allActions) {
-        if (!val.isObject()) continue;
-        QJsonObject action = val.toObject();
-        if (action.value("id").toString() == actionId) return action;
+    const ActionDefinition *action = findAction(actionId);
+    return action ? action->object() : QJsonObject();
+}
+
+QVariantList ActionManager::searchActions(const QString &query, int limit) const
+{
+    QVariantList results;
+    const QVector<ActionSearchIndex::Match> matches = m_searchIndex.search(query, limit);
+    results.reserve(matches.size());
+
+    for (const ActionSearchIndex::Match &match : matches) {
+        const ActionDefinition *action = findAction(match.actionId);
+        if (!action) continue;
+
+        QVariantMap entry;
+        entry["actionId"] = action->id;
+        entry["name"] = action->name;
+        entry["icon"] = action->icon;
+        entry["description"] = action->description;
+        entry["category"] = action->category;
+        entry["type"] = action->type;
+        entry["score"] = match.score;
+        results.append(entry);
     }
-    return QJsonObject();
+    return results;
 }
 
 void ActionManager::executeAction(const QString &actionId)
 {
-    QJsonObject action = getAction(actionId);
-    if (action.isEmpty()) {
+    const ActionDefinition *action = findAction(actionId);
+    if (!action) {
         qWarning() << "Action not found:" << actionId;
         emit actionExecuted(actionId, false);
         return;
     }
 
     // Check if action requires inputs
-    if (action.contains("inputs") && action["inputs"].isArray()) {
-        QJsonArray inputs = action["inputs"].toArray();
-        if (!inputs.isEmpty()) {
-            emit actionWithInputsRequired(actionId, inputs);
-            return;
-        }
+    if (!action->inputDefs.isEmpty()) {
+        emit actionWithInputsRequired(actionId, action->inputs);
+        return;
     }
 
-    // Execute simple action
-    QString command = action.value("command").toString();
-    QString type = action.value("type").toString();
+    if (action->kind == ActionDefinition::Workflow) {
+        startWorkflow(*action, QVariantMap());
+        return;
+    }
+
+    QByteArray cacheKey;
+    if (replayCachedResult(*action, action->command, QVariantMap(), &cacheKey)) return;
 
-    bool success = executeCommand(command, type, "");
+    // Execute simple action
+    int jobId = 0;
+    bool success = executeCommand(*action, action->command, "", &jobId);
     qDebug() << "Executed action:" << actionId << "success:" << success;
-    emit actionExecuted(actionId, success);
+    if (success && jobId > 0 && !cacheKey.isEmpty()) m_pendingResults.insert(jobId, cacheKey);
+    reportExecution(actionId, success, jobId);
 }
 
-void ActionManager::executeActionWithInputs(const QString &actionId, const QVariantMap &inputs)
+void ActionManager::executeActionWithInputs(const QString &actionId, const QVariantMap &given)
 {
-    QJsonObject action = getAction(actionId);
-    if (action.isEmpty()) {
+    const ActionDefinition *action = findAction(actionId);
+    if (!action) {
         qWarning() << "Action not found:" << actionId;
         emit actionExecuted(actionId, false);
         return;
     }
 
-    QString commandTemplate = action.value("command").toString();
-    QString type = action.value("type").toString();
+    QVariantMap inputs;
+    QString error;
+    if (!action->resolveInputs(given, &inputs, &error)) {
+        qWarning() << "Action" << actionId << "not run:" << error;
+        emit actionExecuted(actionId, false);
+        return;
+    }
+
+    if (action->kind == ActionDefinition::Workflow) {
+        startWorkflow(*action, inputs);
+        return;
+    }
 
     // Build the final command by replacing placeholders
     // qWarning() << "inputs :" << inputs["file"];
-    QString finalCommand = buildCommand(commandTemplate, inputs);
+    QString finalCommand;
+    {
+        TRACE_SCOPE("build command", "actions");
+        finalCommand = action->commandTemplate.render(inputs);
+    }
     qWarning() << "finalCommand :" << finalCommand;
 
-    bool success = executeCommand(finalCommand, type, "\""+inputs["file"].toString()+"\"");
+    QByteArray cacheKey;
+    if (replayCachedResult(*action, finalCommand, inputs, &cacheKey)) return;
+
+    int jobId = 0;
+    bool success = executeCommand(*action, finalCommand, inputs.value("file").toString(), &jobId);
     qDebug() << "Executed action with inputs:" << actionId << "command:" << finalCommand << "success:" << success;
-    emit actionExecuted(actionId, success);
+    if (success && jobId > 0 && !cacheKey.isEmpty()) m_pendingResults.insert(jobId, cacheKey);
+    reportExecution(actionId, success, jobId);
 }
 
 void ActionManager::executeActionWithFile(const QString &actionId, const QString &filePath)
 {
-    QJsonObject action = getAction(actionId);
-    if (action.isEmpty()) {
+    const ActionDefinition *action = findAction(actionId);
+    if (!action) {
         qWarning() << "Action not found:" << actionId;
         emit actionExecuted(actionId, false);
         return;
     }
 
+    // A dropped folder fans out over its files
+    if (m_batches && QFileInfo(filePath).isDir()) {
+        executeActionWithFiles(actionId, { filePath });
+        return;
+    }
+
     QVariantMap inputs;
     inputs["file"] = filePath;
 
-    // Check if there are other inputs needed
-    if (action.contains("inputs") && action["inputs"].isArray()) {
-        QJsonArray inputDefs = action["inputs"].toArray();
-        bool hasOtherInputs = false;
-
-        for (const QJsonValue &inputVal : inputDefs) {
-            if (inputVal.isObject()) {
-                QJsonObject input = inputVal.toObject();
-                QString inputId = input.value("id").toString();
-                if (inputId != "file") {
-                    hasOtherInputs = true;
-                    break;
-                }
-            }
-        }
-
-        if (hasOtherInputs) {
-            // Show input dialog for other inputs
-            emit actionWithInputsRequired(actionId, inputDefs);
-            return;
-        }
+    // Show the input dialog when there's more to ask than the file
+    if (action->hasNonFileInputs) {
+        emit actionWithInputsRequired(actionId, action->inputs);
+        return;
     }
 
     // Execute with just the file input
     executeActionWithInputs(actionId, inputs);
 }
 
-QString ActionManager::buildCommand(const QString &templateStr, const QVariantMap &inputs) const
+int ActionManager::executeActionWithFiles(const QString &actionId, const QStringList &paths,
+                                          const QVariantMap &inputs)
 {
-    QString result = templateStr;
-
-    // Replace placeholders like {variable}
-    QRegularExpression re("\\{([^}]+)\\}");
-    QRegularExpressionMatchIterator it = re.globalMatch(templateStr);
-
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
-        QString placeholder = match.captured(1);
-        QString value = inputs.value(placeholder).toString();
+    const ActionDefinition *action = findAction(actionId);
+    if (!action) {
+        qWarning() << "Action not found:" << actionId;
+        emit actionExecuted(actionId, false);
+        return 0;
+    }
 
-        // Handle special cases for boolean flags
-        if (value == "true" || value == "false") {
-            // Look for true_value and false_value in the input definition
-            // This would require more context, so we'll handle it in the QML side
+    // Console and elevated launches can't be tracked, so can't be batched
+    if (!m_batches || action->kind == ActionDefinition::ExeInCmd || action->kind == ActionDefinition::ExeAdmin) {
+        qWarning() << "Action" << actionId << "can't run as a batch, running the first file only";
+        if (!paths.isEmpty()) {
+            const QString first = paths.constFirst();
+            executeActionWithFile(actionId, first.startsWith("file:") ? QUrl(first).toLocalFile() : first);
         }
-
-        result.replace("{" + placeholder + "}", escapeArgument(value));
+        return 0;
     }
 
-    return result;
+    QVariantMap resolved;
+    QString error;
+    if (!action->resolveInputs(inputs, &resolved, &error, true)) {
+        qWarning() << "Batch of" << actionId << "not started:" << error;
+        emit actionExecuted(actionId, false);
+        return 0;
+    }
+    return m_batches->start(*action, paths, resolved);
 }
 
-QString ActionManager::escapeArgument(const QString &arg) const
+bool ActionManager::cancelBatch(int batchId)
 {
-    if (arg.isEmpty()) return "\"\"";
-
-    // Simple escaping - wrap in quotes if contains spaces
-    if (arg.contains(' ') || arg.contains('\t')) {
-        return "\"" + arg + "\"";
-    }
-
-    return arg;
+    return m_batches && m_batches->cancel(batchId);
 }
 
+QString ActionManager::buildCommand(const QString &templateStr, const QVariantMap &inputs) const
+{
+    // Ad-hoc templates; catalog actions render their precompiled template
+    return CommandTemplate::compile(templateStr).render(inputs);
+}
 
+void ActionManager::setJobScheduler(JobScheduler *scheduler)
+{
+    if (m_scheduler == scheduler) return;
+    if (m_scheduler) m_scheduler->disconnect(this);
+    delete m_workflows;
+    m_workflows = nullptr;
+    delete m_batches;
+    m_batches = nullptr;
+    m_scheduler = scheduler;
+    if (!m_scheduler) return;
+
+    applyPools(m_pools);
+    m_workflows = new WorkflowRunner(this, m_scheduler, this);
+    connect(m_workflows, &WorkflowRunner::workflowFinished, this,
+            [this](int, const QString &workflowId, bool success) {
+                emit actionExecuted(workflowId, success);
+            });
+
+    m_batches = new BatchRunner(m_scheduler, this);
+    connect(m_batches, &BatchRunner::batchStarted, this, &ActionManager::batchStarted);
+    connect(m_batches, &BatchRunner::fileFinished, this, &ActionManager::batchFileFinished);
+    connect(m_batches, &BatchRunner::batchProgress, this, &ActionManager::batchProgress);
+    connect(m_batches, &BatchRunner::batchFinished, this,
+            [this](int batchId, const QString &actionId, const QVariantMap &summary) {
+                emit batchFinished(batchId, actionId, summary);
+                emit actionExecuted(actionId, summary.value("failed").toInt() == 0
+                                                  && !summary.value("canceled").toBool()
+                                                  && !summary.contains("error"));
+            });
+
+    connect(m_scheduler, &JobScheduler::jobFinished, this,
+            [this](int jobId, int exitCode, QProcess::ExitStatus exitStatus) {
+                if (m_pendingResults.contains(jobId)) {
+                    // Only complete, uncut output is worth replaying
+                    const QByteArray key = m_pendingResults.take(jobId);
+                    const auto output = m_scheduler->output(jobId);
+                    if (exitStatus == QProcess::NormalExit && output
+                        && !output->standardOutput.truncated() && !output->standardError.truncated()) {
+                        ResultCache::Entry entry;
+                        entry.exitCode = exitCode;
+                        entry.standardOutput = output->standardOutput.contents();
+                        entry.standardError = output->standardError.contents();
+                        m_resultCache->store(key, entry);
+                    }
+                }
 
+                if (!m_jobActions.contains(jobId)) return;
+                const QString actionId = m_jobActions.take(jobId);
+                const bool success = exitStatus == QProcess::NormalExit && exitCode == 0;
+                qDebug() << "Action job finished:" << actionId << "job:" << jobId << "exit code:" << exitCode;
+                emit actionExecuted(actionId, success);
+            });
+
+    connect(m_scheduler, &JobScheduler::jobError, this,
+            [this](int jobId, const QString &error) {
+                m_pendingResults.remove(jobId);
+                if (!m_jobActions.contains(jobId)) return;
+                const QString actionId = m_jobActions.take(jobId);
+                qWarning() << "Action job failed:" << actionId << "job:" << jobId << error;
+                emit actionExecuted(actionId, false);
+            });
+
+    connect(m_scheduler, &JobScheduler::jobTimedOut, this,
+            [this](int jobId) {
+                // The job still ends through jobFinished or jobError
+                m_pendingResults.remove(jobId);
+                if (m_jobActions.contains(jobId))
+                    emit actionTimedOut(m_jobActions.value(jobId));
+            });
+
+    connect(m_scheduler, &JobScheduler::jobCanceled, this,
+            [this](int jobId) {
+                m_pendingResults.remove(jobId);
+                if (m_jobActions.contains(jobId))
+                    emit actionExecuted(m_jobActions.take(jobId), false);
+            });
+}
 
+JobScheduler *ActionManager::jobScheduler() const
+{
+    return m_scheduler;
+}
 
+WorkflowRunner *ActionManager::workflowRunner() const
+{
+    return m_workflows;
+}
 
+void ActionManager::setTrackAllActions(bool track)
+{
+    m_trackAll = track;
+}
 
+void ActionManager::startWorkflow(const ActionDefinition &action, const QVariantMap &inputs)
+{
+    if (!m_workflows) {
+        qWarning() << "Workflow" << action.id << "needs a job scheduler";
+        emit actionExecuted(action.id, false);
+        return;
+    }
 
+    QString error;
+    const int runId = m_workflows->start(action, inputs, &error);
+    if (runId == 0) {
+        qWarning() << "Workflow" << action.id << "not started:" << error;
+        emit actionExecuted(action.id, false);
+        return;
+    }
+    qDebug() << "Started workflow:" << action.id << "run:" << runId;
+}
 
+bool ActionManager::replayCachedResult(const ActionDefinition &action, const QString &command,
+                                       const QVariantMap &inputs, QByteArray *key)
+{
+    key->clear();
 
+    // Output is only captured for scheduler jobs
+    if (!action.cacheable || !m_scheduler || (action.detached && !m_trackAll) || !action.runsAsJob())
+        return false;
 
+    // File inputs are hashed by content, not just by path
+    QStringList files;
+    for (auto it = inputs.cbegin(); it != inputs.cend(); ++it) {
+        bool isFile = it.key() == "file";
+        for (const InputDefinition &input : action.inputDefs) {
+            if (input.id == it.key() && input.type == InputDefinition::File) isFile = true;
+        }
+        if (isFile && !it.value().toString().isEmpty()) files.append(it.value().toString());
+    }
 
+    *key = m_resultCache->key(command, files);
 
+    ResultCache::Entry entry;
+    if (!m_resultCache->lookup(*key, &entry)) return false;
 
+    qDebug() << "Action served from result cache:" << action.id << "exit code:" << entry.exitCode;
+    emit actionResultCached(action.id, entry.exitCode, QString::fromLocal8Bit(entry.standardOutput));
+    emit actionExecuted(action.id, entry.exitCode == 0);
+    return true;
+}
 
+void ActionManager::reportExecution(const QString &actionId, bool success, int jobId)
+{
+    // Tracked jobs report once the process has finished
+    if (success && jobId > 0) {
+        m_jobActions.insert(jobId, actionId);
+        return;
+    }
+    emit actionExecuted(actionId, success);
+}
 
+bool ActionManager::launch(const ActionDefinition &action, const QString &commandLine, int *jobId)
+{
+    // Pooled scripts need a worker, they can't be launched detached
+    if (!action.pool.isEmpty() && !m_scheduler) {
+        qWarning() << "Cannot run" << action.id << "on interpreter pool" << action.pool;
+        return false;
+    }
 
+    if (m_scheduler && (!action.detached || m_trackAll || !action.pool.isEmpty())) {
+        QStringList argv = QProcess::splitCommand(commandLine);
+        if (argv.isEmpty()) {
+            qWarning() << "Empty command for" << action.id;
+            return false;
+        }
 
+        JobScheduler::JobSpec spec;
+        spec.program = argv.takeFirst();
+        spec.arguments = argv;
+        spec.tag = action.id;
+        spec.pool = action.pool;
+        spec.limits = action.limits;
+        *jobId = m_scheduler->submit(spec);
+        return *jobId > 0;
+    }
 
+    if (!action.limits.isEmpty())
+        qWarning() << "Limits of" << action.id << "are not enforced for detached launches";
 
+    QString error;
+    if (!ProcessLauncher::startDetached(ProcessLauncher::fromCommandLine(commandLine), nullptr, &error)) {
+        qWarning() << "Launch failed:" << error;
+        return false;
+    }
+    return true;
+}
 
+bool ActionManager::executeCommand(const ActionDefinition &action, const QString &command,
+                                   const QString &inputValue, int *jobId)
+{
+    TraceSpan span("spawn", "actions");
+    span.setDetail(action.id);
 
+    const ActionDefinition::Kind kind = action.kind;
+    *jobId = 0;
 
-
-
-
-
-
-
-bool ActionManager::executeCommand(const QString &command, const QString &type, const QString &inputValue)
-{
     if (command.isEmpty()) {
         qWarning() << "Empty command";
         return false;
     }
 
-    qDebug() << "Executing command:" << command << "type:" << type << "input:" << inputValue;
+    qDebug() << "Executing command:" << command << "type:" << action.type << "input:" << inputValue;
 
     bool success = false;
-    bool hasInput = !inputValue.isEmpty();
+    // A command that places its inputs itself gets nothing appended
+    bool hasInput = !inputValue.isEmpty() && !action.commandTemplate.hasPlaceholders();
 
-    if (type == "exe") {
+    if (kind == ActionDefinition::Exe) {
         // Execute the command directly (for simple executables like calc.exe)
         // Input values are ignored for "exe" type since they don't expect arguments
-        success = QProcess::startDetached(command);
+        success = launch(action, command, jobId);
 
-    } else if (type == "exe_with_args") {
+    } else if (kind == ActionDefinition::ExeWithArgs) {
         if (hasInput) {
             // For actions with inputs, combine command with input value
             QString fullCommand = command;
@@ -283,63 +763,32 @@ bool ActionManager::executeCommand(const QString &command, const QString &type,
                 escapedInput = "\"" + escapedInput + "\"";
             }
             fullCommand += " " + escapedInput;
-            success = QProcess::startDetached(fullCommand);
+            success = launch(action, fullCommand, jobId);
         } else {
             // No input provided, execute the command without arguments
-            success = QProcess::startDetached(command);
+            success = launch(action, command, jobId);
         }
 
-    } else if (type == "exe_in_cmd") {
-        qDebug() << "try to open cmd window with command:" << command;
-
-        // Use /k to keep open, then pause and close after key press
-        QString fullCommand = QString("cmd.exe /k \"%1 && pause\"").arg(command);
+    } else if (kind == ActionDefinition::ExeInCmd) {
+        qDebug() << "try to open console window with command:" << command;
 
-        STARTUPINFO si;
-        PROCESS_INFORMATION pi;
-        ZeroMemory(&si, sizeof(si));
-        si.cb = sizeof(si);
-        ZeroMemory(&pi, sizeof(pi));
-
-        wchar_t commandW[1024];
-        fullCommand.toWCharArray(commandW);
-        commandW[fullCommand.length()] = '\0';
-
-        // Set success based on whether CreateProcess succeeds
-        success = CreateProcessW(NULL, commandW, NULL, NULL, FALSE, CREATE_NEW_CONSOLE, NULL, NULL, &si, &pi);
-
-        if (success) {
-            CloseHandle(pi.hProcess);
-            CloseHandle(pi.hThread);
-            qDebug() << "cmd.exe started successfully!";
-        } else {
-            qDebug() << "Failed to start cmd.exe. Error code:" << GetLastError();
-        }
-    }
+        QString error;
+        success = ProcessLauncher::startInConsole(command, &error);
+        if (!success) qDebug() << "Failed to open console:" << error;
 
-
-
-
-
-
-
-
-
-
-
-
-    else if (type == "exe_admin") {
+    } else if (kind == ActionDefinition::ExeAdmin) {
         QString fullCommand = command;
         if (hasInput) {
-            fullCommand += " " + inputValue;
+            fullCommand += " " + CommandTemplate::escapeArgument(inputValue);
         }
-        QStringList args;
-        args << "-Command" << "Start-Process cmd -Verb RunAs -ArgumentList '/k " + fullCommand + "'";
-        success = QProcess::startDetached("powershell.exe", args);
+
+        QString error;
+        success = ProcessLauncher::startElevated(fullCommand, &error);
+        if (!success) qDebug() << "Failed to start elevated:" << error;
 
     } else {
         // Unknown type - show error and do nothing
-        qWarning() << "Unknown execution type:" << type << "- command not executed";
+        qWarning() << "Unknown execution type:" << action.type << "- command not executed";
         return false;
     }
 
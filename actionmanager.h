@@ -5,41 +5,144 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QVariantMap>
+#include <QTimer>
+
+#include "actiondefinition.h"
+#include "actionmodels.h"
+#include "actionsearchindex.h"
+#include "resultcache.h"
+#include "executionhistory.h"
+
+class QFileSystemWatcher;
+class JobScheduler;
+class WorkflowRunner;
+class BatchRunner;
 
 class ActionManager : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(QVariantMap categorizedActions READ categorizedActions NOTIFY actionsChanged)
-    Q_PROPERTY(QStringList categoriesKeys READ categoriesKeys NOTIFY actionsChanged)
+    Q_PROPERTY(ActionCategoryModel *categoryModel READ categoryModel CONSTANT)
+    Q_PROPERTY(QStringList categoriesKeys READ categoriesKeys NOTIFY categoriesChanged)
+    Q_PROPERTY(bool watchEnabled READ watchEnabled WRITE setWatchEnabled NOTIFY watchEnabledChanged)
+    Q_PROPERTY(QString actionsPath READ actionsPath NOTIFY actionsLoaded)
+    Q_PROPERTY(ResultCache *resultCache READ resultCache CONSTANT)
+    Q_PROPERTY(ExecutionHistory *history READ history CONSTANT)
+    Q_PROPERTY(QStringList loadErrors READ loadErrors NOTIFY actionsLoaded)
 
 public:
     explicit ActionManager(QObject *parent = nullptr);
 
+    // Tracked actions run as scheduler jobs; without one everything detaches
+    void setJobScheduler(JobScheduler *scheduler);
+    JobScheduler *jobScheduler() const;
+    // Runs "workflow" actions; only available once a scheduler is set
+    WorkflowRunner *workflowRunner() const;
+    // Run detached actions as jobs too, for callers that need every exit code
+    void setTrackAllActions(bool track);
+
     Q_INVOKABLE bool loadActions(const QString &filePath = "actions.json");
+    Q_INVOKABLE bool reloadActions();
     Q_INVOKABLE void executeAction(const QString &actionId);
     Q_INVOKABLE void executeActionWithInputs(const QString &actionId, const QVariantMap &inputs);
     Q_INVOKABLE void executeActionWithFile(const QString &actionId, const QString &filePath);
+    // Many dropped paths (files, folders, wildcards) as one batch; returns the batch id
+    Q_INVOKABLE int executeActionWithFiles(const QString &actionId, const QStringList &paths,
+                                           const QVariantMap &inputs = QVariantMap());
+    Q_INVOKABLE bool cancelBatch(int batchId);
 
     Q_INVOKABLE QJsonObject getAction(const QString &actionId) const;
+    // Ranked fuzzy match over id, name, category and description
+    Q_INVOKABLE QVariantList searchActions(const QString &query, int limit = 20) const;
 
-    QVariantMap categorizedActions() const;
+    ActionCategoryModel *categoryModel() const;
+    ResultCache *resultCache() const;
+    // Past runs and the frecency-ranked "recent" model built from them
+    ExecutionHistory *history() const;
     QStringList  categoriesKeys() const;
 
+    // C++ side lookup into the action table, nullptr when unknown
+    const ActionDefinition *findAction(const QString &actionId) const;
+    // The whole table in catalog order; duplicate ids included
+    const QVector<ActionDefinition> &actions() const;
+
+    // Re-parse the actions file shortly after it changes on disk
+    bool watchEnabled() const;
+    void setWatchEnabled(bool enabled);
+    QString actionsPath() const;
+    // Schema errors of the last load, "<json path>: <problem>"; the
+    // offending actions are left out of the catalog
+    QStringList loadErrors() const;
+
 signals:
+    // The whole catalog was replaced (first load or a different file)
     void actionsChanged();
+    // A reload of the same file changed these ids only
+    void actionAdded(const QString &actionId);
+    void actionRemoved(const QString &actionId);
+    void actionUpdated(const QString &actionId);
+    void actionsReloaded(int added, int removed, int updated);
+    void categoriesChanged();
+    void watchEnabledChanged();
     void actionExecuted(const QString &actionId, bool success);
     void actionsLoaded(bool success);
     void actionWithInputsRequired(const QString &actionId, const QJsonArray &inputs);
+    // A cacheable action was answered from the result cache, nothing ran
+    void actionResultCached(const QString &actionId, int exitCode, const QString &output);
+    // A run hit its "limits.timeout_sec" and is being stopped
+    void actionTimedOut(const QString &actionId);
+    void batchStarted(int batchId, const QString &actionId, int total);
+    void batchFileFinished(int batchId, const QString &filePath, bool success, int exitCode);
+    void batchProgress(int batchId, int completed, int total, int failed);
+    void batchFinished(int batchId, const QString &actionId, const QVariantMap &summary);
 
 private:
-    QJsonArray m_allActions;
-    QMap<QString, QJsonArray> m_categories;
+    struct CatalogDiff {
+        QStringList added;
+        QStringList removed;
+        QStringList updated;
+        bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && updated.isEmpty(); }
+    };
+
+    QString m_actionsPath;
+    QFileSystemWatcher *m_watcher;
+    QTimer m_reloadTimer;
+
+    QVector<ActionDefinition> m_actions;
+    QHash<QString, qsizetype> m_actionIndex; // action id -> index in m_actions
+    QMap<QString, QStringList> m_categoryIds; // category -> action ids, catalog order
+    ActionCategoryModel *m_categoryModel;
+    ActionSearchIndex m_searchIndex;
+    JobScheduler *m_scheduler;
+    QHash<int, QString> m_jobActions; // running job id -> action id
+    bool m_trackAll = false;
+    WorkflowRunner *m_workflows;
+    BatchRunner *m_batches;
+    QJsonObject m_pools; // "pools" section of the actions file
+    ResultCache *m_resultCache;
+    ExecutionHistory *m_history;
+    QHash<int, QByteArray> m_pendingResults; // running job id -> result cache key
+    QStringList m_loadErrors;
 
-    void parseActions(const QJsonArray &actions);
+    bool readCatalog(const QString &path, QVector<ActionDefinition> *actions, QJsonObject *pools,
+                     QStringList *errors) const;
+    bool readActionsFile(const QString &path, QJsonArray *actions, QJsonObject *pools, QStringList *errors,
+                         QByteArray *source = nullptr) const;
+    QVector<ActionDefinition> parseActions(const QJsonArray &actions, const QJsonObject &pools,
+                                           QStringList *errors) const;
+    CatalogDiff applyActions(QVector<ActionDefinition> actions);
+    void watchActionsFile();
+    void applyPools(const QJsonObject &pools);
     QString buildCommand(const QString &templateStr, const QVariantMap &inputs) const;
-    QString escapeArgument(const QString &arg) const;
-    bool executeCommand(const QString &command, const QString &type, const QString &inputValue);
+    bool executeCommand(const ActionDefinition &action, const QString &command,
+                        const QString &inputValue, int *jobId);
+    bool launch(const ActionDefinition &action, const QString &commandLine, int *jobId);
+    void startWorkflow(const ActionDefinition &action, const QVariantMap &inputs);
+    bool replayCachedResult(const ActionDefinition &action, const QString &command,
+                            const QVariantMap &inputs, QByteArray *key);
+    void reportExecution(const QString &actionId, bool success, int jobId);
 };
 
 #endif // ACTIONMANAGER_H
@@ -0,0 +1,188 @@
+#include "actionmodels.h"
+#include "actionmanager.h"
+
+ActionListModel::ActionListModel(const ActionManager *manager, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_manager(manager)
+{
+}
+
+int ActionListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_ids.size();
+}
+
+QVariant ActionListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_ids.size()) return QVariant();
+
+    const ActionDefinition *action = m_manager->findAction(m_ids.at(index.row()));
+    if (!action) return QVariant();
+
+    switch (role) {
+    case ActionIdRole: return action->id;
+    case Qt::DisplayRole:
+    case NameRole: return action->name;
+    case IconRole: return action->icon;
+    case DescriptionRole: return action->description;
+    case TypeRole: return action->type;
+    case ActionRole: return action->object();
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> ActionListModel::roleNames() const
+{
+    return {
+        { ActionIdRole, "actionId" },
+        { NameRole, "name" },
+        { IconRole, "icon" },
+        { DescriptionRole, "description" },
+        { TypeRole, "type" },
+        { ActionRole, "action" }
+    };
+}
+
+void ActionListModel::setActionIds(const QStringList &ids)
+{
+    if (m_ids == ids) return;
+    const int oldCount = m_ids.size();
+
+    // Drop rows that are gone, back to front so indexes stay valid
+    const QSet<QString> keep(ids.cbegin(), ids.cend());
+    for (int row = m_ids.size() - 1; row >= 0; --row) {
+        if (keep.contains(m_ids.at(row))) continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_ids.removeAt(row);
+        endRemoveRows();
+    }
+
+    // Insert new ids in place; a reorder of surviving rows is rare enough
+    // to fall back to a reset
+    const QSet<QString> present(m_ids.cbegin(), m_ids.cend());
+    for (int row = 0; row < ids.size(); ++row) {
+        if (row < m_ids.size() && m_ids.at(row) == ids.at(row)) continue;
+
+        if (present.contains(ids.at(row))) {
+            beginResetModel();
+            m_ids = ids;
+            endResetModel();
+            break;
+        }
+
+        beginInsertRows(QModelIndex(), row, row);
+        m_ids.insert(row, ids.at(row));
+        endInsertRows();
+    }
+
+    if (m_ids.size() != oldCount) emit countChanged();
+}
+
+void ActionListModel::refreshActions(const QSet<QString> &ids)
+{
+    for (int row = 0; row < m_ids.size(); ++row) {
+        if (ids.contains(m_ids.at(row))) {
+            const QModelIndex idx = index(row);
+            emit dataChanged(idx, idx);
+        }
+    }
+}
+
+ActionCategoryModel::ActionCategoryModel(const ActionManager *manager, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_manager(manager)
+{
+}
+
+int ActionCategoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_names.size();
+}
+
+QVariant ActionCategoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_names.size()) return QVariant();
+
+    const QString &name = m_names.at(index.row());
+    switch (role) {
+    case NameRole: return name;
+    case Qt::DisplayRole:
+    case DisplayNameRole: return name.left(1).toUpper() + name.mid(1);
+    case ActionsRole: return QVariant::fromValue<QObject *>(m_models.at(index.row()));
+    case ActionCountRole: return m_models.at(index.row())->rowCount();
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> ActionCategoryModel::roleNames() const
+{
+    return {
+        { NameRole, "name" },
+        { DisplayNameRole, "displayName" },
+        { ActionsRole, "actions" },
+        { ActionCountRole, "actionCount" }
+    };
+}
+
+ActionListModel *ActionCategoryModel::actions(const QString &category) const
+{
+    const int row = m_names.indexOf(category);
+    return row < 0 ? nullptr : m_models.at(row);
+}
+
+void ActionCategoryModel::reset(const QMap<QString, QStringList> &categories)
+{
+    beginResetModel();
+    // Delegates of the old models may still be running a binding; QML lets
+    // go of them once the reset has been handled
+    for (ActionListModel *model : std::as_const(m_models)) model->deleteLater();
+    m_models.clear();
+    m_names = categories.keys();
+    for (auto it = categories.constBegin(); it != categories.constEnd(); ++it) {
+        auto *model = new ActionListModel(m_manager, this);
+        model->setActionIds(it.value());
+        m_models.append(model);
+    }
+    endResetModel();
+    emit countChanged();
+}
+
+void ActionCategoryModel::sync(const QMap<QString, QStringList> &categories,
+                               const QSet<QString> &updatedIds)
+{
+    const int oldCount = m_names.size();
+
+    // Remove categories that no longer have actions
+    for (int row = m_names.size() - 1; row >= 0; --row) {
+        if (categories.contains(m_names.at(row))) continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_names.removeAt(row);
+        m_models.takeAt(row)->deleteLater();
+        endRemoveRows();
+    }
+
+    // Both lists are sorted by name, insert new categories in place
+    int row = 0;
+    for (auto it = categories.constBegin(); it != categories.constEnd(); ++it, ++row) {
+        if (row < m_names.size() && m_names.at(row) == it.key()) {
+            ActionListModel *model = m_models.at(row);
+            const int before = model->rowCount();
+            model->setActionIds(it.value());
+            model->refreshActions(updatedIds);
+            if (model->rowCount() != before) {
+                const QModelIndex idx = index(row);
+                emit dataChanged(idx, idx, { ActionCountRole });
+            }
+            continue;
+        }
+
+        beginInsertRows(QModelIndex(), row, row);
+        auto *model = new ActionListModel(m_manager, this);
+        model->setActionIds(it.value());
+        m_names.insert(row, it.key());
+        m_models.insert(row, model);
+        endInsertRows();
+    }
+
+    if (m_names.size() != oldCount) emit countChanged();
+}
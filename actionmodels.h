@@ -0,0 +1,86 @@
+#ifndef ACTIONMODELS_H
+#define ACTIONMODELS_H
+
+#include <QAbstractListModel>
+#include <QtQml/qqmlregistration.h>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+class ActionManager;
+
+// Actions of one category, in catalog order. Rows only hold action ids;
+// role data is read from ActionManager's action table on demand.
+class ActionListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ANONYMOUS
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        ActionIdRole = Qt::UserRole + 1,
+        NameRole,
+        IconRole,
+        DescriptionRole,
+        TypeRole,
+        ActionRole
+    };
+
+    ActionListModel(const ActionManager *manager, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    const QStringList &actionIds() const { return m_ids; }
+    void setActionIds(const QStringList &ids);
+    void refreshActions(const QSet<QString> &ids);
+
+signals:
+    void countChanged();
+
+private:
+    const ActionManager *m_manager;
+    QStringList m_ids;
+};
+
+// One row per category, each carrying its ActionListModel. Updates from a
+// catalog reload are applied as row inserts/removes/changes so QML views
+// keep their delegates.
+class ActionCategoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ANONYMOUS
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        DisplayNameRole,
+        ActionsRole,
+        ActionCountRole
+    };
+
+    explicit ActionCategoryModel(const ActionManager *manager, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    Q_INVOKABLE ActionListModel *actions(const QString &category) const;
+
+    void reset(const QMap<QString, QStringList> &categories);
+    void sync(const QMap<QString, QStringList> &categories, const QSet<QString> &updatedIds);
+
+signals:
+    void countChanged();
+
+private:
+    const ActionManager *m_manager;
+    QStringList m_names;
+    QVector<ActionListModel *> m_models;
+};
+
+#endif // ACTIONMODELS_H
@@ -0,0 +1,266 @@
+#include "actionschema.h"
+#include "actiondefinition.h"
+#include "cronexpression.h"
+#include "workflowrunner.h"
+#include <QJsonArray>
+#include <QSet>
+
+namespace {
+
+// Collects "path: message" lines for one action
+class Checker
+{
+public:
+    explicit Checker(QStringList *errors) : m_errors(errors) {}
+
+    void fail(const QString &path, const QString &message) { m_errors->append(path + ": " + message); }
+
+    bool expectString(const QJsonObject &object, const QString &key, const QString &path, bool required = false)
+    {
+        const QJsonValue value = object.value(key);
+        if (value.isUndefined()) {
+            if (required) fail(path + "." + key, "is required");
+            return !required;
+        }
+        if (!value.isString()) {
+            fail(path + "." + key, "must be a string");
+            return false;
+        }
+        if (required && value.toString().isEmpty()) {
+            fail(path + "." + key, "must not be empty");
+            return false;
+        }
+        return true;
+    }
+
+    void expectBool(const QJsonObject &object, const QString &key, const QString &path)
+    {
+        const QJsonValue value = object.value(key);
+        if (!value.isUndefined() && !value.isBool()) fail(path + "." + key, "must be true or false");
+    }
+
+    void expectNumber(const QJsonObject &object, const QString &key, const QString &path,
+                      double min, double max = 1e18)
+    {
+        const QJsonValue value = object.value(key);
+        if (value.isUndefined()) return;
+        if (!value.isDouble() || value.toDouble() < min || value.toDouble() > max)
+            fail(path + "." + key, QString("must be a number from %1 to %2").arg(min).arg(max));
+    }
+
+    void expectStrings(const QJsonObject &object, const QString &key, const QString &path, bool allowSingle)
+    {
+        const QJsonValue value = object.value(key);
+        if (value.isUndefined() || (allowSingle && value.isString())) return;
+        if (!value.isArray()) {
+            fail(path + "." + key, allowSingle ? "must be a string or an array of strings" : "must be an array of strings");
+            return;
+        }
+        const QJsonArray array = value.toArray();
+        for (qsizetype i = 0; i < array.size(); ++i) {
+            if (!array.at(i).isString()) fail(QString("%1.%2[%3]").arg(path, key).arg(i), "must be a string");
+        }
+    }
+
+    void expectKnownKeys(const QJsonObject &object, const QString &path, const QSet<QString> &known)
+    {
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            if (!known.contains(it.key())) fail(path + "." + it.key(), "is not a known key");
+        }
+    }
+
+private:
+    QStringList *m_errors;
+};
+
+void checkInputs(Checker &check, const QJsonValue &value, const QString &path)
+{
+    if (value.isUndefined()) return;
+    if (!value.isArray()) {
+        check.fail(path, "must be an array");
+        return;
+    }
+
+    QSet<QString> ids;
+    const QJsonArray inputs = value.toArray();
+    for (qsizetype i = 0; i < inputs.size(); ++i) {
+        const QString inputPath = QString("%1[%2]").arg(path).arg(i);
+        if (!inputs.at(i).isObject()) {
+            check.fail(inputPath, "must be an object");
+            continue;
+        }
+
+        const QJsonObject input = inputs.at(i).toObject();
+        if (check.expectString(input, "id", inputPath, true)) {
+            const QString id = input.value("id").toString();
+            if (ids.contains(id)) check.fail(inputPath + ".id", QString("duplicate input id \"%1\"").arg(id));
+            ids.insert(id);
+        }
+        check.expectString(input, "name", inputPath);
+        check.expectBool(input, "required", inputPath);
+
+        InputDefinition::Type type = InputDefinition::Text;
+        if (check.expectString(input, "type", inputPath)
+            && !InputDefinition::typeFromString(input.value("type").toString(), &type)) {
+            check.fail(inputPath + ".type",
+                       QString("unknown input type \"%1\"; expected text, file, folder, number, bool or choice")
+                           .arg(input.value("type").toString()));
+            continue;
+        }
+
+        if (type == InputDefinition::Bool) {
+            check.expectString(input, "true_value", inputPath);
+            check.expectString(input, "false_value", inputPath);
+        } else {
+            for (const char *key : { "true_value", "false_value" }) {
+                if (input.contains(key)) check.fail(inputPath + "." + key, "only applies to bool inputs");
+            }
+        }
+
+        check.expectStrings(input, "filters", inputPath, true);
+        if (input.contains("filters") && type != InputDefinition::File)
+            check.fail(inputPath + ".filters", "only applies to file inputs");
+
+        check.expectStrings(input, "choices", inputPath, false);
+        if (type == InputDefinition::Choice) {
+            const QJsonArray choices = input.value("choices").toArray();
+            if (choices.isEmpty()) check.fail(inputPath + ".choices", "is required for choice inputs");
+            if (input.contains("default") && !choices.contains(input.value("default")))
+                check.fail(inputPath + ".default", "is not one of the choices");
+        }
+    }
+}
+
+void checkLimits(Checker &check, const QJsonValue &value, const QString &path)
+{
+    if (value.isUndefined()) return;
+    if (!value.isObject()) {
+        check.fail(path, "must be an object");
+        return;
+    }
+
+    const QJsonObject limits = value.toObject();
+    check.expectKnownKeys(limits, path, { "timeout_sec", "kill_grace_sec", "cpu_sec", "memory_mb", "nice",
+                                          "max_open_files", "cpu_affinity" });
+    for (const char *key : { "timeout_sec", "kill_grace_sec", "cpu_sec", "memory_mb", "max_open_files" })
+        check.expectNumber(limits, key, path, 0);
+    check.expectNumber(limits, "nice", path, -20, 19);
+
+    const QJsonValue affinity = limits.value("cpu_affinity");
+    if (!affinity.isUndefined()) {
+        const QJsonArray cpus = affinity.toArray();
+        if (!affinity.isArray()) check.fail(path + ".cpu_affinity", "must be an array of CPU numbers");
+        for (qsizetype i = 0; i < cpus.size(); ++i) {
+            if (!cpus.at(i).isDouble() || cpus.at(i).toInt(-1) < 0)
+                check.fail(QString("%1.cpu_affinity[%2]").arg(path).arg(i), "must be a CPU number");
+        }
+    }
+}
+
+void checkWatch(Checker &check, const QJsonValue &value, const QString &path)
+{
+    if (value.isUndefined()) return;
+    if (!value.isObject()) {
+        check.fail(path, "must be an object");
+        return;
+    }
+
+    const QJsonObject watch = value.toObject();
+    check.expectKnownKeys(watch, path, { "path", "patterns", "pattern", "recursive", "debounce_ms" });
+    check.expectString(watch, "path", path, true);
+    check.expectStrings(watch, "patterns", path, false);
+    check.expectString(watch, "pattern", path);
+    check.expectBool(watch, "recursive", path);
+    check.expectNumber(watch, "debounce_ms", path, 0);
+}
+
+} // namespace
+
+QStringList ActionSchema::validateRoot(const QJsonObject &root)
+{
+    QStringList errors;
+    Checker check(&errors);
+
+    if (!root.value("actions").isArray())
+        check.fail("$.actions", root.contains("actions") ? "must be an array" : "is required");
+
+    const QJsonValue pools = root.value("pools");
+    if (!pools.isUndefined() && !pools.isObject()) {
+        check.fail("$.pools", "must be an object");
+    } else {
+        const QJsonObject poolObject = pools.toObject();
+        for (auto it = poolObject.constBegin(); it != poolObject.constEnd(); ++it) {
+            const QString path = "$.pools." + it.key();
+            if (!it.value().isObject()) {
+                check.fail(path, "must be an object");
+                continue;
+            }
+            const QJsonObject pool = it.value().toObject();
+            check.expectString(pool, "program", path, true);
+            check.expectStrings(pool, "arguments", path, false);
+            check.expectString(pool, "working_directory", path);
+            check.expectNumber(pool, "size", path, 1, 64);
+        }
+    }
+    return errors;
+}
+
+QStringList ActionSchema::validateAction(const QJsonValue &value, const QString &path, const QJsonObject &pools)
+{
+    QStringList errors;
+    Checker check(&errors);
+
+    if (!value.isObject()) {
+        check.fail(path, "must be an object");
+        return errors;
+    }
+
+    const QJsonObject action = value.toObject();
+    check.expectString(action, "id", path, true);
+    for (const char *key : { "name", "icon", "category", "description" })
+        check.expectString(action, key, path);
+
+    ActionDefinition::Kind kind = ActionDefinition::UnknownKind;
+    if (check.expectString(action, "type", path, true)) {
+        kind = ActionDefinition::kindFromType(action.value("type").toString());
+        if (kind == ActionDefinition::UnknownKind) {
+            check.fail(path + ".type", QString("unknown type \"%1\"; expected exe, exe_with_args, exe_with_input, "
+                                               "exe_in_cmd, exe_admin or workflow")
+                                           .arg(action.value("type").toString()));
+        }
+    }
+
+    if (kind == ActionDefinition::Workflow) {
+        WorkflowDefinition workflow;
+        QString error;
+        if (!WorkflowDefinition::fromJson(action, &workflow, &error)) check.fail(path + ".steps", error);
+    } else {
+        check.expectString(action, "command", path, true);
+    }
+
+    checkInputs(check, action.value("inputs"), path + ".inputs");
+    check.expectBool(action, "detached", path);
+    check.expectBool(action, "cacheable", path);
+
+    if (check.expectString(action, "pool", path) && action.contains("pool")
+        && !pools.contains(action.value("pool").toString())) {
+        check.fail(path + ".pool", QString("no pool named \"%1\" in $.pools").arg(action.value("pool").toString()));
+    }
+
+    checkLimits(check, action.value("limits"), path + ".limits");
+
+    if (check.expectString(action, "schedule", path) && action.contains("schedule")) {
+        QString error;
+        if (!CronExpression::parse(action.value("schedule").toString(), &error).isValid())
+            check.fail(path + ".schedule", error);
+    }
+    checkWatch(check, action.value("watch"), path + ".watch");
+
+    if (check.expectString(action, "batch", path) && action.contains("batch")) {
+        const QString batch = action.value("batch").toString();
+        if (batch != "per_file" && batch != "chunked") check.fail(path + ".batch", "must be per_file or chunked");
+    }
+    check.expectNumber(action, "max_parallel", path, 0, 1024);
+
+    return errors;
+}
@@ -0,0 +1,22 @@
+#ifndef ACTIONSCHEMA_H
+#define ACTIONSCHEMA_H
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QStringList>
+
+// Load-time checks for an actions file. Every problem is reported with
+// the JSON path it was found at, e.g.
+//   $.actions[2].inputs[0].type: unknown input type "files"
+// so a broken entry shows up when the file is loaded, not when somebody
+// clicks it. Keys the schema doesn't know are left alone.
+class ActionSchema
+{
+public:
+    // Problems with the file as a whole; nothing can be loaded
+    static QStringList validateRoot(const QJsonObject &root);
+    // Problems with one entry of "actions"; that entry is left out
+    static QStringList validateAction(const QJsonValue &value, const QString &path, const QJsonObject &pools);
+};
+
+#endif // ACTIONSCHEMA_H
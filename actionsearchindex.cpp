@@ -0,0 +1,214 @@
+#include "actionsearchindex.h"
+#include <QSet>
+#include <algorithm>
+
+// Fraction of query trigrams a document must share to count as a fuzzy hit
+static const double FuzzyThreshold = 0.5;
+// Bound the work for very unselective short-prefix queries
+static const int MaxPrefixCandidates = 5000;
+
+void ActionSearchIndex::clear()
+{
+    m_docs.clear();
+    m_docById.clear();
+    m_postings.clear();
+    m_prefixes.clear();
+    m_prefixesSorted = true;
+    m_deadDocs = 0;
+}
+
+void ActionSearchIndex::insert(const Fields &fields)
+{
+    remove(fields.id);
+
+    Document document;
+    document.id = fields.id;
+    document.idLower = fields.id.toLower();
+    document.nameLower = fields.name.toLower();
+    document.descriptionLower = fields.description.toLower();
+    document.categoryLower = fields.category.toLower();
+    document.nameWords = wordSpans(document.nameLower);
+
+    const int doc = m_docs.size();
+    m_docs.append(document);
+    m_docById.insert(fields.id, doc);
+    indexDocument(doc);
+}
+
+void ActionSearchIndex::remove(const QString &actionId)
+{
+    auto it = m_docById.find(actionId);
+    if (it == m_docById.end()) return;
+
+    // Postings are filtered lazily and rebuilt once enough are dead
+    m_docs[it.value()].alive = false;
+    m_docById.erase(it);
+    ++m_deadDocs;
+
+    if (m_deadDocs > 64 && m_deadDocs > m_docById.size())
+        compact();
+}
+
+quint64 ActionSearchIndex::trigramKey(const QChar *c)
+{
+    return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | c[2].unicode();
+}
+
+QVector<quint64> ActionSearchIndex::trigrams(const QString &text)
+{
+    QVector<quint64> keys;
+    if (text.size() < 3) return keys;
+
+    keys.reserve(text.size() - 2);
+    for (qsizetype i = 0; i + 2 < text.size(); ++i)
+        keys.append(trigramKey(text.constData() + i));
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+QVector<ActionSearchIndex::WordSpan> ActionSearchIndex::wordSpans(const QString &text)
+{
+    QVector<WordSpan> spans;
+    int start = -1;
+    for (int i = 0; i <= int(text.size()); ++i) {
+        const bool wordChar = i < text.size() && text.at(i).isLetterOrNumber();
+        if (wordChar && start < 0) {
+            start = i;
+        } else if (!wordChar && start >= 0) {
+            spans.append({ start, i - start });
+            start = -1;
+        }
+    }
+    return spans;
+}
+
+QStringList ActionSearchIndex::words(const QString &text)
+{
+    QStringList result;
+    for (const WordSpan &span : wordSpans(text)) result.append(text.mid(span.start, span.length));
+    return result;
+}
+
+void ActionSearchIndex::indexDocument(int doc)
+{
+    const Document &document = m_docs.at(doc);
+
+    // Name and id are matched both fuzzily and by prefix; description and
+    // category only contribute trigrams
+    const QString text = document.nameLower + '\n' + document.idLower + '\n'
+                         + document.categoryLower + '\n' + document.descriptionLower;
+    for (quint64 key : trigrams(text))
+        m_postings[key].append(doc);
+
+    QSet<QString> seen;
+    for (const QString &word : words(document.nameLower) + words(document.idLower)) {
+        if (seen.contains(word)) continue;
+        seen.insert(word);
+        m_prefixes.append({ word, doc });
+    }
+    m_prefixesSorted = false;
+}
+
+void ActionSearchIndex::compact()
+{
+    QVector<Document> alive;
+    alive.reserve(m_docById.size());
+    for (const Document &document : std::as_const(m_docs)) {
+        if (document.alive) alive.append(document);
+    }
+
+    m_docs.clear();
+    m_docById.clear();
+    m_postings.clear();
+    m_prefixes.clear();
+    m_deadDocs = 0;
+
+    for (const Document &document : std::as_const(alive)) {
+        const int doc = m_docs.size();
+        m_docs.append(document);
+        m_docById.insert(document.id, doc);
+        indexDocument(doc);
+    }
+}
+
+int ActionSearchIndex::score(const Document &doc, const QString &query,
+                             int matchedTrigrams, int queryTrigrams) const
+{
+    if (doc.idLower == query) return 1000;
+    if (doc.nameLower == query) return 950;
+    if (doc.nameLower.startsWith(query)) return 900;
+
+    for (const WordSpan &word : doc.nameWords) {
+        if (word.length >= query.size()
+            && QStringView(doc.nameLower).mid(word.start, word.length).startsWith(query))
+            return 800;
+    }
+
+    if (doc.nameLower.contains(query)) return 700;
+    if (doc.idLower.contains(query)) return 600;
+    if (doc.categoryLower.contains(query)) return 450;
+    if (doc.descriptionLower.contains(query)) return 400;
+
+    // Fuzzy hit: rank by the share of query trigrams present
+    if (queryTrigrams > 0) return 100 + 200 * matchedTrigrams / queryTrigrams;
+    return 0;
+}
+
+QVector<ActionSearchIndex::Match> ActionSearchIndex::search(const QString &query, int limit) const
+{
+    QVector<Match> matches;
+    const QString q = query.trimmed().toLower();
+    if (q.isEmpty() || limit <= 0) return matches;
+
+    const QVector<quint64> queryTrigrams = trigrams(q);
+
+    if (queryTrigrams.isEmpty()) {
+        // One or two characters: word prefixes of names and ids
+        if (!m_prefixesSorted) {
+            std::sort(m_prefixes.begin(), m_prefixes.end());
+            m_prefixesSorted = true;
+        }
+
+        auto it = std::lower_bound(m_prefixes.cbegin(), m_prefixes.cend(), qMakePair(q, -1));
+        QSet<int> seen;
+        for (; it != m_prefixes.cend() && it->first.startsWith(q); ++it) {
+            const Document &doc = m_docs.at(it->second);
+            if (!doc.alive || seen.contains(it->second)) continue;
+            seen.insert(it->second);
+            matches.append({ doc.id, score(doc, q, 0, 0) });
+            if (matches.size() >= MaxPrefixCandidates) break;
+        }
+    } else {
+        // Count how many query trigrams each document contains
+        QHash<int, int> hits;
+        for (quint64 key : queryTrigrams) {
+            auto posting = m_postings.constFind(key);
+            if (posting == m_postings.constEnd()) continue;
+            for (int doc : posting.value()) ++hits[doc];
+        }
+
+        const int required = qMax(1, int(queryTrigrams.size() * FuzzyThreshold + 0.5));
+        for (auto it = hits.constBegin(); it != hits.constEnd(); ++it) {
+            if (it.value() < required) continue;
+            const Document &doc = m_docs.at(it.key());
+            if (!doc.alive) continue;
+            matches.append({ doc.id, score(doc, q, it.value(), queryTrigrams.size()) });
+        }
+    }
+
+    // Best score first, ties broken by id for a stable order
+    auto better = [](const Match &a, const Match &b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.actionId < b.actionId;
+    };
+
+    if (matches.size() > limit) {
+        std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), better);
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end(), better);
+    }
+    return matches;
+}
@@ -0,0 +1,69 @@
+#ifndef ACTIONSEARCHINDEX_H
+#define ACTIONSEARCHINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QPair>
+
+// In-memory search index over the action catalog. Queries of three or more
+// characters go through a trigram inverted index, which also tolerates
+// typos. Shorter queries use a sorted word-prefix table. Documents can be
+// added and removed one at a time, so a catalog reload only touches the
+// actions that changed.
+class ActionSearchIndex
+{
+public:
+    struct Fields {
+        QString id;
+        QString name;
+        QString description;
+        QString category;
+    };
+
+    struct Match {
+        QString actionId;
+        int score;
+    };
+
+    void clear();
+    void insert(const Fields &fields);
+    void remove(const QString &actionId);
+    int size() const { return m_docById.size(); }
+
+    QVector<Match> search(const QString &query, int limit) const;
+
+private:
+    struct WordSpan {
+        int start;
+        int length;
+    };
+
+    struct Document {
+        QString id;
+        QString idLower;
+        QString nameLower;
+        QString descriptionLower;
+        QString categoryLower;
+        QVector<WordSpan> nameWords; // Found at insert so scoring never splits
+        bool alive = true;
+    };
+
+    QVector<Document> m_docs;
+    QHash<QString, int> m_docById;
+    QHash<quint64, QVector<int>> m_postings; // trigram -> ascending doc numbers
+    mutable QVector<QPair<QString, int>> m_prefixes; // word -> doc, sorted lazily
+    mutable bool m_prefixesSorted = true;
+    int m_deadDocs = 0;
+
+    static quint64 trigramKey(const QChar *c);
+    static QVector<quint64> trigrams(const QString &text);
+    static QVector<WordSpan> wordSpans(const QString &text);
+    static QStringList words(const QString &text);
+
+    void indexDocument(int doc);
+    void compact();
+    int score(const Document &doc, const QString &query, int matchedTrigrams, int queryTrigrams) const;
+};
+
+#endif // ACTIONSEARCHINDEX_H
@@ -0,0 +1,337 @@
+#include "batchrunner.h"
+#include "actiondefinition.h"
+#include "jobscheduler.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QPointer>
+#include <QSet>
+#include <QThreadPool>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+extern char **environ;
+#endif
+
+namespace {
+
+// Stands in for {file} and {files} until the arguments are split
+const QString FilesMarker = QString(QChar(0xFFFF)) + "files" + QChar(0xFFFF);
+
+// What an argument vector takes out of the limit: the strings and a pointer each
+qsizetype argumentsSize(const QStringList &arguments)
+{
+    qsizetype size = 0;
+    for (const QString &argument : arguments)
+        size += argument.toLocal8Bit().size() + 1 + qsizetype(sizeof(char *));
+    return size;
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(JobScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_scheduler(scheduler)
+{
+    connect(m_scheduler, &JobScheduler::jobFinished, this,
+            [this](int jobId, int exitCode, QProcess::ExitStatus exitStatus) {
+                complete(jobId, exitStatus == QProcess::NormalExit && exitCode == 0, exitCode);
+            });
+    connect(m_scheduler, &JobScheduler::jobError, this, [this](int jobId) {
+        complete(jobId, false, -1);
+    });
+    connect(m_scheduler, &JobScheduler::jobCanceled, this, [this](int jobId) {
+        complete(jobId, false, -1);
+    });
+}
+
+QStringList BatchRunner::expandPaths(const QStringList &paths)
+{
+    QStringList files;
+    QSet<QString> seen;
+
+    auto addFile = [&](const QString &path) {
+        const QString absolute = QFileInfo(path).absoluteFilePath();
+        if (seen.contains(absolute)) return;
+        seen.insert(absolute);
+        files.append(absolute);
+    };
+
+    auto addEntry = [&](const QString &path) {
+        const QFileInfo info(path);
+        if (info.isFile()) {
+            addFile(path);
+        } else if (info.isDir()) {
+            QStringList found;
+            QDirIterator it(path, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+            while (it.hasNext()) found.append(it.next());
+            std::sort(found.begin(), found.end());
+            for (const QString &file : std::as_const(found)) addFile(file);
+        }
+    };
+
+    for (QString path : paths) {
+        // Drops arrive as file:// URLs
+        if (path.startsWith("file:")) path = QUrl(path).toLocalFile();
+        if (path.isEmpty()) continue;
+
+        const QFileInfo info(path);
+        const QString name = info.fileName();
+        if (name.contains('*') || name.contains('?') || name.contains('[')) {
+            const QDir dir = info.dir();
+            const QStringList matches = dir.entryList({ name }, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                                                      QDir::Name);
+            for (const QString &match : matches) addEntry(dir.filePath(match));
+        } else {
+            addEntry(path);
+        }
+    }
+    return files;
+}
+
+qsizetype BatchRunner::commandLineLimit()
+{
+#ifdef Q_OS_WIN
+    // CreateProcess caps the whole command line at 32767 characters
+    return 32000;
+#else
+    // ARG_MAX covers argv and the environment together
+    long limit = sysconf(_SC_ARG_MAX);
+    if (limit <= 0) limit = 128 * 1024;
+
+    qsizetype environment = 0;
+    for (char **variable = environ; variable && *variable; ++variable)
+        environment += qstrlen(*variable) + 1 + sizeof(char *);
+
+    return qMax<qsizetype>(4096, limit - environment - 4096);
+#endif
+}
+
+int BatchRunner::start(const ActionDefinition &action, const QStringList &paths, const QVariantMap &inputs)
+{
+    Batch batch;
+    batch.id = m_nextBatchId++;
+    batch.actionId = action.id;
+    batch.command = action.commandTemplate;
+    batch.pool = action.pool;
+    batch.limits = action.limits;
+    batch.inputs = inputs;
+    batch.mode = action.batchMode;
+    batch.maxParallel = action.maxParallel;
+    batch.startedAt = QDateTime::currentMSecsSinceEpoch();
+    m_batches.insert(batch.id, batch);
+
+    // Walking a dropped folder can take a while; keep it off the UI thread
+    const int batchId = batch.id;
+    QPointer<BatchRunner> self(this);
+    QThreadPool::globalInstance()->start([self, batchId, paths]() {
+        const QStringList files = expandPaths(paths);
+        if (!self) return;
+        QMetaObject::invokeMethod(self.data(), [self, batchId, files]() {
+            if (self) self->plan(batchId, files);
+        }, Qt::QueuedConnection);
+    });
+    return batchId;
+}
+
+bool BatchRunner::cancel(int batchId)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end()) return false;
+    it->canceled = true;
+
+    QList<int> jobs;
+    for (auto job = m_jobs.cbegin(); job != m_jobs.cend(); ++job) {
+        if (job.value().first == batchId) jobs.append(job.key());
+    }
+
+    // Running jobs report back through complete(), which ends the batch
+    if (jobs.isEmpty()) {
+        pump(batchId);
+    } else {
+        for (int jobId : std::as_const(jobs)) m_scheduler->cancel(jobId);
+    }
+    return true;
+}
+
+QStringList BatchRunner::render(const Batch &batch, const QStringList &files) const
+{
+    // Every file is an argument of its own and never re-parsed; an argument
+    // holding {file} or {files} is repeated once per file. Without either
+    // placeholder the files go last.
+    QVariantMap inputs = batch.inputs;
+    inputs.insert("file", FilesMarker);
+    inputs.insert("files", FilesMarker);
+    const QStringList arguments = batch.command.renderArguments(inputs);
+
+    QStringList result;
+    result.reserve(arguments.size() + files.size());
+    bool placed = false;
+    for (const QString &argument : arguments) {
+        if (!argument.contains(FilesMarker)) {
+            result.append(argument);
+            continue;
+        }
+        placed = true;
+        for (const QString &file : files) result.append(QString(argument).replace(FilesMarker, file));
+    }
+
+    if (!placed) result += files;
+    return result;
+}
+
+void BatchRunner::plan(int batchId, const QStringList &files)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end()) return;
+    Batch &batch = it.value();
+    batch.total = files.size();
+
+    if (files.isEmpty()) {
+        // Nothing to run is a failed drop, not a batch that went fine
+        const Batch empty = m_batches.take(batchId);
+        QVariantMap summary;
+        summary["total"] = 0;
+        summary["succeeded"] = 0;
+        summary["failed"] = 0;
+        summary["skipped"] = 0;
+        summary["invocations"] = 0;
+        summary["canceled"] = empty.canceled;
+        summary["elapsedMs"] = QDateTime::currentMSecsSinceEpoch() - empty.startedAt;
+        summary["failedFiles"] = QStringList();
+        summary["error"] = QString("No files found in the dropped paths");
+
+        qWarning() << "Batch" << batchId << "for" << empty.actionId << "matched no files";
+        emit batchStarted(batchId, empty.actionId, 0);
+        emit batchFinished(batchId, empty.actionId, summary);
+        return;
+    }
+
+    if (batch.mode == ActionDefinition::PerFile) {
+        batch.invocations.reserve(files.size());
+        for (const QString &file : files) batch.invocations.append({ { file }, render(batch, { file }) });
+    } else {
+        // Greedy packing
+        const qsizetype limit = commandLineLimit();
+        const qsizetype base = argumentsSize(render(batch, {}));
+        QStringList chunk;
+        qsizetype size = base;
+        for (const QString &file : files) {
+            const qsizetype cost = argumentsSize(render(batch, { file })) - base;
+            if (!chunk.isEmpty() && size + cost > limit) {
+                batch.invocations.append({ chunk, render(batch, chunk) });
+                chunk.clear();
+                size = base;
+            }
+            chunk.append(file);
+            size += cost;
+        }
+        if (!chunk.isEmpty()) batch.invocations.append({ chunk, render(batch, chunk) });
+    }
+
+    qDebug() << "Batch" << batchId << "for" << batch.actionId << ":" << batch.total << "files in"
+             << batch.invocations.size() << "invocations";
+    emit batchStarted(batchId, batch.actionId, batch.total);
+
+    pump(batchId);
+}
+
+void BatchRunner::pump(int batchId)
+{
+    // Slots on our signals may cancel or start batches, which moves or drops
+    // entries of m_batches; look the batch up again after every emit
+    auto it = m_batches.find(batchId);
+    while (it != m_batches.end()) {
+        Batch &batch = it.value();
+        const int limit = batch.maxParallel > 0 ? batch.maxParallel : m_scheduler->maxConcurrency();
+        if (batch.canceled || batch.running >= limit || batch.next >= batch.invocations.size()) break;
+
+        const int index = batch.next++;
+        QStringList argv = batch.invocations.at(index).arguments;
+
+        int jobId = 0;
+        if (!argv.isEmpty()) {
+            JobScheduler::JobSpec spec;
+            spec.program = argv.takeFirst();
+            spec.arguments = argv;
+            spec.tag = QString("%1/batch%2").arg(batch.actionId).arg(batchId);
+            spec.pool = batch.pool;
+            spec.limits = batch.limits;
+            jobId = m_scheduler->submit(spec);
+        }
+
+        // submit() emits jobQueued synchronously
+        it = m_batches.find(batchId);
+        if (it == m_batches.end()) {
+            if (jobId > 0) m_scheduler->cancel(jobId);
+            return;
+        }
+
+        if (jobId <= 0) {
+            const QStringList files = it->invocations.at(index).files;
+            it->completed += files.size();
+            it->failed += files.size();
+            it->failedFiles += files;
+            const int completed = it->completed;
+            const int total = it->total;
+            const int failed = it->failed;
+            for (const QString &file : files) emit fileFinished(batchId, file, false, -1);
+            emit batchProgress(batchId, completed, total, failed);
+            it = m_batches.find(batchId);
+            continue;
+        }
+
+        m_jobs.insert(jobId, { batchId, index });
+        ++it->running;
+    }
+
+    if (it == m_batches.end()) return;
+    if (it->running > 0 || (!it->canceled && it->next < it->invocations.size())) return;
+
+    // Nothing left in flight - report and drop the batch
+    const Batch finished = m_batches.take(batchId);
+    QVariantMap summary;
+    summary["total"] = finished.total;
+    summary["succeeded"] = finished.completed - finished.failed;
+    summary["failed"] = finished.failed;
+    summary["skipped"] = finished.total - finished.completed;
+    summary["invocations"] = finished.next;
+    summary["canceled"] = finished.canceled;
+    summary["elapsedMs"] = QDateTime::currentMSecsSinceEpoch() - finished.startedAt;
+    summary["failedFiles"] = finished.failedFiles;
+
+    qDebug() << "Batch" << finished.id << "finished:" << summary;
+    emit batchFinished(finished.id, finished.actionId, summary);
+}
+
+void BatchRunner::complete(int jobId, bool success, int exitCode)
+{
+    auto job = m_jobs.constFind(jobId);
+    if (job == m_jobs.constEnd()) return;
+    const auto [batchId, index] = job.value();
+    m_jobs.erase(job);
+
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end()) return;
+    Batch &batch = it.value();
+    --batch.running;
+
+    const QStringList files = batch.invocations.at(index).files;
+    batch.completed += files.size();
+    if (!success) {
+        batch.failed += files.size();
+        batch.failedFiles += files;
+    }
+    const int completed = batch.completed;
+    const int total = batch.total;
+    const int failed = batch.failed;
+
+    for (const QString &file : files) emit fileFinished(batchId, file, success, exitCode);
+    emit batchProgress(batchId, completed, total, failed);
+
+    pump(batchId);
+}
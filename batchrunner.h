@@ -0,0 +1,81 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+#include "actiondefinition.h"
+#include "commandtemplate.h"
+#include "joblimits.h"
+
+class JobScheduler;
+
+// Runs one file action over many files. Dropped paths are expanded off the
+// UI thread (directories recursively, wildcards against their folder),
+// then the action runs either once per file, at most max_parallel at a
+// time, or with the files packed into as few command lines as the OS
+// argument limit allows ("batch": "chunked").
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BatchRunner(JobScheduler *scheduler, QObject *parent = nullptr);
+
+    // Returns a batch id; the work starts once the paths are expanded
+    int start(const ActionDefinition &action, const QStringList &paths, const QVariantMap &inputs);
+    bool cancel(int batchId);
+
+    static QStringList expandPaths(const QStringList &paths);
+    static qsizetype commandLineLimit();
+
+signals:
+    void batchStarted(int batchId, const QString &actionId, int total);
+    void fileFinished(int batchId, const QString &filePath, bool success, int exitCode);
+    void batchProgress(int batchId, int completed, int total, int failed);
+    // summary: total, succeeded, failed, invocations, elapsedMs, failedFiles,
+    // and error when the dropped paths held no files
+    void batchFinished(int batchId, const QString &actionId, const QVariantMap &summary);
+
+private:
+    struct Invocation {
+        QStringList files;
+        QStringList arguments; // Program first
+    };
+
+    struct Batch {
+        int id = 0;
+        QString actionId;
+        CommandTemplate command;
+        QString pool;
+        JobLimits limits; // Per job, not for the batch as a whole
+        QVariantMap inputs;
+        ActionDefinition::BatchMode mode = ActionDefinition::PerFile;
+        int maxParallel = 0;
+        QVector<Invocation> invocations;
+        int next = 0; // First invocation not submitted yet
+        int running = 0;
+        int total = 0;
+        int completed = 0;
+        int failed = 0;
+        bool canceled = false;
+        QStringList failedFiles;
+        qint64 startedAt = 0;
+    };
+
+    JobScheduler *m_scheduler;
+    QHash<int, Batch> m_batches;
+    QHash<int, QPair<int, int>> m_jobs; // job id -> (batch id, invocation)
+    int m_nextBatchId = 1;
+
+    void plan(int batchId, const QStringList &files);
+    void pump(int batchId);
+    void complete(int jobId, bool success, int exitCode);
+    QStringList render(const Batch &batch, const QStringList &files) const;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,256 @@
+#include "catalogcache.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+
+const char CacheMagic[4] = { 'S', 'R', 'A', 'C' };
+const quint32 CacheVersion = 9;
+
+enum RecordFlag : quint32 {
+    DetachedFlag = 0x1,
+    HasInputsFlag = 0x2,
+    CacheableFlag = 0x4,
+    HasLimitsFlag = 0x8,
+    HasTriggersFlag = 0x10,
+    ChunkedFlag = 0x20
+};
+
+enum StringField {
+    IdField,
+    NameField,
+    IconField,
+    CategoryField,
+    DescriptionField,
+    TypeField,
+    CommandField,
+    PoolField,
+    StringFieldCount
+};
+
+struct Span {
+    quint32 offset;
+    quint32 length;
+};
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    qint64 sourceSize;
+    char sourceHash[16];   // MD5 of the JSON file's bytes
+    quint32 recordCount;
+    quint32 recordsOffset;
+    quint32 stringsOffset; // UTF-16 string table, lengths in code units
+    quint32 stringsSize;
+    quint32 blobsOffset;   // UTF-8 source JSON of each action
+    quint32 blobsSize;
+    quint32 poolsOffset;   // UTF-8 "pools" object
+    quint32 poolsSize;
+};
+
+struct Record {
+    Span strings[StringFieldCount];
+    Span source;
+    quint32 flags;
+    quint32 maxParallel;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "header keeps records aligned");
+static_assert(sizeof(Record) % 8 == 0, "records keep the string table aligned");
+
+
+bool spanFits(const Span &span, quint64 unitSize, quint64 areaSize)
+{
+    return (quint64(span.offset) + span.length) * unitSize <= areaSize;
+}
+
+} // namespace
+
+QString CatalogCache::cachePath(const QString &jsonPath)
+{
+    return jsonPath + ".cache";
+}
+
+QByteArray CatalogCache::sourceHash(const QByteArray &json)
+{
+    return QCryptographicHash::hash(json, QCryptographicHash::Md5);
+}
+
+bool CatalogCache::load(const QString &jsonPath, QVector<ActionDefinition> *actions, QJsonObject *pools)
+{
+    QFile source(jsonPath);
+    if (!source.open(QIODevice::ReadOnly)) return false;
+
+    QFile file(cachePath(jsonPath));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(Header))) return false;
+
+    const uchar *image = file.map(0, fileSize);
+    if (!image) return false;
+
+    Header header;
+    std::memcpy(&header, image, sizeof(header));
+
+    if (std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0
+        || header.version != CacheVersion
+        || header.sourceSize != source.size()) {
+        return false; // Stale or foreign, caller rebuilds from JSON
+    }
+
+    // Timestamps miss same-size edits within their resolution and flag
+    // untouched files after a checkout; the content decides
+    const QByteArray hash = sourceHash(source.readAll());
+    source.close();
+    if (hash.size() != qsizetype(sizeof(header.sourceHash))
+        || std::memcmp(header.sourceHash, hash.constData(), sizeof(header.sourceHash)) != 0) {
+        return false;
+    }
+
+    // Don't trust offsets from disk
+    if (quint64(header.recordsOffset) + quint64(header.recordCount) * sizeof(Record) > quint64(fileSize)
+        || quint64(header.stringsOffset) + header.stringsSize > quint64(fileSize)
+        || quint64(header.blobsOffset) + header.blobsSize > quint64(fileSize)
+        || quint64(header.poolsOffset) + header.poolsSize > quint64(fileSize)
+        || header.stringsOffset % alignof(char16_t) != 0) {
+        qWarning() << "Corrupt actions cache:" << file.fileName();
+        return false;
+    }
+
+    const auto *records = reinterpret_cast<const Record *>(image + header.recordsOffset);
+    const auto *strings = reinterpret_cast<const QChar *>(image + header.stringsOffset);
+    const auto *blobs = reinterpret_cast<const char *>(image + header.blobsOffset);
+
+    QVector<ActionDefinition> table;
+    table.reserve(header.recordCount);
+
+    for (quint32 i = 0; i < header.recordCount; ++i) {
+        const Record &record = records[i];
+
+        for (const Span &span : record.strings) {
+            if (!spanFits(span, sizeof(char16_t), header.stringsSize)) return false;
+        }
+        if (!spanFits(record.source, 1, header.blobsSize)) return false;
+
+        auto text = [&](StringField field) {
+            const Span &span = record.strings[field];
+            return QString(strings + span.offset, span.length);
+        };
+
+        ActionDefinition action;
+        action.id = text(IdField);
+        action.name = text(NameField);
+        action.icon = text(IconField);
+        action.category = text(CategoryField);
+        action.description = text(DescriptionField);
+        action.type = text(TypeField);
+        action.kind = ActionDefinition::kindFromType(action.type);
+        action.command = text(CommandField);
+        action.pool = text(PoolField);
+        action.commandTemplate = CommandTemplate::compile(action.command);
+        action.detached = record.flags & DetachedFlag;
+        action.cacheable = record.flags & CacheableFlag;
+        action.batchMode = record.flags & ChunkedFlag ? ActionDefinition::Chunked : ActionDefinition::PerFile;
+        action.maxParallel = int(record.maxParallel);
+        action.source = QByteArray(blobs + record.source.offset, record.source.length);
+
+        // Only actions that declare inputs pay for decoding their JSON
+        if (record.flags & (HasInputsFlag | HasLimitsFlag | HasTriggersFlag)) {
+            const QJsonObject object = action.object();
+            action.setInputs(object.value("inputs").toArray());
+            action.limits = JobLimits::fromJson(object.value("limits").toObject());
+            action.schedule = object.value("schedule").toString();
+            action.watch = object.value("watch").toObject();
+        }
+
+        table.append(std::move(action));
+    }
+
+    *actions = std::move(table);
+    *pools = header.poolsSize == 0 ? QJsonObject()
+             : QJsonDocument::fromJson(QByteArray(reinterpret_cast<const char *>(image + header.poolsOffset),
+                                                  header.poolsSize)).object();
+    return true;
+}
+
+bool CatalogCache::save(const QString &jsonPath, const QByteArray &json, const QVector<ActionDefinition> &actions,
+                        const QJsonObject &pools)
+{
+    Header header;
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    // The bytes the actions came from, not whatever the file holds by now
+    header.sourceSize = json.size();
+    const QByteArray hash = sourceHash(json);
+    std::memcpy(header.sourceHash, hash.constData(), sizeof(header.sourceHash));
+
+    QVector<Record> records(actions.size());
+    QVector<char16_t> strings;
+    QByteArray blobs;
+
+    auto addString = [&strings](const QString &value) {
+        Span span { quint32(strings.size()), quint32(value.size()) };
+        strings.resize(strings.size() + value.size());
+        std::memcpy(strings.data() + span.offset, value.utf16(), value.size() * sizeof(char16_t));
+        return span;
+    };
+
+    for (qsizetype i = 0; i < actions.size(); ++i) {
+        const ActionDefinition &action = actions.at(i);
+        Record &record = records[i];
+
+        record.strings[IdField] = addString(action.id);
+        record.strings[NameField] = addString(action.name);
+        record.strings[IconField] = addString(action.icon);
+        record.strings[CategoryField] = addString(action.category);
+        record.strings[DescriptionField] = addString(action.description);
+        record.strings[TypeField] = addString(action.type);
+        record.strings[CommandField] = addString(action.command);
+        record.strings[PoolField] = addString(action.pool);
+
+        record.source = { quint32(blobs.size()), quint32(action.source.size()) };
+        blobs.append(action.source);
+
+        record.flags = 0;
+        if (action.detached) record.flags |= DetachedFlag;
+        if (action.cacheable) record.flags |= CacheableFlag;
+        if (!action.inputs.isEmpty()) record.flags |= HasInputsFlag;
+        if (!action.limits.isEmpty()) record.flags |= HasLimitsFlag;
+        if (!action.schedule.isEmpty() || !action.watch.isEmpty()) record.flags |= HasTriggersFlag;
+        if (action.batchMode == ActionDefinition::Chunked) record.flags |= ChunkedFlag;
+        record.maxParallel = quint32(action.maxParallel);
+    }
+
+    const qint64 stringsBytes = strings.size() * qint64(sizeof(char16_t));
+    header.recordCount = quint32(records.size());
+    header.recordsOffset = sizeof(Header);
+    header.stringsOffset = header.recordsOffset + quint32(records.size() * sizeof(Record));
+    header.stringsSize = quint32(stringsBytes);
+    header.blobsOffset = header.stringsOffset + header.stringsSize;
+    header.blobsSize = quint32(blobs.size());
+
+    const QByteArray poolsJson = pools.isEmpty() ? QByteArray()
+                                 : QJsonDocument(pools).toJson(QJsonDocument::Compact);
+    header.poolsOffset = header.blobsOffset + header.blobsSize;
+    header.poolsSize = quint32(poolsJson.size());
+
+    // Write a new file and rename it over the old one, never truncate in place
+    QSaveFile file(cachePath(jsonPath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Actions cache not writable:" << file.fileName();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(records.constData()), records.size() * sizeof(Record));
+    file.write(reinterpret_cast<const char *>(strings.constData()), stringsBytes);
+    file.write(blobs);
+    file.write(poolsJson);
+    return file.commit();
+}
@@ -0,0 +1,30 @@
+#ifndef CATALOGCACHE_H
+#define CATALOGCACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+
+#include "actiondefinition.h"
+
+// Compiled form of an actions JSON file, stored next to it as
+// "<file>.cache". The image is a fixed header, an array of fixed-size
+// records and a string table, and is memory-mapped on load, so a warm
+// start copies strings straight out of the mapping instead of parsing JSON.
+// The cache is keyed by the JSON file's size and a hash of its content, so
+// an edit is noticed whatever the timestamps say. The top-level "pools"
+// object is kept alongside as compact JSON.
+class CatalogCache
+{
+public:
+    static QString cachePath(const QString &jsonPath);
+    static QByteArray sourceHash(const QByteArray &json);
+
+    static bool load(const QString &jsonPath, QVector<ActionDefinition> *actions, QJsonObject *pools);
+    // json: the file content the actions were parsed from
+    static bool save(const QString &jsonPath, const QByteArray &json, const QVector<ActionDefinition> &actions,
+                     const QJsonObject &pools);
+};
+
+#endif // CATALOGCACHE_H
@@ -0,0 +1,138 @@
+#include "commandtemplate.h"
+
+CommandTemplate CommandTemplate::compile(const QString &source)
+{
+    CommandTemplate tpl;
+    tpl.m_source = source;
+
+    auto addLiteral = [&tpl](qsizetype from, qsizetype to) {
+        if (to <= from) return;
+        Segment segment;
+        segment.offset = from;
+        segment.length = to - from;
+        tpl.m_literalLength += segment.length;
+        tpl.m_segments.append(segment);
+    };
+
+    qsizetype literalStart = 0;
+    qsizetype pos = 0;
+    const qsizetype size = source.size();
+
+    while (pos < size) {
+        const qsizetype open = source.indexOf(QLatin1Char('{'), pos);
+        if (open < 0) break;
+
+        const qsizetype close = source.indexOf(QLatin1Char('}'), open + 1);
+        if (close < 0) break;
+
+        // Same rule as the old "\{([^}]+)\}" pattern: empty braces are literal
+        if (close == open + 1) {
+            pos = close;
+            continue;
+        }
+
+        addLiteral(literalStart, open);
+
+        Segment segment;
+        segment.isPlaceholder = true;
+        segment.name = source.mid(open + 1, close - open - 1);
+        if (segment.name.endsWith(QLatin1String(":raw"))) {
+            segment.name.chop(4);
+            segment.escaping = Raw;
+        }
+        tpl.m_segments.append(segment);
+        ++tpl.m_placeholderCount;
+
+        pos = close + 1;
+        literalStart = pos;
+    }
+
+    addLiteral(literalStart, size);
+    return tpl;
+}
+
+QString CommandTemplate::render(const QVariantMap &inputs) const
+{
+    if (m_placeholderCount == 0) return m_source;
+
+    QString result;
+    result.reserve(m_literalLength + m_placeholderCount * 32);
+
+    for (const Segment &segment : m_segments) {
+        if (!segment.isPlaceholder) {
+            result.append(QStringView(m_source).mid(segment.offset, segment.length));
+            continue;
+        }
+
+        const QString value = inputs.value(segment.name).toString();
+        if (segment.escaping == Raw)
+            result.append(value);
+        else
+            result.append(escapeArgument(value));
+    }
+
+    return result;
+}
+
+QStringList CommandTemplate::renderArguments(const QVariantMap &inputs) const
+{
+    QStringList arguments;
+    QString current;
+    bool explicitArgument = false; // A {name} value is an argument even when empty
+    bool inQuote = false;
+    int quoteCount = 0;
+
+    // QProcess::splitCommand rules: quotes group, triple quotes are a literal quote
+    auto settleQuotes = [&]() {
+        if (quoteCount == 1) inQuote = !inQuote;
+        quoteCount = 0;
+    };
+    auto endArgument = [&]() {
+        if (!current.isEmpty() || explicitArgument) arguments.append(current);
+        current.clear();
+        explicitArgument = false;
+    };
+    auto parse = [&](QStringView text) {
+        for (const QChar c : text) {
+            if (c == QLatin1Char('"')) {
+                if (++quoteCount == 3) {
+                    quoteCount = 0;
+                    current.append(c);
+                }
+                continue;
+            }
+            settleQuotes();
+            if (!inQuote && c.isSpace())
+                endArgument();
+            else
+                current.append(c);
+        }
+    };
+
+    for (const Segment &segment : m_segments) {
+        if (!segment.isPlaceholder) {
+            parse(QStringView(m_source).mid(segment.offset, segment.length));
+        } else if (segment.escaping == Raw) {
+            parse(inputs.value(segment.name).toString());
+        } else {
+            settleQuotes();
+            current.append(inputs.value(segment.name).toString());
+            explicitArgument = true;
+        }
+    }
+    settleQuotes();
+    endArgument();
+    return arguments;
+}
+
+QString CommandTemplate::escapeArgument(const QString &arg)
+{
+    if (arg.isEmpty()) return "\"\"";
+
+    // Simple escaping - wrap in quotes if contains spaces
+    if (arg.contains(' ') || arg.contains('\t')) {
+        return "\"" + arg + "\"";
+    }
+
+    return arg;
+}
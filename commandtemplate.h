@@ -0,0 +1,51 @@
+#ifndef COMMANDTEMPLATE_H
+#define COMMANDTEMPLATE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QVariantMap>
+
+// A command string such as "tool.exe {file} --mode {mode:raw}" split once
+// into literal spans and placeholder slots, so rendering is a single pass
+// with no regex and no re-scanning of substituted values.
+class CommandTemplate
+{
+public:
+    enum Escaping {
+        Quoted, // {name}     - value quoted when it contains whitespace
+        Raw     // {name:raw} - value inserted verbatim
+    };
+
+    struct Segment {
+        bool isPlaceholder = false;
+        qsizetype offset = 0;  // Literal span in m_source
+        qsizetype length = 0;
+        QString name;          // Placeholder name
+        Escaping escaping = Quoted;
+    };
+
+    CommandTemplate() = default;
+
+    static CommandTemplate compile(const QString &source);
+
+    QString render(const QVariantMap &inputs) const;
+    // Program and arguments, split like QProcess::splitCommand(render()),
+    // except that {name} values are never re-parsed: quotes and spaces in a
+    // value stay inside its argument. {name:raw} values are split as text.
+    QStringList renderArguments(const QVariantMap &inputs) const;
+
+    const QString &source() const { return m_source; }
+    const QVector<Segment> &segments() const { return m_segments; }
+    bool hasPlaceholders() const { return m_placeholderCount > 0; }
+
+    static QString escapeArgument(const QString &arg);
+
+private:
+    QString m_source;
+    QVector<Segment> m_segments;
+    qsizetype m_literalLength = 0;
+    int m_placeholderCount = 0;
+};
+
+#endif // COMMANDTEMPLATE_H
@@ -0,0 +1,342 @@
+#include "controlserver.h"
+#include "actionmanager.h"
+#include "jobscheduler.h"
+#include "workflowrunner.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDebug>
+
+// A request line longer than this is treated as garbage
+static const int MaxRequestBytes = 1024 * 1024;
+
+ControlServer::ControlServer(ActionManager *actions, JobScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_actions(actions)
+    , m_scheduler(scheduler)
+    , m_server(new QLocalServer(this))
+{
+    // Only the user running the instance may connect
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &ControlServer::acceptClients);
+
+    // Only jobs of a watched run are reported, not every run of its action
+    connect(m_scheduler, &JobScheduler::jobQueued, this, [this](int jobId) {
+        if (!m_starting || m_starting->tracked) return;
+        const QString tag = m_scheduler->tag(jobId);
+        if (tag != m_starting->actionId) return;
+        m_starting->tracked = true;
+        m_jobs.insert(jobId, { m_starting->socket, m_starting->actionId, tag, true });
+        sendJobEvent(jobId, "queued");
+    });
+    connect(m_scheduler, &JobScheduler::jobStarted, this, [this](int jobId) {
+        sendJobEvent(jobId, "started");
+    });
+    connect(m_scheduler, &JobScheduler::jobOutput, this, &ControlServer::streamOutput);
+    connect(m_scheduler, &JobScheduler::jobFinished, this,
+            [this](int jobId, int exitCode, QProcess::ExitStatus exitStatus) {
+                streamOutput(jobId);
+                sendJobEvent(jobId, "finished", { { "exit_code", exitCode } });
+                endJob(jobId, exitStatus == QProcess::NormalExit && exitCode == 0);
+            });
+    connect(m_scheduler, &JobScheduler::jobError, this, [this](int jobId, const QString &error) {
+        sendJobEvent(jobId, "error", { { "error", error } });
+        endJob(jobId, false);
+    });
+    connect(m_scheduler, &JobScheduler::jobCanceled, this, [this](int jobId) {
+        sendJobEvent(jobId, "canceled");
+        endJob(jobId, false);
+    });
+
+    // Workflow steps are tagged "<workflow>/<step>" and belong to their run
+    if (WorkflowRunner *workflows = m_actions->workflowRunner()) {
+        connect(workflows, &WorkflowRunner::workflowStarted, this, [this](int runId, const QString &workflowId) {
+            if (!m_starting || m_starting->tracked || workflowId != m_starting->actionId) return;
+            m_starting->tracked = true;
+            m_workflows.insert(runId, m_starting->socket);
+        });
+        connect(workflows, &WorkflowRunner::stepStarted, this, [this](int runId, const QString &, int jobId) {
+            QLocalSocket *socket = m_workflows.value(runId);
+            if (!socket) return;
+            const QString tag = m_scheduler->tag(jobId);
+            m_jobs.insert(jobId, { socket, tag.section('/', 0, 0), tag, false });
+            sendJobEvent(jobId, "queued");
+        });
+        connect(workflows, &WorkflowRunner::workflowFinished, this,
+                [this](int runId, const QString &workflowId, bool success) {
+                    if (QLocalSocket *socket = m_workflows.take(runId)) sendDone(socket, workflowId, success);
+                });
+    }
+
+    // Runs that end while they start: detached launches, cached results and
+    // failures to start
+    connect(m_actions, &ActionManager::actionExecuted, this, [this](const QString &actionId, bool success) {
+        if (!m_starting || m_starting->tracked || actionId != m_starting->actionId) return;
+        m_starting->executed = true;
+        m_starting->success = success;
+    });
+    connect(m_actions, &ActionManager::actionResultCached, this,
+            [this](const QString &actionId, int exitCode, const QString &output) {
+                if (!m_starting || actionId != m_starting->actionId) return;
+                send(m_starting->socket, { { "event", "output" }, { "action", actionId }, { "stream", "stdout" },
+                                           { "cached", true }, { "exit_code", exitCode },
+                                           { "lines", QJsonArray::fromStringList(output.split('\n')) } });
+            });
+}
+
+ControlServer::~ControlServer()
+{
+    for (QLocalSocket *socket : m_clients.keys()) socket->disconnect(this);
+}
+
+QString ControlServer::serverName()
+{
+    // Lets tests and a second profile run their own instance
+    const QString name = qEnvironmentVariable("SCRIPTRUNNER_SOCKET");
+    if (!name.isEmpty()) return name;
+
+    QString user = qEnvironmentVariable("USER");
+    if (user.isEmpty()) user = qEnvironmentVariable("USERNAME");
+    return "ScriptRunner-" + user;
+}
+
+bool ControlServer::listen()
+{
+    if (m_server->listen(serverName())) return true;
+
+    // A crashed instance leaves its socket file behind
+    if (m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        QLocalSocket probe;
+        probe.connectToServer(serverName());
+        if (!probe.waitForConnected(100)) {
+            QLocalServer::removeServer(serverName());
+            if (m_server->listen(serverName())) return true;
+        }
+    }
+
+    qWarning() << "Control socket unavailable:" << m_server->errorString();
+    return false;
+}
+
+void ControlServer::acceptClients()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        m_clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            dropClient(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlServer::dropClient(QLocalSocket *socket)
+{
+    // Its runs go on, unwatched
+    m_clients.remove(socket);
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if (it->socket == socket)
+            it = m_jobs.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = m_workflows.begin(); it != m_workflows.end();) {
+        if (it.value() == socket)
+            it = m_workflows.erase(it);
+        else
+            ++it;
+    }
+}
+
+void ControlServer::readRequests(QLocalSocket *socket)
+{
+    auto client = m_clients.find(socket);
+    if (client == m_clients.end()) return;
+    client->buffer.append(socket->readAll());
+
+    qsizetype newline;
+    while ((newline = client->buffer.indexOf('\n')) >= 0) {
+        const QByteArray line = client->buffer.left(newline).trimmed();
+        client->buffer.remove(0, newline + 1);
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+        if (!document.isObject()) {
+            send(socket, { { "ok", false }, { "error", "invalid JSON: " + parseError.errorString() } });
+            continue;
+        }
+
+        const QJsonObject request = document.object();
+        QJsonObject reply = handleRequest(socket, request);
+        if (request.contains("id")) reply["id"] = request.value("id");
+        send(socket, reply);
+
+        // The reply goes out before a run starts so events follow it
+        if (reply.value("ok").toBool() && request.value("cmd").toString() == "run")
+            run(request.value("watch").toBool() ? socket : nullptr, request.value("action").toString(),
+                request.value("inputs").toObject().toVariantMap());
+
+        client = m_clients.find(socket);
+        if (client == m_clients.end()) return;
+    }
+
+    if (client->buffer.size() > MaxRequestBytes) {
+        qWarning() << "Control client sent an oversized request, disconnecting";
+        socket->disconnectFromServer();
+    }
+}
+
+QJsonObject ControlServer::handleRequest(QLocalSocket *socket, const QJsonObject &request)
+{
+    const QString command = request.value("cmd").toString();
+
+    if (command == "list") {
+        QJsonArray actions;
+        for (const QString &category : m_actions->categoriesKeys()) {
+            const ActionListModel *model = m_actions->categoryModel()->actions(category);
+            for (int row = 0; model && row < model->rowCount(); ++row) {
+                const ActionDefinition *action = m_actions->findAction(
+                    model->data(model->index(row), ActionListModel::ActionIdRole).toString());
+                if (!action) continue;
+                actions.append(QJsonObject { { "id", action->id }, { "name", action->name },
+                                             { "category", action->category }, { "type", action->type } });
+            }
+        }
+        return { { "ok", true }, { "actions", actions } };
+    }
+
+    if (command == "run") {
+        const QString actionId = request.value("action").toString();
+        if (!m_actions->findAction(actionId))
+            return { { "ok", false }, { "error", "unknown action: " + actionId } };
+        return { { "ok", true } };
+    }
+
+    if (command == "status") {
+        return { { "ok", true }, { "running", m_scheduler->runningCount() },
+                 { "queued", m_scheduler->queuedCount() } };
+    }
+
+    if (command == "cancel") {
+        const bool canceled = m_scheduler->cancel(request.value("job").toInt());
+        return { { "ok", canceled } };
+    }
+
+    if (command == "forward") {
+        QStringList arguments;
+        for (const QJsonValue &value : request.value("args").toArray()) arguments.append(value.toString());
+        handleArguments(arguments);
+        emit activateRequested();
+        return { { "ok", true } };
+    }
+
+    return { { "ok", false }, { "error", "unknown command: " + command } };
+}
+
+void ControlServer::run(QLocalSocket *watcher, const QString &actionId, const QVariantMap &inputs)
+{
+    const ActionDefinition *action = m_actions->findAction(actionId);
+    if (!action) return;
+
+    StartingRun starting { watcher, actionId };
+    if (watcher) m_starting = &starting;
+
+    if (!inputs.isEmpty() || !action->inputDefs.isEmpty())
+        m_actions->executeActionWithInputs(actionId, inputs);
+    else
+        m_actions->executeAction(actionId);
+
+    m_starting = nullptr;
+    if (watcher && !starting.tracked) sendDone(watcher, actionId, starting.executed && starting.success);
+}
+
+void ControlServer::handleArguments(const QStringList &arguments)
+{
+    QString actionId;
+    QVariantMap inputs;
+    for (int i = 1; i + 1 < arguments.size(); ++i) {
+        if (arguments.at(i) == "--action") {
+            actionId = arguments.at(++i);
+        } else if (arguments.at(i) == "--input") {
+            const QString input = arguments.at(++i);
+            const qsizetype equals = input.indexOf('=');
+            if (equals > 0) inputs.insert(input.left(equals), input.mid(equals + 1));
+        }
+    }
+
+    if (actionId.isEmpty()) return;
+    if (!m_actions->findAction(actionId)) {
+        qWarning() << "Launch requested unknown action:" << actionId;
+        return;
+    }
+    run(nullptr, actionId, inputs);
+}
+
+bool ControlServer::forwardToRunningInstance(const QStringList &arguments)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName());
+    if (!socket.waitForConnected(200)) return false;
+
+    const QJsonObject message { { "cmd", "forward" }, { "args", QJsonArray::fromStringList(arguments) } };
+    socket.write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+    if (!socket.waitForBytesWritten(1000)) return false;
+
+    // The reply means the instance has taken over
+    if (!socket.waitForReadyRead(2000)) return false;
+    return QJsonDocument::fromJson(socket.readLine()).object().value("ok").toBool();
+}
+
+void ControlServer::send(QLocalSocket *socket, const QJsonObject &message)
+{
+    socket->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void ControlServer::sendDone(QLocalSocket *socket, const QString &actionId, bool success)
+{
+    send(socket, { { "event", "done" }, { "action", actionId }, { "success", success } });
+}
+
+void ControlServer::sendJobEvent(int jobId, const QString &state, const QJsonObject &extra)
+{
+    auto job = m_jobs.constFind(jobId);
+    if (job == m_jobs.constEnd()) return;
+
+    QJsonObject event = extra;
+    event["event"] = "job";
+    event["job"] = jobId;
+    event["action"] = job->actionId;
+    event["tag"] = job->tag;
+    event["state"] = state;
+    send(job->socket, event);
+}
+
+void ControlServer::endJob(int jobId, bool success)
+{
+    const WatchedJob job = m_jobs.take(jobId);
+    if (job.socket && job.endsRun) sendDone(job.socket, job.actionId, success);
+}
+
+void ControlServer::streamOutput(int jobId)
+{
+    auto job = m_jobs.find(jobId);
+    if (job == m_jobs.end()) return;
+
+    const auto output = m_scheduler->output(jobId);
+    if (!output) return;
+
+    auto stream = [&](const OutputBuffer &buffer, qint64 *sent, const char *name) {
+        const qint64 first = qMax(*sent, buffer.firstAvailableLine());
+        const qint64 count = buffer.lineCount() - first;
+        *sent = buffer.lineCount();
+        if (count <= 0) return;
+
+        const QJsonObject event { { "event", "output" }, { "job", jobId }, { "stream", name },
+                                  { "lines", QJsonArray::fromStringList(buffer.lines(first, int(count))) } };
+        send(job->socket, event);
+    };
+    stream(output->standardOutput, &job->standardOutput, "stdout");
+    stream(output->standardError, &job->standardError, "stderr");
+}
@@ -0,0 +1,89 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+
+class QLocalServer;
+class QLocalSocket;
+class ActionManager;
+class JobScheduler;
+
+// Local control socket of a running instance. Clients send one JSON object
+// per line and get one JSON object per line back:
+//   {"id": 1, "cmd": "list"}
+//   {"id": 2, "cmd": "run", "action": "build", "inputs": {...}, "watch": true}
+//   {"id": 3, "cmd": "status"} / {"id": 4, "cmd": "cancel", "job": 12}
+//   {"id": 5, "cmd": "forward", "args": [...]}   (second launch)
+// Replies carry the request id and "ok". A watched run also streams
+// {"event": "job"|"output"|"done", ...} for the jobs that run started,
+// never for runs of the same action from the GUI or other clients.
+class ControlServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    ControlServer(ActionManager *actions, JobScheduler *scheduler, QObject *parent = nullptr);
+    ~ControlServer() override;
+
+    static QString serverName();
+    bool listen();
+
+    // Handles --action <id> [--input key=value ...] from a launch
+    void handleArguments(const QStringList &arguments);
+
+    // Single-instance guard: hands the arguments to a running instance.
+    // Needs the application object; blocks for at most a few seconds.
+    static bool forwardToRunningInstance(const QStringList &arguments);
+
+signals:
+    void activateRequested();
+
+private:
+    struct Client {
+        QByteArray buffer;
+    };
+
+    struct WatchedJob {
+        QLocalSocket *socket = nullptr;
+        QString actionId;
+        QString tag;
+        bool endsRun = false;      // The run's own job, not a workflow step
+        qint64 standardOutput = 0; // Lines already streamed
+        qint64 standardError = 0;
+    };
+
+    // A watched run while ActionManager starts it: the job or workflow run
+    // it creates, or the result it reports, belongs to this client
+    struct StartingRun {
+        QLocalSocket *socket = nullptr;
+        QString actionId;
+        bool tracked = false; // A job or workflow run will report the end
+        bool executed = false;
+        bool success = false;
+    };
+
+    ActionManager *m_actions;
+    JobScheduler *m_scheduler;
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, Client> m_clients;
+    QHash<int, WatchedJob> m_jobs;           // Job id -> watching client
+    QHash<int, QLocalSocket *> m_workflows; // Workflow run id -> watching client
+    StartingRun *m_starting = nullptr;
+
+    void acceptClients();
+    void dropClient(QLocalSocket *socket);
+    void readRequests(QLocalSocket *socket);
+    QJsonObject handleRequest(QLocalSocket *socket, const QJsonObject &request);
+    void run(QLocalSocket *watcher, const QString &actionId, const QVariantMap &inputs);
+    void send(QLocalSocket *socket, const QJsonObject &message);
+    void sendDone(QLocalSocket *socket, const QString &actionId, bool success);
+    void sendJobEvent(int jobId, const QString &state, const QJsonObject &extra = QJsonObject());
+    void endJob(int jobId, bool success);
+    void streamOutput(int jobId);
+};
+
+#endif // CONTROLSERVER_H
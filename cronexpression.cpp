@@ -0,0 +1,185 @@
+#include "cronexpression.h"
+#include <QStringList>
+#include <QtAlgorithms>
+
+static const char *const MonthNames[] = { "JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                          "JUL", "AUG", "SEP", "OCT", "NOV", "DEC" };
+static const char *const DayNames[] = { "SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT" };
+
+// Names map to their index plus nameOffset: JAN is 1, SUN is 0
+static bool parseValue(const QString &text, int min, int max, const char *const *names, int nameCount,
+                       int nameOffset, int *value)
+{
+    bool ok = false;
+    const int number = text.toInt(&ok);
+    if (ok) {
+        *value = number;
+        return number >= min && number <= max;
+    }
+    if (!names) return false;
+
+    for (int i = 0; i < nameCount; ++i) {
+        if (text.compare(QLatin1String(names[i]), Qt::CaseInsensitive) == 0) {
+            *value = i + nameOffset;
+            return true;
+        }
+    }
+    return false;
+}
+
+// One cron field: "*", "5", "1-5", "MON-FRI", "*/15", "0-30/10", or a list of those
+static bool parseField(const QString &field, int min, int max, const char *const *names, int nameCount,
+                       int nameOffset, quint64 *bits, bool *any)
+{
+    *bits = 0;
+    *any = field.startsWith('*');
+
+    for (const QString &item : field.split(',')) {
+        QString range = item;
+        int step = 1;
+        const qsizetype slash = item.indexOf('/');
+        if (slash >= 0) {
+            bool ok = false;
+            step = item.mid(slash + 1).toInt(&ok);
+            if (!ok || step < 1) return false;
+            range = item.left(slash);
+        }
+
+        int first = min;
+        int last = max;
+        if (range != "*") {
+            const qsizetype dash = range.indexOf('-');
+            if (dash > 0) {
+                if (!parseValue(range.left(dash), min, max, names, nameCount, nameOffset, &first)
+                    || !parseValue(range.mid(dash + 1), min, max, names, nameCount, nameOffset, &last)
+                    || last < first) {
+                    return false;
+                }
+            } else {
+                if (!parseValue(range, min, max, names, nameCount, nameOffset, &first)) return false;
+                // "5/15" means from 5 to the end in steps of 15
+                last = slash >= 0 ? max : first;
+            }
+        }
+
+        for (int value = first; value <= last; value += step) *bits |= quint64(1) << value;
+    }
+    return *bits != 0;
+}
+
+CronExpression CronExpression::parse(const QString &text, QString *error)
+{
+    CronExpression cron;
+    cron.m_text = text.simplified();
+
+    auto fail = [&](const QString &message) {
+        if (error) *error = message;
+        cron.m_valid = false;
+        return cron;
+    };
+
+    QString fields = cron.m_text;
+    if (fields.startsWith('@')) {
+        const QStringList parts = fields.split(' ');
+        const QString macro = parts.constFirst().toLower();
+
+        if (macro == "@every") {
+            static const QString Units = "smhd";
+            static const qint64 UnitMs[] = { 1000, 60 * 1000, 3600 * 1000, 24 * 3600 * 1000 };
+            const QString interval = parts.value(1);
+            const qsizetype unit = interval.isEmpty() ? -1 : Units.indexOf(interval.back());
+            bool ok = false;
+            const double count = interval.left(interval.size() - 1).toDouble(&ok);
+            if (parts.size() != 2 || unit < 0 || !ok || count * UnitMs[unit] < 1000)
+                return fail(QString("Invalid interval \"%1\", expected e.g. @every 30s").arg(cron.m_text));
+            cron.m_intervalMs = qint64(count * UnitMs[unit]);
+            cron.m_valid = true;
+            return cron;
+        }
+
+        if (parts.size() != 1) return fail(QString("Unexpected text after %1").arg(macro));
+        if (macro == "@hourly") fields = "0 * * * *";
+        else if (macro == "@daily" || macro == "@midnight") fields = "0 0 * * *";
+        else if (macro == "@weekly") fields = "0 0 * * 0";
+        else if (macro == "@monthly") fields = "0 0 1 * *";
+        else if (macro == "@yearly" || macro == "@annually") fields = "0 0 1 1 *";
+        else return fail(QString("Unknown schedule macro %1").arg(macro));
+    }
+
+    const QStringList parts = fields.split(' ');
+    if (parts.size() != 5)
+        return fail(QString("Schedule \"%1\" needs 5 fields: minute hour day month weekday").arg(cron.m_text));
+
+    quint64 bits = 0;
+    bool any = false;
+    if (!parseField(parts.at(0), 0, 59, nullptr, 0, 0, &bits, &any))
+        return fail(QString("Invalid minute field \"%1\"").arg(parts.at(0)));
+    cron.m_minutes = bits;
+    if (!parseField(parts.at(1), 0, 23, nullptr, 0, 0, &bits, &any))
+        return fail(QString("Invalid hour field \"%1\"").arg(parts.at(1)));
+    cron.m_hours = quint32(bits);
+    if (!parseField(parts.at(2), 1, 31, nullptr, 0, 0, &bits, &cron.m_anyDayOfMonth))
+        return fail(QString("Invalid day of month field \"%1\"").arg(parts.at(2)));
+    cron.m_daysOfMonth = quint32(bits);
+    if (!parseField(parts.at(3), 1, 12, MonthNames, 12, 1, &bits, &any))
+        return fail(QString("Invalid month field \"%1\"").arg(parts.at(3)));
+    cron.m_months = quint16(bits);
+    // 7 is Sunday as well
+    if (!parseField(parts.at(4), 0, 7, DayNames, 7, 0, &bits, &cron.m_anyDayOfWeek))
+        return fail(QString("Invalid weekday field \"%1\"").arg(parts.at(4)));
+    cron.m_daysOfWeek = quint8((bits | (bits >> 7)) & 0x7f);
+
+    cron.m_valid = true;
+    return cron;
+}
+
+bool CronExpression::matchesDay(const QDate &date) const
+{
+    const bool dayOfMonth = m_daysOfMonth & (quint32(1) << date.day());
+    const bool dayOfWeek = m_daysOfWeek & (1 << (date.dayOfWeek() % 7));
+
+    // Classic cron: when both are restricted, either one matching is enough
+    if (m_anyDayOfMonth && m_anyDayOfWeek) return true;
+    if (m_anyDayOfMonth) return dayOfWeek;
+    if (m_anyDayOfWeek) return dayOfMonth;
+    return dayOfMonth || dayOfWeek;
+}
+
+QDateTime CronExpression::next(const QDateTime &after) const
+{
+    if (!m_valid) return QDateTime();
+    if (m_intervalMs > 0) return after.addMSecs(m_intervalMs);
+
+    const QTime start = after.time();
+    QDateTime candidate = QDateTime(after.date(), QTime(start.hour(), start.minute())).addSecs(60);
+    const QDate limit = after.date().addYears(5); // "0 0 30 2 *" never matches
+
+    while (candidate.date() <= limit) {
+        const QDate date = candidate.date();
+        const int hour = candidate.time().hour();
+        const int minute = candidate.time().minute();
+
+        if (!(m_months & (1 << date.month()))) {
+            candidate = QDateTime(QDate(date.year(), date.month(), 1).addMonths(1), QTime(0, 0));
+            continue;
+        }
+        if (!matchesDay(date)) {
+            candidate = QDateTime(date.addDays(1), QTime(0, 0));
+            continue;
+        }
+        if (!(m_hours & (quint32(1) << hour))) {
+            const quint32 later = m_hours & (~quint32(0) << hour);
+            candidate = later ? QDateTime(date, QTime(int(qCountTrailingZeroBits(later)), 0))
+                              : QDateTime(date.addDays(1), QTime(0, 0));
+            continue;
+        }
+
+        const quint64 minutes = m_minutes & (~quint64(0) << minute);
+        if (!minutes) {
+            candidate = hour < 23 ? QDateTime(date, QTime(hour + 1, 0)) : QDateTime(date.addDays(1), QTime(0, 0));
+            continue;
+        }
+        return QDateTime(date, QTime(hour, int(qCountTrailingZeroBits(minutes))));
+    }
+    return QDateTime();
+}
@@ -0,0 +1,39 @@
+#ifndef CRONEXPRESSION_H
+#define CRONEXPRESSION_H
+
+#include <QDateTime>
+#include <QString>
+
+// An action's "schedule": five cron fields ("*/15 9-17 * * MON-FRI"),
+// a macro (@hourly, @daily, @weekly, @monthly, @yearly) or a fixed
+// interval ("@every 30s", also m/h/d). Fields are kept as bitmasks, so
+// finding the next run skips whole months, days and hours at a time.
+class CronExpression
+{
+public:
+    CronExpression() = default;
+
+    static CronExpression parse(const QString &text, QString *error = nullptr);
+
+    bool isValid() const { return m_valid; }
+    const QString &text() const { return m_text; }
+
+    // First run strictly after `after`, in local time; invalid when none
+    QDateTime next(const QDateTime &after) const;
+
+private:
+    QString m_text;
+    bool m_valid = false;
+    qint64 m_intervalMs = 0; // "@every"; the fields below are unused then
+    quint64 m_minutes = 0;
+    quint32 m_hours = 0;
+    quint32 m_daysOfMonth = 0; // Bit 1..31
+    quint16 m_months = 0;      // Bit 1..12
+    quint8 m_daysOfWeek = 0;   // Bit 0..6, Sunday first
+    bool m_anyDayOfMonth = false;
+    bool m_anyDayOfWeek = false;
+
+    bool matchesDay(const QDate &date) const;
+};
+
+#endif // CRONEXPRESSION_H
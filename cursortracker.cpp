@@ -0,0 +1,114 @@
+#include "cursortracker.h"
+#include <QCoreApplication>
+#include <QCursor>
+
+// Poll interval while the cursor moves (~60 FPS) and the idle back-off steps
+static const int ActiveIntervalMs = 16;
+static const int IdleIntervalMs = 50;
+static const int SleepIntervalMs = 100;
+static const int IdleTicksBeforeBackoff = 30;   // ~0.5 s without movement
+static const int IdleTicksBeforeSleep = 60;
+static const int SampleWindowMs = 1000;
+
+static CursorTracker *s_tracker = nullptr;
+
+CursorTracker *CursorTracker::instance()
+{
+    Q_ASSERT(QCoreApplication::instance());
+    if (!s_tracker) s_tracker = new CursorTracker(QCoreApplication::instance());
+    return s_tracker;
+}
+
+CursorTracker::CursorTracker(QObject *parent)
+    : QObject(parent)
+    , m_position(QCursor::pos())
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(ActiveIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &CursorTracker::onTimeout);
+    m_sampleClock.start();
+}
+
+CursorTracker::~CursorTracker()
+{
+    if (s_tracker == this) s_tracker = nullptr;
+}
+
+void CursorTracker::subscribe(const QObject *subscriber)
+{
+    m_subscribers.insert(subscriber);
+    if (!m_timer.isActive()) {
+        // The cursor may have moved while nobody was listening
+        poll();
+        m_idleTicks = 0;
+        m_sampledWakeups = m_wakeups;
+        m_sampleClock.restart();
+        m_timer.start(ActiveIntervalMs);
+    }
+}
+
+void CursorTracker::unsubscribe(const QObject *subscriber)
+{
+    m_subscribers.remove(subscriber);
+    if (m_subscribers.isEmpty()) m_timer.stop();
+}
+
+int CursorTracker::subscriberCount() const
+{
+    return m_subscribers.size();
+}
+
+QPoint CursorTracker::position() const
+{
+    return m_position;
+}
+
+void CursorTracker::poll()
+{
+    const QPoint pos = QCursor::pos();
+    if (pos == m_position) {
+        ++m_idleTicks;
+        return;
+    }
+
+    m_idleTicks = 0;
+    m_position = pos;
+    emit positionChanged(m_position);
+}
+
+quint64 CursorTracker::totalWakeups() const
+{
+    return m_wakeups;
+}
+
+qreal CursorTracker::wakeupsPerSecond() const
+{
+    // A stopped timer wakes nobody, whatever the last window measured
+    return m_timer.isActive() ? m_wakeupRate : 0.0;
+}
+
+void CursorTracker::onTimeout()
+{
+    ++m_wakeups;
+
+    const qint64 elapsed = m_sampleClock.elapsed();
+    if (elapsed >= SampleWindowMs) {
+        m_wakeupRate = (m_wakeups - m_sampledWakeups) * 1000.0 / elapsed;
+        m_sampledWakeups = m_wakeups;
+        m_sampleClock.restart();
+    }
+
+    poll();
+    updateInterval();
+}
+
+void CursorTracker::updateInterval()
+{
+    int interval = ActiveIntervalMs;
+    if (m_idleTicks >= IdleTicksBeforeSleep)
+        interval = SleepIntervalMs;
+    else if (m_idleTicks >= IdleTicksBeforeBackoff)
+        interval = IdleIntervalMs;
+
+    if (m_timer.interval() != interval) m_timer.setInterval(interval);
+}
@@ -0,0 +1,53 @@
+#ifndef CURSORTRACKER_H
+#define CURSORTRACKER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPoint>
+#include <QSet>
+#include <QTimer>
+
+// Process-wide cursor poller shared by all MousePositionProvider instances.
+// It only runs while at least one subscriber is active, polls every 16 ms
+// while the cursor moves and backs off when it sits still. Owned by the
+// application object and destroyed with it.
+class CursorTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static CursorTracker *instance();
+    ~CursorTracker() override;
+
+    void subscribe(const QObject *subscriber);
+    void unsubscribe(const QObject *subscriber);
+    int subscriberCount() const;
+
+    QPoint position() const;
+    void poll();
+
+    // Instrumentation
+    quint64 totalWakeups() const;
+    qreal wakeupsPerSecond() const; // Over the last full sampling window
+
+signals:
+    void positionChanged(const QPoint &position);
+
+private:
+    explicit CursorTracker(QObject *parent = nullptr);
+
+    QSet<const QObject *> m_subscribers;
+    QTimer m_timer;
+    QPoint m_position;
+    int m_idleTicks = 0;
+
+    quint64 m_wakeups = 0;
+    quint64 m_sampledWakeups = 0; // m_wakeups when the window started
+    QElapsedTimer m_sampleClock;
+    qreal m_wakeupRate = 0;
+
+    void onTimeout();
+    void updateInterval();
+};
+
+#endif // CURSORTRACKER_H
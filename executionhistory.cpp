@@ -0,0 +1,566 @@
+#include "executionhistory.h"
+#include "actionmanager.h"
+#include "trace.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace {
+
+// "SRHL", a version and an epoch that changes whenever the file is
+// rewritten, then records, each led by its type byte:
+//   IdRecord:      u16 length, UTF-8 id; the n-th one is id index n
+//   RunRecord:     u32 id index, i64 time (ms since epoch), u8 success
+//   SummaryRecord: u32 id index, f64 score, i64 score time, u32 runs,
+//                  u32 failures, i64 last run
+// All little-endian. A torn record at the end (crash mid-append) is cut
+// off on load. Version 1 had no epoch; such a log is rewritten on load.
+const char LogMagic[4] = { 'S', 'R', 'H', 'L' };
+const quint32 LogVersion = 2;
+const qsizetype HeaderSize = 16;
+const qsizetype V1HeaderSize = 8;
+
+enum RecordType : quint8 {
+    IdRecord = 1,
+    RunRecord = 2,
+    SummaryRecord = 3
+};
+
+const qsizetype IdRecordHeaderSize = 1 + 2;
+const qsizetype RunRecordSize = 1 + 4 + 8 + 1;
+const qsizetype SummaryRecordSize = 1 + 4 + 8 + 8 + 4 + 4 + 8;
+
+const double HalfLifeMs = 7.0 * 24 * 3600 * 1000;
+const double FailureWeight = 0.25; // A failed run still says the action is wanted
+const quint64 CompactMinRuns = 4096;
+// Appends are tiny; a holder this slow is stuck
+const int LockTimeoutMs = 5000;
+// Older compaction files are leftovers of a process that died mid-write
+const qint64 StaleCompactionSecs = 3600;
+
+template <typename T>
+void put(QByteArray *out, T value)
+{
+    const T le = qToLittleEndian(value);
+    out->append(reinterpret_cast<const char *>(&le), sizeof(T));
+}
+
+void putDouble(QByteArray *out, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put<quint64>(out, bits);
+}
+
+template <typename T>
+T get(const char *data)
+{
+    return qFromLittleEndian<T>(data);
+}
+
+double getDouble(const char *data)
+{
+    const quint64 bits = get<quint64>(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void putId(QByteArray *out, const QString &actionId)
+{
+    const QByteArray utf8 = actionId.toUtf8().left(0xffff);
+    out->append(char(IdRecord));
+    put<quint16>(out, quint16(utf8.size()));
+    out->append(utf8);
+}
+
+QByteArray header(quint64 epoch)
+{
+    QByteArray bytes(LogMagic, sizeof(LogMagic));
+    put<quint32>(&bytes, LogVersion);
+    put<quint64>(&bytes, epoch);
+    return bytes;
+}
+
+// Size of the header at data, 0 if it isn't one; epoch 0 for version 1
+qsizetype parseHeader(const char *data, qsizetype size, quint64 *epoch)
+{
+    if (size < V1HeaderSize || std::memcmp(data, LogMagic, sizeof(LogMagic)) != 0) return 0;
+    const quint32 version = get<quint32>(data + 4);
+    if (version == 1) {
+        *epoch = 0;
+        return V1HeaderSize;
+    }
+    if (version != LogVersion || size < HeaderSize) return 0;
+    *epoch = get<quint64>(data + 8);
+    return HeaderSize;
+}
+
+quint64 newEpoch()
+{
+    return QRandomGenerator::global()->generate64() | 1;
+}
+
+double rankOf(double score, qint64 scoreTime)
+{
+    return std::log2(score) + double(scoreTime) / HalfLifeMs;
+}
+
+} // namespace
+
+ExecutionHistory::ExecutionHistory(const ActionManager *manager, const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+    , m_path(path)
+    , m_lock(path + ".lock")
+    , m_recent(new ActionListModel(manager, this))
+{
+    // One writer keeps compactions ordered
+    m_compactPool.setMaxThreadCount(1);
+    load();
+}
+
+ExecutionHistory::~ExecutionHistory()
+{
+    m_compactPool.waitForDone();
+}
+
+void ExecutionHistory::load()
+{
+    TRACE_SCOPE("history load", "history");
+    const QFileInfo info(m_path);
+    QDir().mkpath(info.absolutePath());
+
+    // Compactions cut short; a recent one may belong to a live process
+    const QDateTime now = QDateTime::currentDateTime();
+    const QFileInfoList leftovers = QDir(info.absolutePath()).entryInfoList({ info.fileName() + ".compact.*" },
+                                                                           QDir::Files);
+    for (const QFileInfo &leftover : leftovers) {
+        if (leftover.lastModified().secsTo(now) > StaleCompactionSecs) QFile::remove(leftover.absoluteFilePath());
+    }
+
+    const bool locked = lockLog();
+    syncLog();
+    if (locked) m_lock.unlock();
+    sortRanking();
+
+    qDebug() << "History loaded:" << m_runCount << "runs of" << m_ids.size() << "actions";
+    if (m_epoch == 0 && m_logSize > 0) {
+        compact(); // A version 1 log, rewritten with an epoch
+    } else {
+        compactIfNeeded();
+    }
+}
+
+bool ExecutionHistory::lockLog()
+{
+    if (m_lock.tryLock(LockTimeoutMs)) return true;
+    qWarning() << "Could not lock history log" << m_path << m_lock.error();
+    return false;
+}
+
+void ExecutionHistory::resetState()
+{
+    m_ids.clear();
+    m_idIndex.clear();
+    m_stats.clear();
+    m_ranking.clear();
+    m_runCount = 0;
+    m_logRuns = 0;
+    m_epoch = 0;
+    m_logSize = 0;
+}
+
+bool ExecutionHistory::syncLog()
+{
+    // Other processes append to the log and may have replaced it since
+    // this one last looked; call with the lock held
+    QFile file(m_path);
+    const qint64 size = file.open(QIODevice::ReadOnly) ? file.size() : 0;
+    const QByteArray head = size > 0 ? file.read(HeaderSize) : QByteArray();
+    quint64 epoch = 0;
+    const qsizetype headerSize = parseHeader(head.constData(), head.size(), &epoch);
+
+    if (headerSize == 0) {
+        if (size > 0) qWarning() << "History log" << m_path << "is not readable, starting over";
+        file.close();
+        const bool changed = !m_ids.isEmpty();
+        resetState();
+        createLog();
+        return changed;
+    }
+
+    bool changed = false;
+    if (m_logSize == 0 || epoch != m_epoch || size < m_logSize) {
+        // First read, or rewritten elsewhere: fold it from the start
+        changed = !m_ids.isEmpty();
+        resetState();
+        m_epoch = epoch;
+        m_logSize = headerSize;
+    }
+    if (size <= m_logSize) return changed;
+
+    const qint64 from = m_logSize;
+    qsizetype valid = 0;
+    bool intact = true;
+    if (uchar *data = file.map(from, size - from)) {
+        intact = parseRecords(reinterpret_cast<const char *>(data), size - from, &valid);
+        file.unmap(data);
+    } else {
+        file.seek(from);
+        const QByteArray bytes = file.readAll();
+        intact = parseRecords(bytes.constData(), bytes.size(), &valid);
+    }
+    file.close();
+    m_logSize = from + valid;
+
+    if (!intact) {
+        qWarning() << "History log" << m_path << "truncated after" << m_logSize << "of" << size << "bytes";
+        QFile::resize(m_path, m_logSize);
+    }
+    return true;
+}
+
+bool ExecutionHistory::createLog()
+{
+    const quint64 epoch = newEpoch();
+    const QByteArray bytes = header(epoch);
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(bytes) != bytes.size()
+        || !file.flush()) {
+        qWarning() << "Could not create history log" << m_path << file.errorString();
+        return false;
+    }
+    m_epoch = epoch;
+    m_logSize = bytes.size();
+    return true;
+}
+
+bool ExecutionHistory::parseRecords(const char *data, qsizetype size, qsizetype *valid)
+{
+    qsizetype pos = 0;
+    *valid = 0;
+    while (pos < size) {
+        const char *record = data + pos;
+        const qsizetype left = size - pos;
+        const quint8 type = quint8(record[0]);
+
+        if (type == IdRecord) {
+            if (left < IdRecordHeaderSize) return false;
+            const qsizetype length = get<quint16>(record + 1);
+            if (left < IdRecordHeaderSize + length) return false;
+            const QString actionId = QString::fromUtf8(record + IdRecordHeaderSize, length);
+            m_idIndex.insert(actionId, int(m_ids.size()));
+            m_ids.append(actionId);
+            m_stats.append(Stats());
+            pos += IdRecordHeaderSize + length;
+
+        } else if (type == RunRecord) {
+            if (left < RunRecordSize) return false;
+            const quint32 index = get<quint32>(record + 1);
+            if (index >= quint32(m_ids.size())) return false;
+            apply(int(index), get<qint64>(record + 5), record[13] != 0);
+            ++m_logRuns;
+            pos += RunRecordSize;
+
+        } else if (type == SummaryRecord) {
+            if (left < SummaryRecordSize) return false;
+            const quint32 index = get<quint32>(record + 1);
+            if (index >= quint32(m_ids.size())) return false;
+            Stats &stats = m_stats[index];
+            m_runCount -= stats.runs;
+            stats.score = getDouble(record + 5);
+            stats.scoreTime = get<qint64>(record + 13);
+            stats.runs = get<quint32>(record + 21);
+            stats.failures = get<quint32>(record + 25);
+            stats.lastRun = get<qint64>(record + 29);
+            stats.rank = rankOf(stats.score, stats.scoreTime);
+            m_runCount += stats.runs;
+            pos += SummaryRecordSize;
+
+        } else {
+            return false;
+        }
+        *valid = pos;
+    }
+    return true;
+}
+
+bool ExecutionHistory::append(const QByteArray &records)
+{
+    // Opened per write: a compaction elsewhere may have replaced the file.
+    // Flushed so a crash loses at most the record being written.
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) return false;
+    if (file.write(records) != records.size() || !file.flush()) return false;
+    m_logSize += records.size();
+    return true;
+}
+
+int ExecutionHistory::intern(const QString &actionId, QByteArray *records)
+{
+    auto it = m_idIndex.constFind(actionId);
+    if (it != m_idIndex.constEnd()) return it.value();
+
+    const int index = int(m_ids.size());
+    m_idIndex.insert(actionId, index);
+    m_ids.append(actionId);
+    m_stats.append(Stats());
+    putId(records, actionId);
+    return index;
+}
+
+void ExecutionHistory::apply(int index, qint64 time, bool success)
+{
+    Stats &stats = m_stats[index];
+    const double weight = success ? 1.0 : FailureWeight;
+
+    if (time >= stats.scoreTime) {
+        stats.score = stats.score * std::exp2(double(stats.scoreTime - time) / HalfLifeMs) + weight;
+        stats.scoreTime = time;
+    } else {
+        // The clock went back; age this run instead of the score
+        stats.score += weight * std::exp2(double(time - stats.scoreTime) / HalfLifeMs);
+    }
+
+    ++stats.runs;
+    if (!success) ++stats.failures;
+    stats.lastRun = qMax(stats.lastRun, time);
+    stats.rank = rankOf(stats.score, stats.scoreTime);
+    ++m_runCount;
+}
+
+void ExecutionHistory::sortRanking()
+{
+    m_ranking.resize(m_ids.size());
+    for (int index = 0; index < m_ranking.size(); ++index) m_ranking[index] = index;
+    std::stable_sort(m_ranking.begin(), m_ranking.end(),
+                     [this](int a, int b) { return m_stats.at(a).rank > m_stats.at(b).rank; });
+}
+
+void ExecutionHistory::rerank(int index)
+{
+    m_ranking.removeOne(index);
+    const double rank = m_stats.at(index).rank;
+    auto it = std::upper_bound(m_ranking.begin(), m_ranking.end(), rank,
+                               [this](double value, int other) { return value > m_stats.at(other).rank; });
+    m_ranking.insert(it, index);
+}
+
+void ExecutionHistory::record(const QString &actionId, bool success)
+{
+    // "Action not found" reports aren't history
+    if (!m_manager->findAction(actionId)) return;
+
+    // Without the lock this process can't know which id indexes are taken
+    if (!lockLog()) {
+        qWarning() << "Run of" << actionId << "not recorded";
+        return;
+    }
+    const bool caughtUp = syncLog();
+
+    QByteArray records;
+    const int index = intern(actionId, &records);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    records.append(char(RunRecord));
+    put<quint32>(&records, quint32(index));
+    put<qint64>(&records, now);
+    records.append(char(success ? 1 : 0));
+
+    if (!append(records)) qWarning() << "Could not append to history log" << m_path;
+    m_lock.unlock();
+    ++m_logRuns;
+
+    apply(index, now, success);
+    if (caughtUp)
+        sortRanking();
+    else
+        rerank(index);
+    refresh();
+    emit historyChanged();
+    compactIfNeeded();
+}
+
+QStringList ExecutionHistory::topActions(int limit) const
+{
+    QStringList ids;
+    for (int index : m_ranking) {
+        if (ids.size() >= limit) break;
+        const QString &actionId = m_ids.at(index);
+        if (m_manager->findAction(actionId)) ids.append(actionId);
+    }
+    return ids;
+}
+
+QVariantMap ExecutionHistory::stats(const QString &actionId) const
+{
+    auto it = m_idIndex.constFind(actionId);
+    if (it == m_idIndex.constEnd()) return QVariantMap();
+
+    const Stats &stats = m_stats.at(it.value());
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    return {
+        { "runs", stats.runs },
+        { "failures", stats.failures },
+        { "lastRun", QDateTime::fromMSecsSinceEpoch(stats.lastRun) },
+        { "score", stats.score * std::exp2(double(stats.scoreTime - now) / HalfLifeMs) }
+    };
+}
+
+void ExecutionHistory::refresh()
+{
+    m_recent->setActionIds(topActions(m_recentLimit));
+}
+
+void ExecutionHistory::setRecentLimit(int limit)
+{
+    limit = qMax(0, limit);
+    if (m_recentLimit == limit) return;
+    m_recentLimit = limit;
+    refresh();
+    emit recentLimitChanged();
+}
+
+void ExecutionHistory::clear()
+{
+    ++m_generation;
+    const bool locked = lockLog();
+    resetState();
+    createLog();
+    if (locked) m_lock.unlock();
+
+    refresh();
+    emit historyChanged();
+}
+
+void ExecutionHistory::compactIfNeeded()
+{
+    if (m_compacting || m_logRuns < CompactMinRuns || m_logRuns < quint64(m_ids.size()) * 4) return;
+    compact();
+}
+
+void ExecutionHistory::compact()
+{
+    // The snapshot must cover everything up to the point it is taken
+    if (!lockLog()) return;
+    const bool caughtUp = syncLog();
+    m_lock.unlock();
+    if (caughtUp) {
+        sortRanking();
+        refresh();
+        emit historyChanged();
+    }
+
+    // One summary per action is small; only the disk write leaves the UI thread
+    const quint64 epoch = newEpoch();
+    QByteArray image = header(epoch);
+    image.reserve(HeaderSize + m_ids.size() * (IdRecordHeaderSize + 32 + SummaryRecordSize));
+
+    for (int index = 0; index < m_ids.size(); ++index) {
+        const Stats &stats = m_stats.at(index);
+        putId(&image, m_ids.at(index));
+        image.append(char(SummaryRecord));
+        put<quint32>(&image, quint32(index));
+        putDouble(&image, stats.score);
+        put<qint64>(&image, stats.scoreTime);
+        put<quint32>(&image, stats.runs);
+        put<quint32>(&image, stats.failures);
+        put<qint64>(&image, stats.lastRun);
+    }
+
+    m_compacting = true;
+    m_snapshotRuns = m_logRuns;
+    m_snapshotSize = m_logSize;
+    m_snapshotEpoch = m_epoch;
+
+    // Per process, so two compacting processes never share a file
+    const QString tempPath = QString("%1.compact.%2").arg(m_path).arg(QCoreApplication::applicationPid());
+    const quint64 generation = m_generation;
+    m_compactPool.start([this, image, tempPath, generation, epoch]() {
+        QFile file(tempPath);
+        const bool written = file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+                             && file.write(image) == image.size() && file.flush();
+        file.close();
+        const qint64 imageSize = image.size();
+        QMetaObject::invokeMethod(this, [this, tempPath, written, generation, epoch, imageSize]() {
+            finishCompaction(tempPath, written, generation, epoch, imageSize);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ExecutionHistory::finishCompaction(const QString &tempPath, bool written, quint64 generation,
+                                        quint64 epoch, qint64 imageSize)
+{
+    m_compacting = false;
+
+    // Cleared meanwhile: the snapshot holds history that is gone
+    if (generation != m_generation || !written) {
+        if (written) qDebug() << "Dropping compaction of cleared history";
+        else qWarning() << "Could not write compacted history to" << tempPath;
+        QFile::remove(tempPath);
+        return;
+    }
+
+    if (!lockLog()) {
+        QFile::remove(tempPath);
+        return;
+    }
+    const bool caughtUp = syncLog();
+    const bool replaced = replaceLog(tempPath, epoch, imageSize);
+    m_lock.unlock();
+
+    if (!replaced) QFile::remove(tempPath);
+    if (caughtUp) {
+        sortRanking();
+        refresh();
+        emit historyChanged();
+    }
+}
+
+bool ExecutionHistory::replaceLog(const QString &tempPath, quint64 epoch, qint64 imageSize)
+{
+    // Another process rewrote the log since the snapshot; its copy wins
+    if (m_epoch != m_snapshotEpoch || m_logSize < m_snapshotSize) {
+        qDebug() << "Dropping compaction of a log rewritten elsewhere";
+        return false;
+    }
+
+    // Records any process appended since the snapshot go after it
+    QByteArray tail;
+    QFile log(m_path);
+    if (log.open(QIODevice::ReadOnly) && log.seek(m_snapshotSize)) tail = log.read(m_logSize - m_snapshotSize);
+    log.close();
+
+    QFile file(tempPath);
+    if (tail.size() != m_logSize - m_snapshotSize || !file.open(QIODevice::WriteOnly | QIODevice::Append)
+        || file.write(tail) != tail.size()) {
+        qWarning() << "Could not write compacted history to" << tempPath;
+        return false;
+    }
+    file.close();
+
+    // QFile::rename won't replace an existing file; std::filesystem does, atomically on POSIX
+    std::error_code error;
+    std::filesystem::rename(std::filesystem::path(tempPath.toStdU16String()),
+                            std::filesystem::path(m_path.toStdU16String()), error);
+    if (error) {
+        qWarning() << "Could not replace history log:" << QString::fromStdString(error.message());
+        return false;
+    }
+
+    m_epoch = epoch;
+    m_logSize = imageSize + tail.size();
+    m_logRuns -= m_snapshotRuns;
+    qDebug() << "History compacted to" << m_ids.size() << "actions," << m_logRuns << "runs since";
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef EXECUTIONHISTORY_H
+#define EXECUTIONHISTORY_H
+
+#include <QObject>
+#include <QtQml/qqmlregistration.h>
+#include <QByteArray>
+#include <QHash>
+#include <QLockFile>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVariantMap>
+#include <QVector>
+
+#include "actionmodels.h"
+
+class ActionManager;
+
+// Every finished execution, appended to a compact binary log, and a
+// frecency score per action folded from it. A run adds a weight that
+// halves every HalfLifeDays; scores are stored as of their last run, so
+// the ranking key log2(score) + lastUpdate / halfLife never changes
+// between runs and the ranking only moves the one action that ran.
+// Once the log is mostly raw runs it is rewritten in the background as
+// one summary record per action, so loading stays proportional to the
+// number of distinct actions rather than the length of the history.
+// The GUI and headless runs share the log: every read, append and
+// compaction holds a lock file, and each process catches up on records
+// the others wrote before it adds its own, so id indexes stay in step.
+class ExecutionHistory : public QObject
+{
+    Q_OBJECT
+    QML_ANONYMOUS
+    Q_PROPERTY(ActionListModel *recent READ recentModel CONSTANT)
+    Q_PROPERTY(int recentLimit READ recentLimit WRITE setRecentLimit NOTIFY recentLimitChanged)
+    Q_PROPERTY(int runCount READ runCount NOTIFY historyChanged)
+
+public:
+    ExecutionHistory(const ActionManager *manager, const QString &path, QObject *parent = nullptr);
+    ~ExecutionHistory() override;
+
+    // Highest frecency first, actions no longer in the catalog skipped
+    ActionListModel *recentModel() const { return m_recent; }
+    Q_INVOKABLE QStringList topActions(int limit = 20) const;
+    // runs, failures, lastRun and score of one action; empty when never run
+    Q_INVOKABLE QVariantMap stats(const QString &actionId) const;
+    Q_INVOKABLE void clear();
+
+    int recentLimit() const { return m_recentLimit; }
+    void setRecentLimit(int limit);
+    int runCount() const { return int(m_runCount); }
+
+    void record(const QString &actionId, bool success);
+    // Catalog changed: re-filter the recent model
+    void refresh();
+
+signals:
+    void recentLimitChanged();
+    void historyChanged();
+
+private:
+    struct Stats {
+        double score = 0;     // Decayed run weight as of scoreTime
+        qint64 scoreTime = 0; // ms since epoch
+        quint32 runs = 0;
+        quint32 failures = 0;
+        qint64 lastRun = 0;
+        double rank = 0;      // Comparable across actions without decaying
+    };
+
+    const ActionManager *m_manager;
+    QString m_path;
+    QLockFile m_lock;
+    quint64 m_epoch = 0;  // Header tag, new for every rewrite of the file
+    qint64 m_logSize = 0; // Bytes of the log folded into the state below
+    QStringList m_ids; // Log index -> action id
+    QHash<QString, int> m_idIndex;
+    QVector<Stats> m_stats; // Parallel to m_ids
+    QVector<int> m_ranking; // Indexes into m_ids, best first
+    quint64 m_runCount = 0;
+    quint64 m_logRuns = 0; // Raw run records in the log since the last compaction
+    ActionListModel *m_recent;
+    int m_recentLimit = 4;
+
+    QThreadPool m_compactPool;
+    bool m_compacting = false;
+    quint64 m_snapshotRuns = 0;  // m_logRuns folded into the compaction snapshot
+    qint64 m_snapshotSize = 0;   // m_logSize at the snapshot; later records are copied over
+    quint64 m_snapshotEpoch = 0; // The log the snapshot was taken of
+    quint64 m_generation = 0;    // Bumped by clear(); a stale compaction is dropped
+
+    void load();
+    bool lockLog();
+    bool syncLog();
+    void resetState();
+    bool createLog();
+    bool parseRecords(const char *data, qsizetype size, qsizetype *valid);
+    bool append(const QByteArray &records);
+    int intern(const QString &actionId, QByteArray *records);
+    void apply(int index, qint64 time, bool success);
+    void rerank(int index);
+    void sortRanking();
+    void compactIfNeeded();
+    void compact();
+    void finishCompaction(const QString &tempPath, bool written, quint64 generation, quint64 epoch,
+                          qint64 imageSize);
+    bool replaceLog(const QString &tempPath, quint64 epoch, qint64 imageSize);
+};
+
+#endif // EXECUTIONHISTORY_H
@@ -0,0 +1,267 @@
+#include "executiontelemetry.h"
+#include "jobscheduler.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QDebug>
+#include <algorithm>
+
+// Untagged jobs (e.g. SRunner commands) are grouped under this name
+static const char UntaggedName[] = "(untagged)";
+static const int RssSampleIntervalMs = 100;
+
+// Prometheus bucket bounds in seconds for the timing histograms
+static const double SecondsBuckets[] = { 0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 300 };
+
+ExecutionTelemetry::ExecutionTelemetry(JobScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_scheduler(scheduler)
+{
+    m_clock.start();
+    m_rssTimer.setInterval(RssSampleIntervalMs);
+    connect(&m_rssTimer, &QTimer::timeout, this, [this]() {
+        for (InFlight &job : m_inFlight) sampleRss(job);
+    });
+
+    connect(m_scheduler, &JobScheduler::jobQueued, this, [this](int jobId) {
+        InFlight job;
+        job.tag = m_scheduler->tag(jobId);
+        if (job.tag.isEmpty()) job.tag = UntaggedName;
+        job.queuedAt = nowUs();
+        m_inFlight.insert(jobId, job);
+    });
+
+    connect(m_scheduler, &JobScheduler::jobStarted, this, [this](int jobId) {
+        auto it = m_inFlight.find(jobId);
+        if (it == m_inFlight.end()) return;
+        it->startedAt = nowUs();
+        it->pid = m_scheduler->processId(jobId);
+        stats(it->tag).spawnLatency.record(quint64(it->startedAt - it->queuedAt));
+        sampleRss(*it);
+        if (it->pid && !m_rssTimer.isActive()) m_rssTimer.start();
+    });
+
+    connect(m_scheduler, &JobScheduler::jobOutput, this, [this](int jobId) {
+        auto it = m_inFlight.find(jobId);
+        if (it == m_inFlight.end() || it->firstOutputAt || !it->startedAt) return;
+        it->firstOutputAt = nowUs();
+        stats(it->tag).firstOutput.record(quint64(it->firstOutputAt - it->startedAt));
+        sampleRss(*it);
+    });
+
+    connect(m_scheduler, &JobScheduler::jobFinished, this,
+            [this](int jobId, int exitCode, QProcess::ExitStatus exitStatus) {
+                complete(jobId, exitStatus == QProcess::NormalExit, exitCode);
+            });
+    connect(m_scheduler, &JobScheduler::jobError, this, [this](int jobId) {
+        complete(jobId, false, -1);
+    });
+    connect(m_scheduler, &JobScheduler::jobCanceled, this, [this](int jobId) {
+        // Never ran to completion; only drop the bookkeeping
+        m_inFlight.remove(jobId);
+    });
+}
+
+ExecutionTelemetry::ActionStats &ExecutionTelemetry::stats(const QString &tag)
+{
+    auto it = m_stats.find(tag);
+    if (it == m_stats.end()) it = m_stats.insert(tag, std::make_shared<ActionStats>());
+    return *it.value();
+}
+
+void ExecutionTelemetry::sampleRss(InFlight &job)
+{
+#ifdef Q_OS_LINUX
+    if (!job.pid) return;
+
+    // VmHWM is the kernel's own high-water mark, so sparse sampling
+    // still sees peaks between samples
+    QFile status(QString("/proc/%1/status").arg(job.pid));
+    if (!status.open(QIODevice::ReadOnly)) return;
+
+    const QList<QByteArray> lines = status.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (!line.startsWith("VmHWM:")) continue;
+        const qint64 kib = line.mid(6).trimmed().split(' ').value(0).toLongLong();
+        job.sampledPeakRssKiB = qMax(job.sampledPeakRssKiB, kib);
+        break;
+    }
+#else
+    Q_UNUSED(job);
+#endif
+}
+
+void ExecutionTelemetry::complete(int jobId, bool finished, int exitCode)
+{
+    auto it = m_inFlight.find(jobId);
+    if (it == m_inFlight.end()) return;
+
+    const InFlight job = it.value();
+    m_inFlight.erase(it);
+    if (m_inFlight.isEmpty()) m_rssTimer.stop();
+
+    ActionStats &s = stats(job.tag);
+    s.runs.fetch_add(1, std::memory_order_relaxed);
+    if (!finished || exitCode != 0) s.failures.fetch_add(1, std::memory_order_relaxed);
+    s.lastExitCode.store(exitCode, std::memory_order_relaxed);
+    ++s.exitCodes[exitCode];
+
+    if (job.startedAt) s.runTime.record(quint64(nowUs() - job.startedAt));
+    if (job.sampledPeakRssKiB > 0) s.sampledPeakRss.record(quint64(job.sampledPeakRssKiB));
+
+    emit statsChanged(job.tag);
+}
+
+QVariantMap ExecutionTelemetry::histogramSummary(const LatencyHistogram &histogram, double scale)
+{
+    QVariantMap result;
+    result["count"] = histogram.count();
+    result["p50"] = histogram.percentile(50) * scale;
+    result["p90"] = histogram.percentile(90) * scale;
+    result["p99"] = histogram.percentile(99) * scale;
+    result["max"] = histogram.max() * scale;
+    result["mean"] = histogram.mean() * scale;
+    return result;
+}
+
+QVariantMap ExecutionTelemetry::actionStats(const QString &actionId) const
+{
+    QVariantMap result;
+    const auto it = m_stats.constFind(actionId);
+    if (it == m_stats.constEnd()) return result;
+
+    const ActionStats &s = *it.value();
+    result["actionId"] = actionId;
+    result["runs"] = s.runs.load();
+    result["failures"] = s.failures.load();
+    result["lastExitCode"] = s.lastExitCode.load();
+    result["spawnMs"] = histogramSummary(s.spawnLatency, 0.001);
+    result["firstOutputMs"] = histogramSummary(s.firstOutput, 0.001);
+    result["runMs"] = histogramSummary(s.runTime, 0.001);
+    result["totalRunMs"] = s.runTime.sum() / 1000.0;
+    result["sampledPeakRssKiB"] = histogramSummary(s.sampledPeakRss, 1.0);
+    return result;
+}
+
+QVariantList ExecutionTelemetry::summary() const
+{
+    QStringList tags = m_stats.keys();
+    std::sort(tags.begin(), tags.end(), [this](const QString &a, const QString &b) {
+        return m_stats.value(a)->runTime.sum() > m_stats.value(b)->runTime.sum();
+    });
+
+    QVariantList result;
+    for (const QString &tag : std::as_const(tags)) result.append(actionStats(tag));
+    return result;
+}
+
+void ExecutionTelemetry::reset()
+{
+    const QStringList tags = m_stats.keys();
+    m_stats.clear();
+    for (const QString &tag : tags) emit statsChanged(tag);
+}
+
+static QString labelValue(QString value)
+{
+    value.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return value;
+}
+
+QString ExecutionTelemetry::prometheusText() const
+{
+    QString out;
+    QStringList tags = m_stats.keys();
+    std::sort(tags.begin(), tags.end());
+
+    auto timing = [&](const char *name, const char *help, LatencyHistogram ActionStats::*member) {
+        out += QString("# HELP scriptrunner_%1 %2\n# TYPE scriptrunner_%1 histogram\n").arg(name, help);
+        for (const QString &tag : std::as_const(tags)) {
+            const LatencyHistogram &histogram = m_stats.value(tag).get()->*member;
+            const QString label = QString("action=\"%1\"").arg(labelValue(tag));
+            for (double bound : SecondsBuckets) {
+                out += QString("scriptrunner_%1_bucket{%2,le=\"%3\"} %4\n")
+                           .arg(name, label).arg(bound).arg(histogram.countAtOrBelow(quint64(bound * 1e6)));
+            }
+            out += QString("scriptrunner_%1_bucket{%2,le=\"+Inf\"} %3\n").arg(name, label).arg(histogram.count());
+            out += QString("scriptrunner_%1_sum{%2} %3\n").arg(name, label).arg(histogram.sum() / 1e6);
+            out += QString("scriptrunner_%1_count{%2} %3\n").arg(name, label).arg(histogram.count());
+        }
+    };
+
+    timing("spawn_latency_seconds", "Time from submit until the process started.", &ActionStats::spawnLatency);
+    timing("first_output_seconds", "Time from start until the first output.", &ActionStats::firstOutput);
+    timing("run_time_seconds", "Time from start until the process exited.", &ActionStats::runTime);
+
+    out += "# HELP scriptrunner_sampled_peak_rss_kib Largest peak resident set size seen by sampling, per action.\n"
+           "# TYPE scriptrunner_sampled_peak_rss_kib gauge\n";
+    for (const QString &tag : std::as_const(tags)) {
+        out += QString("scriptrunner_sampled_peak_rss_kib{action=\"%1\"} %2\n")
+                   .arg(labelValue(tag)).arg(m_stats.value(tag)->sampledPeakRss.max());
+    }
+
+    out += "# HELP scriptrunner_runs_total Completed runs by exit code.\n"
+           "# TYPE scriptrunner_runs_total counter\n";
+    for (const QString &tag : std::as_const(tags)) {
+        const ActionStats &s = *m_stats.value(tag);
+        for (auto it = s.exitCodes.constBegin(); it != s.exitCodes.constEnd(); ++it) {
+            out += QString("scriptrunner_runs_total{action=\"%1\",exit_code=\"%2\"} %3\n")
+                       .arg(labelValue(tag)).arg(it.key()).arg(it.value());
+        }
+    }
+    return out;
+}
+
+QJsonObject ExecutionTelemetry::histogramJson(const LatencyHistogram &histogram)
+{
+    QJsonObject result;
+    result["count"] = qint64(histogram.count());
+    result["sum"] = qint64(histogram.sum());
+    result["max"] = qint64(histogram.max());
+    result["p50"] = qint64(histogram.percentile(50));
+    result["p90"] = qint64(histogram.percentile(90));
+    result["p99"] = qint64(histogram.percentile(99));
+    return result;
+}
+
+QJsonObject ExecutionTelemetry::toJson() const
+{
+    QJsonObject actions;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        const ActionStats &s = *it.value();
+
+        QJsonObject exitCodes;
+        for (auto code = s.exitCodes.constBegin(); code != s.exitCodes.constEnd(); ++code)
+            exitCodes[QString::number(code.key())] = qint64(code.value());
+
+        QJsonObject action;
+        action["runs"] = qint64(s.runs.load());
+        action["failures"] = qint64(s.failures.load());
+        action["last_exit_code"] = s.lastExitCode.load();
+        action["exit_codes"] = exitCodes;
+        action["spawn_latency_us"] = histogramJson(s.spawnLatency);
+        action["first_output_us"] = histogramJson(s.firstOutput);
+        action["run_time_us"] = histogramJson(s.runTime);
+        action["sampled_peak_rss_kib"] = histogramJson(s.sampledPeakRss);
+        actions[it.key()] = action;
+    }
+
+    QJsonObject root;
+    root["actions"] = actions;
+    return root;
+}
+
+bool ExecutionTelemetry::exportTo(const QString &path) const
+{
+    const QByteArray data = path.endsWith(".json", Qt::CaseInsensitive)
+                                ? QJsonDocument(toJson()).toJson()
+                                : prometheusText().toUtf8();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "Could not write metrics to" << path;
+        return false;
+    }
+    return true;
+}
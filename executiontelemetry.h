@@ -0,0 +1,79 @@
+#ifndef EXECUTIONTELEMETRY_H
+#define EXECUTIONTELEMETRY_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QTimer>
+#include <QVariantMap>
+#include <memory>
+
+#include "latencyhistogram.h"
+
+class JobScheduler;
+
+// Per-action execution metrics collected from JobScheduler signals. Jobs
+// are grouped by their tag (the action id for catalog actions). Timings
+// are recorded in microseconds. Peak RSS in KiB is the highest VmHWM seen
+// by sampling /proc every 100 ms while the child runs (Linux only); QProcess
+// reaps the child itself, so the exact ru_maxrss is out of reach and runs
+// shorter than a sample interval may miss their peak.
+class ExecutionTelemetry : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ExecutionTelemetry(JobScheduler *scheduler, QObject *parent = nullptr);
+
+    // runs, failures, lastExitCode and p50/p90/p99/max/mean per metric
+    Q_INVOKABLE QVariantMap actionStats(const QString &actionId) const;
+    // One entry per action, heaviest total run time first
+    Q_INVOKABLE QVariantList summary() const;
+    Q_INVOKABLE void reset();
+
+    Q_INVOKABLE QString prometheusText() const;
+    QJsonObject toJson() const;
+    // Prometheus text unless the path ends in .json
+    Q_INVOKABLE bool exportTo(const QString &path) const;
+
+signals:
+    void statsChanged(const QString &actionId);
+
+private:
+    struct ActionStats {
+        LatencyHistogram spawnLatency;  // Queued -> process started
+        LatencyHistogram firstOutput;   // Started -> first byte of output
+        LatencyHistogram runTime;       // Started -> finished
+        LatencyHistogram sampledPeakRss; // KiB
+        std::atomic<quint64> runs { 0 };
+        std::atomic<quint64> failures { 0 };
+        std::atomic<int> lastExitCode { 0 };
+        QHash<int, quint64> exitCodes;
+    };
+
+    struct InFlight {
+        QString tag;
+        qint64 queuedAt = 0;
+        qint64 startedAt = 0;
+        qint64 firstOutputAt = 0;
+        qint64 pid = 0;
+        qint64 sampledPeakRssKiB = 0;
+    };
+
+    JobScheduler *m_scheduler;
+    QElapsedTimer m_clock;
+    QTimer m_rssTimer;
+    QHash<QString, std::shared_ptr<ActionStats>> m_stats;
+    QHash<int, InFlight> m_inFlight;
+
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+    ActionStats &stats(const QString &tag);
+    void sampleRss(InFlight &job);
+    void complete(int jobId, bool finished, int exitCode);
+
+    static QVariantMap histogramSummary(const LatencyHistogram &histogram, double scale);
+    static QJsonObject histogramJson(const LatencyHistogram &histogram);
+};
+
+#endif // EXECUTIONTELEMETRY_H
@@ -0,0 +1,195 @@
+#include "headlessrunner.h"
+#include "actionmanager.h"
+#include "jobscheduler.h"
+#include <QFile>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTextStream>
+#include <cstdio>
+
+static void writeLines(FILE *stream, const QStringList &lines)
+{
+    for (const QString &line : lines) {
+        const QByteArray bytes = line.toLocal8Bit();
+        std::fwrite(bytes.constData(), 1, bytes.size(), stream);
+        std::fputc('\n', stream);
+    }
+    std::fflush(stream);
+}
+
+static void writeMessage(FILE *stream, const QString &message)
+{
+    writeLines(stream, { message });
+}
+
+HeadlessRunner::HeadlessRunner(ActionManager *actions, JobScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_actions(actions)
+    , m_scheduler(scheduler)
+{
+    connect(m_scheduler, &JobScheduler::jobQueued, this, [this](int jobId) {
+        if (ownsJob(jobId)) m_printed.insert(jobId, Printed());
+    });
+    connect(m_scheduler, &JobScheduler::jobOutput, this, &HeadlessRunner::printOutput);
+    connect(m_scheduler, &JobScheduler::jobFinished, this, [this](int jobId, int exitCode) {
+        if (!m_printed.contains(jobId)) return;
+        printOutput(jobId);
+        m_printed.remove(jobId);
+        m_exitCode = exitCode;
+    });
+    connect(m_scheduler, &JobScheduler::jobError, this, [this](int jobId, const QString &error) {
+        if (!m_printed.remove(jobId)) return;
+        writeMessage(stderr, QString("%1: %2").arg(m_current, error));
+    });
+
+    // Deferred: the job's own finished handlers may still be printing
+    connect(m_actions, &ActionManager::actionExecuted, this, [this](const QString &actionId, bool success) {
+        if (actionId != m_current) return;
+        QMetaObject::invokeMethod(this, [this, success]() { completeCurrent(success); }, Qt::QueuedConnection);
+    });
+    connect(m_actions, &ActionManager::actionResultCached, this,
+            [this](const QString &actionId, int exitCode, const QString &output) {
+                if (actionId != m_current) return;
+                m_exitCode = exitCode;
+                writeLines(stdout, output.split('\n'));
+            });
+}
+
+bool HeadlessRunner::parseInput(const QString &text, QVariantMap *inputs)
+{
+    const qsizetype equals = text.indexOf('=');
+    if (equals <= 0) return false;
+    inputs->insert(text.left(equals), text.mid(equals + 1));
+    return true;
+}
+
+void HeadlessRunner::listActions() const
+{
+    QStringList lines;
+    for (const QString &category : m_actions->categoriesKeys()) {
+        const ActionListModel *model = m_actions->categoryModel()->actions(category);
+        for (int row = 0; model && row < model->rowCount(); ++row) {
+            const QString id = model->data(model->index(row), ActionListModel::ActionIdRole).toString();
+            const ActionDefinition *action = m_actions->findAction(id);
+            if (action) lines.append(QString("%1\t%2\t%3\t%4").arg(action->id, action->category, action->type, action->name));
+        }
+    }
+    writeLines(stdout, lines);
+}
+
+bool HeadlessRunner::enqueue(const QString &actionId, const QVariantMap &inputs, QString *error)
+{
+    const ActionDefinition *action = m_actions->findAction(actionId);
+    if (!action) {
+        *error = QString("Unknown action '%1'").arg(actionId);
+        return false;
+    }
+
+    // There is nobody to ask, so every declared input must be given
+    for (const InputDefinition &input : action->inputDefs) {
+        if (!inputs.contains(input.id) && !input.defaultValue.isValid()) {
+            *error = QString("Action '%1' needs --input %2=...").arg(actionId, input.id);
+            return false;
+        }
+    }
+
+    m_pending.enqueue({ actionId, inputs });
+    return true;
+}
+
+bool HeadlessRunner::enqueueBatch(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = QString("Cannot open batch file '%1'").arg(path);
+        return false;
+    }
+
+    int lineNumber = 0;
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        ++lineNumber;
+        const QString line = stream.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        QStringList parts = QProcess::splitCommand(line);
+        const QString actionId = parts.takeFirst();
+        QVariantMap inputs;
+        for (const QString &part : std::as_const(parts)) {
+            if (!parseInput(part, &inputs)) {
+                *error = QString("%1:%2: expected key=value, got '%3'").arg(path).arg(lineNumber).arg(part);
+                return false;
+            }
+        }
+
+        QString enqueueError;
+        if (!enqueue(actionId, inputs, &enqueueError)) {
+            *error = QString("%1:%2: %3").arg(path).arg(lineNumber).arg(enqueueError);
+            return false;
+        }
+    }
+    return true;
+}
+
+void HeadlessRunner::start()
+{
+    QMetaObject::invokeMethod(this, &HeadlessRunner::runNext, Qt::QueuedConnection);
+}
+
+bool HeadlessRunner::ownsJob(int jobId) const
+{
+    // Workflow steps are tagged "<workflow>/<step>"
+    const QString tag = m_scheduler->tag(jobId);
+    return !m_current.isEmpty() && (tag == m_current || tag.startsWith(m_current + "/"));
+}
+
+void HeadlessRunner::printOutput(int jobId)
+{
+    auto it = m_printed.find(jobId);
+    if (it == m_printed.end()) return;
+
+    const auto output = m_scheduler->output(jobId);
+    if (!output) return;
+
+    auto flush = [](const OutputBuffer &buffer, qint64 *printed, FILE *stream) {
+        // Lines overwritten before we got to them are skipped
+        const qint64 first = qMax(*printed, buffer.firstAvailableLine());
+        const qint64 count = buffer.lineCount() - first;
+        if (count > 0) writeLines(stream, buffer.lines(first, int(count)));
+        *printed = buffer.lineCount();
+    };
+    flush(output->standardOutput, &it->standardOutput, stdout);
+    flush(output->standardError, &it->standardError, stderr);
+}
+
+void HeadlessRunner::runNext()
+{
+    if (m_pending.isEmpty()) {
+        const int exitCode = m_failures == 0 ? 0 : (m_invocations == 1 && m_exitCode > 0 ? m_exitCode : 1);
+        emit finished(exitCode);
+        return;
+    }
+
+    const Invocation invocation = m_pending.dequeue();
+    m_current = invocation.actionId;
+    m_exitCode = 0;
+    ++m_invocations;
+
+    const ActionDefinition *action = m_actions->findAction(invocation.actionId);
+    if (action && !action->inputDefs.isEmpty())
+        m_actions->executeActionWithInputs(invocation.actionId, invocation.inputs);
+    else
+        m_actions->executeAction(invocation.actionId);
+}
+
+void HeadlessRunner::completeCurrent(bool success)
+{
+    if (!success) {
+        ++m_failures;
+        writeMessage(stderr, QString("%1: failed%2").arg(m_current,
+                     m_exitCode ? QString(" with exit code %1").arg(m_exitCode) : QString()));
+    }
+    m_current.clear();
+    m_printed.clear();
+    runNext();
+}
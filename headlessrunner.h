@@ -0,0 +1,60 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QQueue>
+#include <QVariantMap>
+
+class ActionManager;
+class JobScheduler;
+
+// Drives ActionManager from the command line without any QML: runs
+// actions one after another, streams their output to stdout/stderr and
+// finishes with an exit code for scripts, cron and CI.
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    HeadlessRunner(ActionManager *actions, JobScheduler *scheduler, QObject *parent = nullptr);
+
+    void listActions() const;
+    bool enqueue(const QString &actionId, const QVariantMap &inputs, QString *error);
+    // One invocation per line: "<action id> [key=value ...]", # comments
+    bool enqueueBatch(const QString &path, QString *error);
+    void start();
+
+    // "key=value" -> inputs; false when there's no '='
+    static bool parseInput(const QString &text, QVariantMap *inputs);
+
+signals:
+    void finished(int exitCode);
+
+private:
+    struct Invocation {
+        QString actionId;
+        QVariantMap inputs;
+    };
+
+    struct Printed {
+        qint64 standardOutput = 0;
+        qint64 standardError = 0;
+    };
+
+    ActionManager *m_actions;
+    JobScheduler *m_scheduler;
+    QQueue<Invocation> m_pending;
+    QString m_current;
+    QHash<int, Printed> m_printed; // Jobs of the current invocation
+    int m_exitCode = 0;   // Of the current invocation's last job
+    int m_failures = 0;
+    int m_invocations = 0;
+
+    bool ownsJob(int jobId) const;
+    void printOutput(int jobId);
+    void runNext();
+    void completeCurrent(bool success);
+};
+
+#endif // HEADLESSRUNNER_H
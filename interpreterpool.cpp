@@ -0,0 +1,256 @@
+#include "interpreterpool.h"
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QTimer>
+#include <QDebug>
+#include <utility>
+
+// A worker that keeps dying is given up on after this many restarts
+static const int MaxWorkerFailures = 5;
+static const int RestartDelayMs = 500;
+// A stopped worker gets this long to exit before it is killed
+static const int StopGraceMs = 1000;
+
+InterpreterPool::Config InterpreterPool::Config::fromJson(const QJsonObject &object, const QString &baseDir)
+{
+    const QDir base(baseDir);
+
+    Config config;
+    config.program = object.value("program").toString();
+    for (const QJsonValue &argument : object.value("arguments").toArray()) {
+        // Worker scripts ship next to actions.json
+        const QString value = argument.toString();
+        config.arguments.append(!value.startsWith('-') && base.exists(value)
+                                    ? base.absoluteFilePath(value) : value);
+    }
+    config.workingDirectory = object.value("working_directory").toString(baseDir);
+    config.size = qBound(1, object.value("size").toInt(2), 64);
+    return config;
+}
+
+bool InterpreterPool::Config::operator==(const Config &other) const
+{
+    return program == other.program && arguments == other.arguments
+           && workingDirectory == other.workingDirectory && size == other.size;
+}
+
+InterpreterPool::InterpreterPool(const QString &name, const Config &config, QObject *parent)
+    : QObject(parent)
+    , m_name(name)
+    , m_config(config)
+{
+    // Workers are warmed up front, the first request must not pay startup
+    m_workers.resize(m_config.size);
+    for (int slot = 0; slot < m_workers.size(); ++slot) startWorker(slot);
+}
+
+InterpreterPool::~InterpreterPool()
+{
+    // No grace period left: the processes are children and die with the pool
+    for (Worker &worker : m_workers) {
+        if (!worker.process) continue;
+        worker.process->disconnect(this);
+        worker.process->kill();
+    }
+}
+
+void InterpreterPool::invoke(int requestId, const QStringList &argv, const QString &workingDirectory)
+{
+    if (argv.isEmpty()) {
+        emit failed(requestId, "Nothing to run");
+        return;
+    }
+    if (!hasLiveWorker()) {
+        emit failed(requestId, QString("Interpreter pool '%1' has no running workers").arg(m_name));
+        return;
+    }
+
+    m_pending.enqueue({ requestId, argv, workingDirectory });
+    dispatch();
+}
+
+bool InterpreterPool::cancel(int requestId)
+{
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+        if (it->id == requestId) {
+            m_pending.erase(it);
+            return true;
+        }
+    }
+
+    // A script can't be interrupted in-process; replace the worker
+    for (int slot = 0; slot < m_workers.size(); ++slot) {
+        if (m_workers[slot].requestId != requestId) continue;
+        stopWorker(slot);
+        startWorker(slot);
+        return true;
+    }
+    return false;
+}
+
+int InterpreterPool::idleCount() const
+{
+    int idle = 0;
+    for (const Worker &worker : m_workers) {
+        if (worker.ready && worker.requestId == 0) ++idle;
+    }
+    return idle;
+}
+
+bool InterpreterPool::hasLiveWorker() const
+{
+    for (const Worker &worker : m_workers) {
+        if (worker.process || worker.failures < MaxWorkerFailures) return true;
+    }
+    return false;
+}
+
+void InterpreterPool::startWorker(int slot)
+{
+    QProcess *process = new QProcess(this);
+    Worker &worker = m_workers[slot];
+    worker.process = process;
+    worker.ready = false;
+    worker.requestId = 0;
+    worker.buffer.clear();
+
+    process->setProgram(m_config.program);
+    process->setArguments(m_config.arguments);
+    if (!m_config.workingDirectory.isEmpty())
+        process->setWorkingDirectory(m_config.workingDirectory);
+
+    connect(process, &QProcess::started, this, [this, slot]() {
+        m_workers[slot].ready = true;
+        dispatch();
+    });
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, slot]() {
+        readResponses(slot);
+    });
+
+    // Worker diagnostics, not part of any request's output
+    connect(process, &QProcess::readyReadStandardError, this, [this, process]() {
+        const QByteArray text = process->readAllStandardError().trimmed();
+        if (!text.isEmpty()) qDebug().noquote() << "Pool" << m_name << "worker:" << text;
+    });
+
+    connect(process, &QProcess::finished, this, [this, slot](int exitCode) {
+        workerExited(slot, QString("worker exited with code %1").arg(exitCode));
+    });
+
+    connect(process, &QProcess::errorOccurred, this, [this, slot, process](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) workerExited(slot, process->errorString());
+    });
+
+    process->start();
+}
+
+void InterpreterPool::stopWorker(int slot)
+{
+    Worker &worker = m_workers[slot];
+    if (!worker.process) return;
+
+    // The slot is free at once; the old process winds down on its own
+    // without blocking the caller, which is usually the UI thread
+    QProcess *process = std::exchange(worker.process, nullptr);
+    worker.ready = false;
+    worker.requestId = 0;
+    worker.buffer.clear();
+
+    process->disconnect(this);
+    if (process->state() == QProcess::NotRunning) {
+        process->deleteLater();
+        return;
+    }
+
+    connect(process, &QProcess::finished, process, &QObject::deleteLater);
+    connect(process, &QProcess::errorOccurred, process, [process](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) process->deleteLater();
+    });
+    process->terminate();
+    QTimer::singleShot(StopGraceMs, process, [process]() {
+        if (process->state() != QProcess::NotRunning) process->kill();
+    });
+}
+
+void InterpreterPool::workerExited(int slot, const QString &reason)
+{
+    Worker &worker = m_workers[slot];
+    if (!worker.process) return;
+
+    const int requestId = worker.requestId;
+    worker.process->disconnect(this);
+    worker.process->deleteLater();
+    worker.process = nullptr;
+    worker.ready = false;
+    worker.requestId = 0;
+    ++worker.failures;
+
+    qWarning() << "Pool" << m_name << reason;
+
+    if (worker.failures < MaxWorkerFailures) {
+        QTimer::singleShot(RestartDelayMs * worker.failures, this, [this, slot]() {
+            if (!m_workers[slot].process) startWorker(slot);
+        });
+    } else {
+        qWarning() << "Pool" << m_name << "gave up restarting a worker";
+    }
+
+    if (requestId) emit failed(requestId, reason);
+
+    // Nobody left to serve the queue
+    if (!hasLiveWorker()) {
+        const QQueue<Request> pending = std::exchange(m_pending, {});
+        for (const Request &request : pending)
+            emit failed(request.id, QString("Interpreter pool '%1' has no running workers").arg(m_name));
+    }
+}
+
+void InterpreterPool::readResponses(int slot)
+{
+    Worker &worker = m_workers[slot];
+    if (!worker.process) return;
+    worker.buffer.append(worker.process->readAllStandardOutput());
+
+    qsizetype newline;
+    while ((newline = worker.buffer.indexOf('\n')) >= 0) {
+        const QByteArray line = worker.buffer.left(newline);
+        worker.buffer.remove(0, newline + 1);
+
+        const QJsonObject response = QJsonDocument::fromJson(line).object();
+        const int requestId = response.value("id").toInt();
+        if (requestId == 0 || requestId != worker.requestId) {
+            qWarning() << "Pool" << m_name << "ignoring unexpected worker output:" << line.left(200);
+            continue;
+        }
+
+        worker.requestId = 0;
+        worker.failures = 0;
+        emit finished(requestId, response.value("exit_code").toInt(1),
+                      response.value("stdout").toString().toUtf8(),
+                      response.value("stderr").toString().toUtf8());
+
+        if (!worker.process) break;
+    }
+
+    dispatch();
+}
+
+void InterpreterPool::dispatch()
+{
+    for (int slot = 0; slot < m_workers.size() && !m_pending.isEmpty(); ++slot) {
+        Worker &worker = m_workers[slot];
+        if (!worker.ready || worker.requestId != 0) continue;
+
+        const Request request = m_pending.dequeue();
+        QJsonObject message;
+        message["id"] = request.id;
+        message["argv"] = QJsonArray::fromStringList(request.argv);
+        if (!request.workingDirectory.isEmpty()) message["cwd"] = request.workingDirectory;
+
+        worker.requestId = request.id;
+        worker.process->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+    }
+}
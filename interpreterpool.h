@@ -0,0 +1,82 @@
+#ifndef INTERPRETERPOOL_H
+#define INTERPRETERPOOL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QQueue>
+#include <QStringList>
+
+class QProcess;
+
+// A set of long-lived interpreter processes (python, node, ...) that run
+// scripts on request instead of paying interpreter startup per launch.
+// Workers speak line-delimited JSON on stdin/stdout:
+//   request:  {"id": 7, "argv": ["tool.py", "a"], "cwd": "/dir"}
+//   response: {"id": 7, "exit_code": 0, "stdout": "...", "stderr": "..."}
+// A worker handles one request at a time; a worker that exits is
+// restarted with a growing delay and its request fails.
+class InterpreterPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Config {
+        QString program;           // Interpreter, e.g. "python3"
+        QStringList arguments;     // Worker script and its options
+        QString workingDirectory;
+        int size = 2;
+
+        // "pools" entry of actions.json; relative paths resolve against baseDir
+        static Config fromJson(const QJsonObject &object, const QString &baseDir);
+        bool operator==(const Config &other) const;
+        bool operator!=(const Config &other) const { return !(*this == other); }
+    };
+
+    InterpreterPool(const QString &name, const Config &config, QObject *parent = nullptr);
+    ~InterpreterPool() override;
+
+    const QString &name() const { return m_name; }
+    const Config &config() const { return m_config; }
+
+    void invoke(int requestId, const QStringList &argv, const QString &workingDirectory = QString());
+    bool cancel(int requestId);
+
+    int idleCount() const;
+    int pendingCount() const { return m_pending.size(); }
+
+signals:
+    void finished(int requestId, int exitCode, const QByteArray &standardOutput,
+                  const QByteArray &standardError);
+    void failed(int requestId, const QString &error);
+
+private:
+    struct Request {
+        int id = 0;
+        QStringList argv;
+        QString workingDirectory;
+    };
+
+    struct Worker {
+        QProcess *process = nullptr;
+        bool ready = false;
+        int requestId = 0;
+        int failures = 0; // Exits since the last answered request
+        QByteArray buffer;
+    };
+
+    QString m_name;
+    Config m_config;
+    QList<Worker> m_workers;
+    QQueue<Request> m_pending;
+
+    void startWorker(int slot);
+    void stopWorker(int slot);
+    void workerExited(int slot, const QString &reason);
+    void readResponses(int slot);
+    void dispatch();
+    bool hasLiveWorker() const;
+};
+
+#endif // INTERPRETERPOOL_H
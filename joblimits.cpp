@@ -0,0 +1,28 @@
+#include "joblimits.h"
+#include <QJsonArray>
+
+bool JobLimits::isEmpty() const
+{
+    return timeoutMs == 0 && !hasChildLimits();
+}
+
+bool JobLimits::hasChildLimits() const
+{
+    return cpuSeconds > 0 || memoryBytes > 0 || niceness != 0 || maxOpenFiles > 0 || !cpuAffinity.isEmpty();
+}
+
+JobLimits JobLimits::fromJson(const QJsonObject &object)
+{
+    JobLimits limits;
+    limits.timeoutMs = qMax<qint64>(0, qint64(object.value("timeout_sec").toDouble() * 1000));
+    if (object.contains("kill_grace_sec"))
+        limits.killGraceMs = qMax<qint64>(0, qint64(object.value("kill_grace_sec").toDouble() * 1000));
+    limits.cpuSeconds = qMax<qint64>(0, object.value("cpu_sec").toInteger());
+    limits.memoryBytes = qMax<qint64>(0, object.value("memory_mb").toInteger()) * 1024 * 1024;
+    limits.niceness = qBound(-20, object.value("nice").toInt(), 19);
+    limits.maxOpenFiles = qMax(0, object.value("max_open_files").toInt());
+    for (const QJsonValue &cpu : object.value("cpu_affinity").toArray()) {
+        if (cpu.toInt(-1) >= 0) limits.cpuAffinity.append(cpu.toInt());
+    }
+    return limits;
+}
@@ -0,0 +1,28 @@
+#ifndef JOBLIMITS_H
+#define JOBLIMITS_H
+
+#include <QJsonObject>
+#include <QList>
+
+// Resource limits of one job, from an action's "limits" object:
+//   "timeout_sec", "kill_grace_sec", "cpu_sec", "memory_mb", "nice",
+//   "max_open_files", "cpu_affinity": [0, 1]
+// Zero means unlimited. The timeout is enforced by JobScheduler on every
+// platform; the rest are applied in the child before exec on Linux.
+struct JobLimits
+{
+    qint64 timeoutMs = 0;
+    qint64 killGraceMs = 3000; // SIGTERM -> SIGKILL
+    qint64 cpuSeconds = 0;
+    qint64 memoryBytes = 0;    // Address space cap
+    int niceness = 0;
+    int maxOpenFiles = 0;
+    QList<int> cpuAffinity;
+
+    bool isEmpty() const;
+    bool hasChildLimits() const; // Anything applied at spawn
+
+    static JobLimits fromJson(const QJsonObject &object);
+};
+
+#endif // JOBLIMITS_H
@@ -0,0 +1,151 @@
+#include "joboutputmodel.h"
+#include "jobscheduler.h"
+
+// Upper bound on how often new output reaches the view (~30 Hz)
+static const int RefreshIntervalMs = 33;
+
+JobOutputModel::JobOutputModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(RefreshIntervalMs);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &JobOutputModel::refresh);
+}
+
+int JobOutputModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_lines.size();
+}
+
+QVariant JobOutputModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_lines.size()) return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case TextRole:
+        return m_lines.at(index.row());
+    case LineNumberRole:
+        return m_firstLine + index.row() + 1;
+    }
+    return QVariant();
+}
+
+QHash<int, QByteArray> JobOutputModel::roleNames() const
+{
+    return {
+        { TextRole, "text" },
+        { LineNumberRole, "lineNumber" }
+    };
+}
+
+JobScheduler *JobOutputModel::scheduler() const { return m_scheduler; }
+int JobOutputModel::jobId() const { return m_jobId; }
+JobOutputModel::Channel JobOutputModel::channel() const { return m_channel; }
+int JobOutputModel::maxLines() const { return m_maxLines; }
+qint64 JobOutputModel::totalBytes() const { return m_totalBytes; }
+bool JobOutputModel::truncated() const { return m_truncated; }
+
+void JobOutputModel::setScheduler(JobScheduler *scheduler)
+{
+    if (m_scheduler == scheduler) return;
+    if (m_scheduler) m_scheduler->disconnect(this);
+    m_scheduler = scheduler;
+
+    if (m_scheduler) {
+        auto schedule = [this](int jobId) {
+            if (jobId == m_jobId && !m_refreshTimer.isActive()) m_refreshTimer.start();
+        };
+        connect(m_scheduler, &JobScheduler::jobOutput, this, schedule);
+        // Picks up the trailing line that has no newline
+        connect(m_scheduler, &JobScheduler::jobFinished, this,
+                [schedule](int jobId, int, QProcess::ExitStatus) { schedule(jobId); });
+    }
+
+    emit schedulerChanged();
+    reset();
+}
+
+void JobOutputModel::setJobId(int jobId)
+{
+    if (m_jobId == jobId) return;
+    m_jobId = jobId;
+    emit jobIdChanged();
+    reset();
+}
+
+void JobOutputModel::setChannel(Channel channel)
+{
+    if (m_channel == channel) return;
+    m_channel = channel;
+    emit channelChanged();
+    reset();
+}
+
+void JobOutputModel::setMaxLines(int maxLines)
+{
+    maxLines = qMax(1, maxLines);
+    if (m_maxLines == maxLines) return;
+    m_maxLines = maxLines;
+    emit maxLinesChanged();
+    reset();
+}
+
+QString JobOutputModel::text() const
+{
+    return m_lines.join('\n');
+}
+
+void JobOutputModel::reset()
+{
+    beginResetModel();
+    m_lines.clear();
+    m_firstLine = 0;
+    m_nextLine = 0;
+    m_totalBytes = 0;
+    m_truncated = false;
+    endResetModel();
+
+    refresh();
+}
+
+void JobOutputModel::refresh()
+{
+    if (!m_scheduler || m_jobId <= 0) return;
+
+    const auto output = m_scheduler->output(m_jobId);
+    if (!output) return;
+
+    const OutputBuffer &buffer = m_channel == StandardOutput
+        ? output->standardOutput : output->standardError;
+
+    // Only the last m_maxLines lines matter, skip anything older
+    const qint64 first = qMax(m_nextLine, buffer.lineCount() - m_maxLines);
+    const QStringList fresh = buffer.lines(first, m_maxLines);
+
+    if (first != m_nextLine || buffer.firstAvailableLine() > m_nextLine
+        || fresh.size() >= m_maxLines) {
+        // Fell behind by more than a screen - replace everything
+        beginResetModel();
+        m_lines = fresh;
+        m_firstLine = buffer.lineCount() - fresh.size();
+        endResetModel();
+    } else if (!fresh.isEmpty()) {
+        const int overflow = m_lines.size() + fresh.size() - m_maxLines;
+        if (overflow > 0) {
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+            m_lines.erase(m_lines.begin(), m_lines.begin() + overflow);
+            m_firstLine += overflow;
+            endRemoveRows();
+        }
+
+        beginInsertRows(QModelIndex(), m_lines.size(), m_lines.size() + fresh.size() - 1);
+        m_lines.append(fresh);
+        endInsertRows();
+    }
+
+    m_nextLine = buffer.lineCount();
+    m_totalBytes = buffer.totalBytes();
+    m_truncated = buffer.truncated();
+    emit outputChanged();
+}
@@ -0,0 +1,82 @@
+#ifndef JOBOUTPUTMODEL_H
+#define JOBOUTPUTMODEL_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QtQml/qqmlregistration.h>
+
+class JobScheduler;
+Q_MOC_INCLUDE("jobscheduler.h")
+
+// Exposes the last maxLines lines of one job's output to QML. Updates are
+// coalesced on a short timer so a chatty child never floods the UI thread
+// with model changes, and only the new lines are inserted.
+class JobOutputModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(JobScheduler *scheduler READ scheduler WRITE setScheduler NOTIFY schedulerChanged)
+    Q_PROPERTY(int jobId READ jobId WRITE setJobId NOTIFY jobIdChanged)
+    Q_PROPERTY(Channel channel READ channel WRITE setChannel NOTIFY channelChanged)
+    Q_PROPERTY(int maxLines READ maxLines WRITE setMaxLines NOTIFY maxLinesChanged)
+    Q_PROPERTY(qint64 totalBytes READ totalBytes NOTIFY outputChanged)
+    Q_PROPERTY(bool truncated READ truncated NOTIFY outputChanged)
+
+public:
+    enum Channel {
+        StandardOutput,
+        StandardError
+    };
+    Q_ENUM(Channel)
+
+    enum Roles {
+        TextRole = Qt::UserRole + 1,
+        LineNumberRole
+    };
+
+    explicit JobOutputModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    JobScheduler *scheduler() const;
+    void setScheduler(JobScheduler *scheduler);
+    int jobId() const;
+    void setJobId(int jobId);
+    Channel channel() const;
+    void setChannel(Channel channel);
+    int maxLines() const;
+    void setMaxLines(int maxLines);
+    qint64 totalBytes() const;
+    bool truncated() const;
+
+    Q_INVOKABLE QString text() const;
+
+signals:
+    void schedulerChanged();
+    void jobIdChanged();
+    void channelChanged();
+    void maxLinesChanged();
+    void outputChanged();
+
+private:
+    QPointer<JobScheduler> m_scheduler;
+    int m_jobId = 0;
+    Channel m_channel = StandardOutput;
+    int m_maxLines = 200;
+
+    QStringList m_lines;
+    qint64 m_firstLine = 0; // Line number of m_lines.first()
+    qint64 m_nextLine = 0;  // Next line number to fetch
+    qint64 m_totalBytes = 0;
+    bool m_truncated = false;
+    QTimer m_refreshTimer;
+
+    void reset();
+    void refresh();
+};
+
+#endif // JOBOUTPUTMODEL_H
@@ -0,0 +1,451 @@
+#include "jobscheduler.h"
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+
+#include <limits>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Finished jobs whose output stays queryable
+static const int RetainedOutputCount = 32;
+
+#ifdef Q_OS_LINUX
+// Everything is prepared here in the parent: the modifier runs between
+// fork and exec, where only plain system calls are safe
+static void applyChildLimits(QProcess *process, const JobLimits &limits)
+{
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    for (int cpu : limits.cpuAffinity) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &affinity);
+    }
+    const bool setAffinity = !limits.cpuAffinity.isEmpty();
+    const rlim_t cpuSeconds = rlim_t(limits.cpuSeconds);
+    const rlim_t memoryBytes = rlim_t(limits.memoryBytes);
+    const rlim_t openFiles = rlim_t(limits.maxOpenFiles);
+    const int niceness = limits.niceness;
+
+    process->setChildProcessModifier([=]() {
+        if (cpuSeconds) {
+            // SIGXCPU at the soft limit, SIGKILL a little later
+            const rlimit limit { cpuSeconds, cpuSeconds + 5 };
+            setrlimit(RLIMIT_CPU, &limit);
+        }
+        if (memoryBytes) {
+            const rlimit limit { memoryBytes, memoryBytes };
+            setrlimit(RLIMIT_AS, &limit);
+        }
+        if (openFiles) {
+            const rlimit limit { openFiles, openFiles };
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+        if (niceness) setpriority(PRIO_PROCESS, 0, niceness);
+        if (setAffinity) sched_setaffinity(0, sizeof(affinity), &affinity);
+    });
+}
+#endif
+
+JobScheduler::JobScheduler(QObject *parent)
+    : QObject(parent)
+    , m_maxConcurrency(qMax(1, QThread::idealThreadCount()))
+{
+}
+
+JobScheduler::~JobScheduler()
+{
+    // Don't leave children running behind a destroyed scheduler
+    for (Job &job : m_jobs) {
+        if (!job.process) continue;
+        job.process->disconnect(this);
+        job.process->kill();
+        job.process->waitForFinished(1000);
+    }
+}
+
+int JobScheduler::submit(const JobSpec &spec)
+{
+    Job job;
+    job.id = m_nextId++;
+    job.spec = spec;
+
+    m_jobs.insert(job.id, job);
+    m_queue.enqueue(job.id);
+
+    emit jobQueued(job.id);
+    emit queueChanged();
+    scheduleDispatch();
+    return job.id;
+}
+
+int JobScheduler::submitCommand(const QString &command, const QString &tag)
+{
+    QStringList parts = QProcess::splitCommand(command);
+    if (parts.isEmpty()) {
+        qWarning() << "Empty command submitted to job scheduler";
+        return 0;
+    }
+
+    JobSpec spec;
+    spec.program = parts.takeFirst();
+    spec.arguments = parts;
+    spec.tag = tag;
+    return submit(spec);
+}
+
+bool JobScheduler::cancel(int jobId)
+{
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end() || it->canceled) return false;
+
+    if (it->pool) {
+        // Pooled scripts run in-process on the worker; it is replaced
+        it->pool->cancel(jobId);
+        releaseJob(jobId);
+        emit jobCanceled(jobId);
+        emit queueChanged();
+        scheduleDispatch();
+        return true;
+    }
+
+    if (!it->process) {
+        // Still queued - drop it without ever starting
+        m_queue.removeOne(jobId);
+        m_jobs.erase(it);
+        emit jobCanceled(jobId);
+        emit queueChanged();
+        return true;
+    }
+
+    // Running - the finished handler reports the cancellation
+    it->canceled = true;
+    it->process->kill();
+    return true;
+}
+
+void JobScheduler::cancelAll()
+{
+    const QList<int> ids = m_jobs.keys();
+    for (int id : ids) cancel(id);
+}
+
+bool JobScheduler::isActive(int jobId) const
+{
+    return m_jobs.contains(jobId);
+}
+
+QString JobScheduler::commandLine(int jobId) const
+{
+    auto it = m_jobs.constFind(jobId);
+    if (it == m_jobs.constEnd()) return QString();
+    if (it->spec.arguments.isEmpty()) return it->spec.program;
+    return it->spec.program + " " + it->spec.arguments.join(" ");
+}
+
+QString JobScheduler::tag(int jobId) const
+{
+    return m_jobs.value(jobId).spec.tag;
+}
+
+qint64 JobScheduler::processId(int jobId) const
+{
+    auto it = m_jobs.constFind(jobId);
+    if (it == m_jobs.constEnd() || !it->process) return 0;
+    return it->process->processId();
+}
+
+QSharedPointer<const JobScheduler::JobOutput> JobScheduler::output(int jobId) const
+{
+    return m_outputs.value(jobId);
+}
+
+void JobScheduler::configurePools(const QHash<QString, InterpreterPool::Config> &configs)
+{
+    for (auto it = m_pools.begin(); it != m_pools.end();) {
+        auto config = configs.constFind(it.key());
+        if (config != configs.constEnd() && config.value() == it.value()->config()) {
+            ++it;
+            continue;
+        }
+
+        // Jobs still on a replaced pool can't finish there any more
+        InterpreterPool *pool = it.value();
+        it = m_pools.erase(it);
+        QList<int> orphaned;
+        for (const Job &job : std::as_const(m_jobs)) {
+            if (job.pool == pool) orphaned.append(job.id);
+        }
+        for (int jobId : std::as_const(orphaned))
+            failJob(jobId, QString("Interpreter pool '%1' was reconfigured").arg(pool->name()));
+        delete pool;
+    }
+
+    for (auto it = configs.constBegin(); it != configs.constEnd(); ++it) {
+        if (m_pools.contains(it.key())) continue;
+
+        InterpreterPool *pool = new InterpreterPool(it.key(), it.value(), this);
+        connect(pool, &InterpreterPool::finished, this,
+                [this, pool](int jobId, int exitCode, const QByteArray &standardOutput,
+                             const QByteArray &standardError) {
+                    auto job = m_jobs.find(jobId);
+                    if (job == m_jobs.end() || job->pool != pool) return;
+
+                    job->output->standardOutput.append(standardOutput.constData(), standardOutput.size());
+                    job->output->standardError.append(standardError.constData(), standardError.size());
+                    if (!standardOutput.isEmpty() || !standardError.isEmpty()) emit jobOutput(jobId);
+
+                    releaseJob(jobId);
+                    emit jobFinished(jobId, exitCode, QProcess::NormalExit);
+                    emit queueChanged();
+                    scheduleDispatch();
+                });
+        connect(pool, &InterpreterPool::failed, this, [this, pool](int jobId, const QString &error) {
+            auto job = m_jobs.find(jobId);
+            if (job != m_jobs.end() && job->pool == pool) failJob(jobId, error);
+        });
+
+        m_pools.insert(it.key(), pool);
+        qDebug() << "Interpreter pool" << it.key() << "started with" << it.value().size << "workers";
+    }
+}
+
+InterpreterPool *JobScheduler::pool(const QString &name) const
+{
+    return m_pools.value(name);
+}
+
+int JobScheduler::maxConcurrency() const { return m_maxConcurrency; }
+int JobScheduler::runningCount() const { return m_running; }
+int JobScheduler::queuedCount() const { return m_queue.size(); }
+int JobScheduler::outputCapacity() const { return m_outputCapacity; }
+
+void JobScheduler::setOutputCapacity(int bytes)
+{
+    bytes = qMax(4096, bytes);
+    if (m_outputCapacity != bytes) {
+        m_outputCapacity = bytes; // Applies to jobs started from now on
+        emit outputCapacityChanged();
+    }
+}
+
+void JobScheduler::setMaxConcurrency(int max)
+{
+    max = qMax(1, max);
+    if (m_maxConcurrency != max) {
+        m_maxConcurrency = max;
+        emit maxConcurrencyChanged();
+        scheduleDispatch();
+    }
+}
+
+void JobScheduler::scheduleDispatch()
+{
+    if (m_dispatchPending) return;
+    m_dispatchPending = true;
+    QMetaObject::invokeMethod(this, &JobScheduler::dispatch, Qt::QueuedConnection);
+}
+
+void JobScheduler::dispatch()
+{
+    m_dispatchPending = false;
+    bool started = false;
+
+    while (m_running < m_maxConcurrency && !m_queue.isEmpty()) {
+        const int jobId = m_queue.dequeue();
+        auto it = m_jobs.find(jobId);
+        if (it == m_jobs.end()) continue;
+        if (it->spec.pool.isEmpty())
+            startJob(*it);
+        else
+            startPooledJob(*it);
+        started = true;
+    }
+
+    if (started) emit queueChanged();
+}
+
+void JobScheduler::startJob(Job &job)
+{
+    const int jobId = job.id;
+    QProcess *process = new QProcess(this);
+    job.process = process;
+    job.output = QSharedPointer<JobOutput>::create(m_outputCapacity);
+    m_outputs.insert(jobId, job.output);
+    ++m_running;
+
+    if (!job.spec.workingDirectory.isEmpty())
+        process->setWorkingDirectory(job.spec.workingDirectory);
+
+    if (job.spec.limits.hasChildLimits()) {
+#ifdef Q_OS_LINUX
+        applyChildLimits(process, job.spec.limits);
+#else
+        qWarning() << "Resource limits other than the timeout are only applied on Linux, job" << jobId;
+#endif
+    }
+
+    connect(process, &QProcess::started, this, [this, jobId]() {
+        emit jobStarted(jobId);
+    });
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, jobId]() {
+        drainOutput(jobId);
+    });
+
+    connect(process, &QProcess::readyReadStandardError, this, [this, jobId]() {
+        drainOutput(jobId);
+    });
+
+    connect(process, &QProcess::finished, this,
+            [this, jobId](int exitCode, QProcess::ExitStatus exitStatus) {
+                drainOutput(jobId);
+                const bool canceled = m_jobs.value(jobId).canceled;
+                releaseJob(jobId);
+                if (canceled)
+                    emit jobCanceled(jobId);
+                else
+                    emit jobFinished(jobId, exitCode, exitStatus);
+                emit queueChanged();
+                scheduleDispatch();
+            });
+
+    connect(process, &QProcess::errorOccurred, this,
+            [this, jobId, process](QProcess::ProcessError error) {
+                // Crashes and kills are followed by finished(); only a failed
+                // start ends the job here
+                if (error != QProcess::FailedToStart) return;
+                const QString message = process->errorString();
+                releaseJob(jobId);
+                emit jobError(jobId, message);
+                emit queueChanged();
+                scheduleDispatch();
+            });
+
+    process->start(job.spec.program, job.spec.arguments);
+
+    // A failed start is reported from inside start() and has already
+    // released the job, so job may dangle here
+    auto it = m_jobs.find(jobId);
+    if (it != m_jobs.end()) armWatchdog(*it);
+}
+
+void JobScheduler::armWatchdog(Job &job)
+{
+    if (job.spec.limits.timeoutMs <= 0) return;
+
+    const int jobId = job.id;
+    job.watchdog = new QTimer(this);
+    job.watchdog->setSingleShot(true);
+    job.watchdog->setInterval(int(qMin<qint64>(job.spec.limits.timeoutMs, std::numeric_limits<int>::max())));
+    connect(job.watchdog, &QTimer::timeout, this, [this, jobId]() { timeOut(jobId); });
+    job.watchdog->start();
+}
+
+void JobScheduler::timeOut(int jobId)
+{
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) return;
+
+    qWarning() << "Job" << jobId << "timed out after" << it->spec.limits.timeoutMs << "ms";
+    emit jobTimedOut(jobId);
+
+    it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) return;
+
+    if (it->pool) {
+        // The worker is replaced; the script can't be stopped in place
+        it->pool->cancel(jobId);
+        failJob(jobId, QString("Timed out after %1 ms").arg(it->spec.limits.timeoutMs));
+        return;
+    }
+
+    if (it->process) {
+        // Ask first, then make sure; the finished handler reports the job
+        QProcess *process = it->process;
+        process->terminate();
+        QTimer::singleShot(std::chrono::milliseconds(it->spec.limits.killGraceMs), process, [process]() {
+            if (process->state() != QProcess::NotRunning) process->kill();
+        });
+    }
+}
+
+void JobScheduler::startPooledJob(Job &job)
+{
+    const int jobId = job.id;
+    InterpreterPool *pool = m_pools.value(job.spec.pool);
+    job.output = QSharedPointer<JobOutput>::create(m_outputCapacity);
+    m_outputs.insert(jobId, job.output);
+
+    if (!pool) {
+        // Report from the event loop like a process that failed to start
+        const QString error = QString("Unknown interpreter pool '%1'").arg(job.spec.pool);
+        QMetaObject::invokeMethod(this, [this, jobId, error]() { failJob(jobId, error); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+
+    job.pool = pool;
+    ++m_running;
+    emit jobStarted(jobId);
+    pool->invoke(jobId, QStringList(job.spec.program) + job.spec.arguments, job.spec.workingDirectory);
+
+    // invoke() may already have failed the job
+    auto it = m_jobs.find(jobId);
+    if (it != m_jobs.end()) armWatchdog(*it);
+}
+
+void JobScheduler::failJob(int jobId, const QString &error)
+{
+    if (!m_jobs.contains(jobId)) return;
+    releaseJob(jobId);
+    emit jobError(jobId, error);
+    emit queueChanged();
+    scheduleDispatch();
+}
+
+void JobScheduler::releaseJob(int jobId)
+{
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) return;
+
+    if (it->watchdog) {
+        it->watchdog->stop();
+        it->watchdog->deleteLater();
+    }
+    if (it->process) {
+        it->process->deleteLater();
+        --m_running;
+    } else if (it->pool) {
+        --m_running;
+    }
+    if (it->output) {
+        it->output->standardOutput.finish();
+        it->output->standardError.finish();
+
+        m_retainedOutputs.enqueue(jobId);
+        while (m_retainedOutputs.size() > RetainedOutputCount)
+            m_outputs.remove(m_retainedOutputs.dequeue());
+    }
+    m_jobs.erase(it);
+}
+
+void JobScheduler::drainOutput(int jobId)
+{
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end() || !it->process || !it->output) return;
+
+    QProcess *process = it->process;
+    const QProcess::ProcessChannel channel = process->readChannel();
+
+    process->setReadChannel(QProcess::StandardOutput);
+    qint64 bytes = it->output->standardOutput.readFrom(process);
+    process->setReadChannel(QProcess::StandardError);
+    bytes += it->output->standardError.readFrom(process);
+    process->setReadChannel(channel);
+
+    if (bytes > 0) emit jobOutput(jobId);
+}
@@ -0,0 +1,120 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QHash>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include "outputbuffer.h"
+#include "interpreterpool.h"
+#include "joblimits.h"
+
+class QTimer;
+
+// Runs external processes as numbered jobs. Jobs wait in a FIFO queue and
+// at most maxConcurrency of them run at any time, each on its own QProcess
+// or on a worker of a named interpreter pool. Jobs are started from the
+// event loop, never inside submit(), and every job ends with exactly one of
+// jobFinished, jobError or jobCanceled. A job past its timeout is sent
+// SIGTERM, then SIGKILL after the grace period.
+class JobScheduler : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int maxConcurrency READ maxConcurrency WRITE setMaxConcurrency NOTIFY maxConcurrencyChanged)
+    Q_PROPERTY(int runningCount READ runningCount NOTIFY queueChanged)
+    Q_PROPERTY(int queuedCount READ queuedCount NOTIFY queueChanged)
+    Q_PROPERTY(int outputCapacity READ outputCapacity WRITE setOutputCapacity NOTIFY outputCapacityChanged)
+
+public:
+    struct JobSpec {
+        QString program;
+        QStringList arguments;
+        QString workingDirectory;
+        QString tag; // Free-form owner tag, e.g. the action id
+        QString pool; // Run program + arguments on this interpreter pool
+        JobLimits limits;
+    };
+
+    // Captured output of a job; outlives the job for the last few finished ones
+    struct JobOutput {
+        explicit JobOutput(qsizetype capacity)
+            : standardOutput(capacity), standardError(capacity) {}
+        OutputBuffer standardOutput;
+        OutputBuffer standardError;
+    };
+
+    explicit JobScheduler(QObject *parent = nullptr);
+    ~JobScheduler() override;
+
+    int submit(const JobSpec &spec);
+    Q_INVOKABLE int submitCommand(const QString &command, const QString &tag = QString());
+    Q_INVOKABLE bool cancel(int jobId);
+    Q_INVOKABLE void cancelAll();
+
+    Q_INVOKABLE bool isActive(int jobId) const;
+    Q_INVOKABLE QString commandLine(int jobId) const;
+    Q_INVOKABLE QString tag(int jobId) const;
+    Q_INVOKABLE qint64 processId(int jobId) const; // 0 unless running as a process
+    QSharedPointer<const JobOutput> output(int jobId) const;
+
+    // Pools are matched by name; unchanged configs keep their warm workers
+    void configurePools(const QHash<QString, InterpreterPool::Config> &configs);
+    InterpreterPool *pool(const QString &name) const;
+
+    int maxConcurrency() const;
+    void setMaxConcurrency(int max);
+    int runningCount() const;
+    int queuedCount() const;
+    int outputCapacity() const;
+    void setOutputCapacity(int bytes);
+
+signals:
+    void jobQueued(int jobId);
+    void jobStarted(int jobId);
+    void jobFinished(int jobId, int exitCode, QProcess::ExitStatus exitStatus);
+    void jobError(int jobId, const QString &error);
+    void jobCanceled(int jobId);
+    // The timeout passed; the job is being stopped and ends as usual
+    void jobTimedOut(int jobId);
+    void jobOutput(int jobId);
+    void maxConcurrencyChanged();
+    void queueChanged();
+    void outputCapacityChanged();
+
+private:
+    struct Job {
+        int id = 0;
+        JobSpec spec;
+        QProcess *process = nullptr;
+        InterpreterPool *pool = nullptr; // Set while running on a pool worker
+        QTimer *watchdog = nullptr;
+        QSharedPointer<JobOutput> output;
+        bool canceled = false;
+    };
+
+    QHash<int, Job> m_jobs; // Queued and running jobs
+    QHash<int, QSharedPointer<JobOutput>> m_outputs; // Running and recently finished
+    QQueue<int> m_retainedOutputs;
+    QQueue<int> m_queue;
+    QHash<QString, InterpreterPool *> m_pools;
+    int m_running = 0;
+    int m_nextId = 1;
+    int m_maxConcurrency;
+    bool m_dispatchPending = false;
+    int m_outputCapacity = 256 * 1024;
+
+    void scheduleDispatch();
+    void dispatch();
+    void startJob(Job &job);
+    void startPooledJob(Job &job);
+    void failJob(int jobId, const QString &error);
+    void armWatchdog(Job &job);
+    void timeOut(int jobId);
+    void releaseJob(int jobId);
+    void drainOutput(int jobId);
+};
+
+#endif // JOBSCHEDULER_H
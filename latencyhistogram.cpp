@@ -0,0 +1,77 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+
+int LatencyHistogram::bucketIndex(quint64 value)
+{
+    if (value < LinearBuckets) return int(value);
+
+    const int msb = 63 - int(qCountLeadingZeroBits(value)); // >= 4
+    const int shift = msb - SubBucketBits;
+    const int sub = int((value >> shift) & ((1 << SubBucketBits) - 1));
+    return LinearBuckets + (msb - 4) * (1 << SubBucketBits) + sub;
+}
+
+quint64 LatencyHistogram::bucketLowerBound(int index)
+{
+    if (index < LinearBuckets) return quint64(index);
+
+    const int msb = (index - LinearBuckets) / (1 << SubBucketBits) + 4;
+    const int sub = (index - LinearBuckets) % (1 << SubBucketBits);
+    return quint64((1 << SubBucketBits) + sub) << (msb - SubBucketBits);
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index + 1 >= BucketCount) return ~quint64(0);
+    return bucketLowerBound(index + 1) - 1;
+}
+
+void LatencyHistogram::record(quint64 value)
+{
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    quint64 current = m_max.load(std::memory_order_relaxed);
+    while (value > current
+           && !m_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    const quint64 n = count();
+    return n ? double(sum()) / double(n) : 0.0;
+}
+
+quint64 LatencyHistogram::percentile(double percent) const
+{
+    const quint64 total = count();
+    if (total == 0) return 0;
+
+    const quint64 rank = qMax<quint64>(1, quint64(qBound(0.0, percent, 100.0) / 100.0 * double(total) + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return qMin(bucketUpperBound(i), max());
+    }
+    return max();
+}
+
+quint64 LatencyHistogram::countAtOrBelow(quint64 bound) const
+{
+    // A bucket straddling the bound may hold larger values, so it is left
+    // out; the count never includes a value above the bound
+    quint64 total = 0;
+    for (int i = 0; i < BucketCount && bucketUpperBound(i) <= bound; ++i)
+        total += m_buckets[i].load(std::memory_order_relaxed);
+    return total;
+}
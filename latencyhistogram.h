@@ -0,0 +1,45 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Log-linear histogram in the spirit of HdrHistogram: values below 16 get
+// exact buckets, above that every power of two is split into 8 sub-buckets,
+// so any recorded value is reported within 12.5%. Buckets are atomics, so
+// record() never locks and readers may run on any thread.
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 3;
+    static constexpr int LinearBuckets = 16;
+    static constexpr int BucketCount = LinearBuckets + (64 - 4) * (1 << SubBucketBits);
+
+    void record(quint64 value);
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    quint64 sum() const { return m_sum.load(std::memory_order_relaxed); }
+    quint64 max() const { return m_max.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Upper bound of the bucket holding the given percentile (0..100)
+    quint64 percentile(double percent) const;
+
+    // Cumulative count for Prometheus-style buckets: values in buckets that
+    // end at or below bound. Exact for bucket edges, otherwise it may miss
+    // values just under bound (by at most 12.5%) but never counts one above.
+    quint64 countAtOrBelow(quint64 bound) const;
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketLowerBound(int index);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    std::atomic<quint64> m_buckets[BucketCount] = {};
+    std::atomic<quint64> m_count { 0 };
+    std::atomic<quint64> m_sum { 0 };
+    std::atomic<quint64> m_max { 0 };
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -1,20 +1,156 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
-#include <QQmlContext>
 #include <QDir>
 #include <QDebug>
 #include <QQuickStyle>
 #include <QLibraryInfo>
 
-#include "MousePositionProvider.h"
-#include "SRunner.h"
-#include "SettingsManager.h"
-#include "ActionManager.h"
+#include "qmlsingletons.h"
+#include "headlessrunner.h"
+#include "controlserver.h"
+#include "trace.h"
+
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QQuickWindow>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QScopeGuard>
+#include <cstring>
+#include <cstdio>
+#include <optional>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+// Off unless asked for: QT_LOGGING_RULES="scriptrunner.startup.debug=true"
+Q_LOGGING_CATEGORY(lcStartup, "scriptrunner.startup", QtWarningMsg)
+
+// --run, --list and --batch run without a window or QML engine
+static bool isHeadless(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--run") || !std::strcmp(argv[i], "--list")
+            || !std::strcmp(argv[i], "--batch"))
+            return true;
+    }
+    return false;
+}
+
+// --trace <file> wins over SCRIPTRUNNER_TRACE; read before any Qt object exists
+static QString traceFile(int argc, char *argv[])
+{
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (!std::strcmp(argv[i], "--trace")) return QString::fromLocal8Bit(argv[i + 1]);
+    }
+    return qEnvironmentVariable("SCRIPTRUNNER_TRACE");
+}
+
+static int runHeadless(int argc, char *argv[])
+{
+#ifdef Q_OS_WIN
+    // GUI subsystem binary: borrow the calling console for output
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        std::freopen("CONOUT$", "w", stdout);
+        std::freopen("CONOUT$", "w", stderr);
+    }
+#endif
+
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("ScriptRunner");
+    app.setApplicationName("ScriptRunner");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Run ScriptRunner actions without the GUI.");
+    parser.addHelpOption();
+    parser.addOption({ "run", "Run the action with this id.", "id" });
+    parser.addOption({ "input", "Input value for --run, repeatable.", "key=value" });
+    parser.addOption({ "list", "List actions as id, category, type and name." });
+    parser.addOption({ "batch", "Run one action per line of this file.", "file" });
+    parser.addOption({ "actions", "Actions file to load instead of qml/actions.json.", "file" });
+    parser.addOption({ "verbose", "Print debug messages." });
+    parser.addOption({ "trace", "Write a Chrome trace of this run to this file.", "file" });
+    parser.process(app);
+
+    if (!parser.isSet("verbose")) QLoggingCategory::setFilterRules("*.debug=false");
+
+    ActionManager actionManager;
+    JobScheduler jobScheduler;
+    actionManager.setJobScheduler(&jobScheduler);
+    // Output and exit codes go to the terminal, so nothing is launched detached
+    actionManager.setTrackAllActions(true);
+
+    const QString actionsPath = parser.isSet("actions")
+        ? parser.value("actions")
+        : QDir(QCoreApplication::applicationDirPath()).filePath("qml/actions.json");
+    if (!actionManager.loadActions(actionsPath)) {
+        qCritical().noquote() << "Failed to load actions from" << actionsPath;
+        return 2;
+    }
+
+    HeadlessRunner runner(&actionManager, &jobScheduler);
+    if (parser.isSet("list")) {
+        runner.listActions();
+        return 0;
+    }
+
+    QString error;
+    if (parser.isSet("run")) {
+        QVariantMap inputs;
+        for (const QString &input : parser.values("input")) {
+            if (!HeadlessRunner::parseInput(input, &inputs)) {
+                qCritical().noquote() << "Expected --input key=value, got" << input;
+                return 2;
+            }
+        }
+        if (!runner.enqueue(parser.value("run"), inputs, &error)) {
+            qCritical().noquote() << error;
+            return 2;
+        }
+    }
+    if (parser.isSet("batch") && !runner.enqueueBatch(parser.value("batch"), &error)) {
+        qCritical().noquote() << error;
+        return 2;
+    }
+
+    QObject::connect(&runner, &HeadlessRunner::finished, &app, &QCoreApplication::exit);
+    runner.start();
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    const QString tracePath = traceFile(argc, argv);
+    if (!tracePath.isEmpty()) Trace::start(tracePath);
+    const qint64 mainStartNs = Trace::nowNs();
+    // Written last, after the managers' destructors have flushed
+    const auto traceGuard = qScopeGuard([]() { Trace::finish(); });
+
+    if (isHeadless(argc, argv))
+        return runHeadless(argc, argv);
+
+    QStringList arguments;
+    bool newInstance = false;
+    QString actionsFile; // --actions, as in the headless modes
+    for (int i = 0; i < argc; ++i) {
+        arguments.append(QString::fromLocal8Bit(argv[i]));
+        if (!std::strcmp(argv[i], "--new-instance")) newInstance = true;
+        if (!std::strcmp(argv[i], "--actions") && i + 1 < argc) actionsFile = QString::fromLocal8Bit(argv[i + 1]);
+    }
+
+    // Time to first frame, the number the compiled QML is meant to bring down
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
+    std::optional<TraceSpan> phase(std::in_place, "QGuiApplication", "startup");
     QGuiApplication app(argc, argv);
 
+    // Single instance: a second launch hands its arguments to the first.
+    // QLocalSocket needs the application object for its event dispatcher.
+    if (!newInstance && ControlServer::forwardToRunningInstance(arguments))
+        return 0;
+
     // Application info
     app.setOrganizationName("ScriptRunner");
     app.setApplicationName("ScriptRunner");
@@ -22,49 +158,84 @@ int main(int argc, char *argv[])
     // Optional: set QQuick style
     QQuickStyle::setStyle("Basic");
 
+    phase.emplace("managers", "startup");
+
     // Initialize managers
     SettingsManager settingsManager;
     ActionManager actionManager;
+    JobScheduler jobScheduler;
+
+    actionManager.setJobScheduler(&jobScheduler);
+
+    // Per-action timings; dumped on exit when a metrics file is configured
+    ExecutionTelemetry telemetry(&jobScheduler);
+    const QString metricsFile = qEnvironmentVariable("SCRIPTRUNNER_METRICS_FILE");
+    if (!metricsFile.isEmpty()) {
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &telemetry, [&telemetry, metricsFile]() {
+            telemetry.exportTo(metricsFile);
+        });
+    }
+
+    // Every job's output, searchable after the scheduler has dropped it
+    OutputArchive archive(&jobScheduler, QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                                             + "/archive");
 
     settingsManager.loadSettings();
 
-    // Load actions.json from the qml folder
+    // Load actions.json from the qml folder unless --actions names another file
     QString qmlFolder = QDir(QCoreApplication::applicationDirPath()).filePath("qml");
-    QString actionsPath = QDir(qmlFolder).filePath("actions.json");
+    QString actionsPath = actionsFile.isEmpty() ? QDir(qmlFolder).filePath("actions.json") : actionsFile;
 
     if (!QFile::exists(actionsPath) || !actionManager.loadActions(actionsPath)) {
         qWarning() << "Failed to load actions from:" << actionsPath;
     }
+    actionManager.setWatchEnabled(true);
 
-    QQmlApplicationEngine engine;
+    // "schedule" and "watch" actions; the headless modes never arm these
+    TriggerScheduler triggers(&actionManager);
 
-    // C++ objects
-    SRunner srunner;
-    MousePositionProvider mouseProvider;
+    // Other tools trigger actions on this instance through the socket
+    ControlServer controlServer(&actionManager, &jobScheduler);
+    controlServer.listen();
 
-    // Register type
-    qmlRegisterType<MousePositionProvider>("com.SRunner", 1, 0, "MousePositionProvider");
+    // C++ objects
+    SRunner srunner(&jobScheduler);
+
+    // Singletons of the ScriptRunner QML module; set before anything loads
+    SRunnerSingleton::s_instance = &srunner;
+    SettingsManagerSingleton::s_instance = &settingsManager;
+    ActionManagerSingleton::s_instance = &actionManager;
+    JobSchedulerSingleton::s_instance = &jobScheduler;
+    TelemetrySingleton::s_instance = &telemetry;
+    TriggersSingleton::s_instance = &triggers;
+    ArchiveSingleton::s_instance = &archive;
+
+    phase.emplace("QML load", "startup");
+    QQmlApplicationEngine engine;
 
-    // Expose objects to QML
-    engine.rootContext()->setContextProperty("srunner", &srunner);
-    engine.rootContext()->setContextProperty("mouseProvider", &mouseProvider);
-    engine.rootContext()->setContextProperty("settingsManager", &settingsManager);
-    engine.rootContext()->setContextProperty("actionManager", &actionManager);
+    // Compiled into the binary; the qml folder only holds actions.json and workers
+    engine.loadFromModule("ScriptRunner", "Main");
 
-    // Set import path to only qml folder next to exe
-    engine.addImportPath(qmlFolder);
+    phase.reset();
 
-    // Load Main.qml from the qml folder
-    QString mainQmlPath = QDir(qmlFolder).filePath("Main.qml");
-    if (!QFile::exists(mainQmlPath)) {
-        qCritical() << "Main.qml not found in:" << mainQmlPath;
+    if (engine.rootObjects().isEmpty())
         return -1;
-    }
 
-    engine.load(QUrl::fromLocalFile(mainQmlPath));
+    if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().constFirst())) {
+        QObject::connect(window, &QQuickWindow::frameSwapped, window, [window, startupTimer, mainStartNs]() {
+            qCDebug(lcStartup) << "First frame after" << startupTimer.elapsed() << "ms";
+            Trace::complete("startup", "startup", mainStartNs, Trace::nowNs());
+        }, Qt::SingleShotConnection);
+    }
 
-    if (engine.rootObjects().isEmpty())
-        return -1;
+    QObject::connect(&controlServer, &ControlServer::activateRequested, &engine, [&engine]() {
+        if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().constFirst())) {
+            window->show();
+            window->raise();
+            window->requestActivate();
+        }
+    });
+    controlServer.handleArguments(arguments);
 
     return app.exec();
 }
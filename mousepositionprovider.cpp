@@ -1,17 +1,24 @@
-#include "MousePositionProvider.h"
-#include <QCursor>
-#include <QGuiApplication>
-#include <QScreen>
-#include <QTimer>
+#include "mousepositionprovider.h"
+#include "cursortracker.h"
 
 MousePositionProvider::MousePositionProvider(QObject *parent)
     : QObject(parent)
-    , m_cursorPosition(QCursor::pos())
+    , m_tracker(CursorTracker::instance())
+    , m_cursorPosition(m_tracker->position())
+    , m_active(false)
 {
-    // Set up timer to update cursor position periodically
-    QTimer *timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &MousePositionProvider::updateCursorPosition);
-    timer->start(16); // ~60 FPS
+    connect(m_tracker, &CursorTracker::positionChanged,
+            this, [this](const QPoint &position) {
+                if (m_active) setPosition(position);
+            });
+
+    // Active by default so existing users keep working unchanged
+    setActive(true);
+}
+
+MousePositionProvider::~MousePositionProvider()
+{
+    if (m_tracker) m_tracker->unsubscribe(this);
 }
 
 QPoint MousePositionProvider::cursorPosition() const
@@ -19,11 +26,47 @@ QPoint MousePositionProvider::cursorPosition() const
     return m_cursorPosition;
 }
 
+bool MousePositionProvider::active() const
+{
+    return m_active;
+}
+
+void MousePositionProvider::setActive(bool active)
+{
+    if (m_active == active) return;
+    m_active = active;
+
+    if (m_tracker && m_active) {
+        m_tracker->subscribe(this);
+        setPosition(m_tracker->position());
+    } else if (m_tracker) {
+        m_tracker->unsubscribe(this);
+    }
+    emit activeChanged();
+}
+
+qreal MousePositionProvider::wakeupsPerSecond() const
+{
+    return m_tracker ? m_tracker->wakeupsPerSecond() : 0.0;
+}
+
+int MousePositionProvider::subscriberCount() const
+{
+    return m_tracker ? m_tracker->subscriberCount() : 0;
+}
+
 void MousePositionProvider::updateCursorPosition()
 {
-    QPoint newPos = QCursor::pos();
-    if (m_cursorPosition != newPos) {
-        m_cursorPosition = newPos;
+    // Sample immediately, even when inactive (e.g. at the start of a drag)
+    if (!m_tracker) return;
+    m_tracker->poll();
+    setPosition(m_tracker->position());
+}
+
+void MousePositionProvider::setPosition(const QPoint &position)
+{
+    if (m_cursorPosition != position) {
+        m_cursorPosition = position;
         emit cursorPositionChanged(m_cursorPosition);
     }
 }
@@ -3,25 +3,46 @@
 
 #include <QObject>
 #include <QPoint>
+#include <QPointer>
+#include <QtQml/qqmlregistration.h>
 
+class CursorTracker;
+
+// QML facing view of the shared CursorTracker. Only active providers keep
+// the tracker polling; bind `active` to whatever actually needs the cursor.
 class MousePositionProvider : public QObject
 {
     Q_OBJECT
+    QML_ELEMENT
     Q_PROPERTY(QPoint cursorPosition READ cursorPosition NOTIFY cursorPositionChanged)
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
 
 public:
     explicit MousePositionProvider(QObject *parent = nullptr);
+    ~MousePositionProvider() override;
 
     QPoint cursorPosition() const;
 
+    bool active() const;
+    void setActive(bool active);
+
+    // Instrumentation of the shared tracker
+    Q_INVOKABLE qreal wakeupsPerSecond() const;
+    Q_INVOKABLE int subscriberCount() const;
+
 signals:
     void cursorPositionChanged(const QPoint &cursorPosition);
+    void activeChanged();
 
 public slots:
     void updateCursorPosition();
 
 private:
+    QPointer<CursorTracker> m_tracker; // Gone once the application is
     QPoint m_cursorPosition;
+    bool m_active;
+
+    void setPosition(const QPoint &position);
 };
 
 #endif // MOUSEPOSITIONPROVIDER_H
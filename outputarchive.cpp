@@ -0,0 +1,576 @@
+#include "outputarchive.h"
+#include "jobscheduler.h"
+#include "trace.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSemaphore>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char BlockMagic[4] = { 'S', 'R', 'A', 'B' };
+const qint64 SegmentBytes = 16 * 1024 * 1024;
+const int CompressionLevel = 6;
+const qint64 DayMs = 24 * 3600 * 1000;
+
+enum EntryFlag : quint32 {
+    TruncatedFlag = 0x1, // The scheduler's ring buffer had already dropped the start
+    ErrorFlag = 0x2,     // Failed to start or lost its pool worker
+    CrashedFlag = 0x4
+};
+
+// Followed by the tag and the command line (UTF-8), then the compressed
+// stdout + stderr; the split between them is kept in the index entry
+struct BlockHeader {
+    char magic[4];
+    quint32 tagSize;
+    quint32 commandSize;
+    quint32 payloadSize;
+};
+
+struct IndexEntry {
+    qint64 offset; // Of the block in the .dat file
+    qint64 finishedMs;
+    quint32 blockSize;
+    quint32 stdoutSize;
+    quint32 stderrSize;
+    qint32 exitCode;
+    quint32 tagHash;
+    quint32 flags;
+    qint32 jobId;
+    quint32 durationMs;
+};
+
+static_assert(sizeof(BlockHeader) == 16, "block header layout is part of the file format");
+static_assert(sizeof(IndexEntry) == 48, "index entry layout is part of the file format");
+
+// FNV-1a; qHash is seeded per process and can't go to disk
+quint32 tagHash(const QString &tag)
+{
+    quint32 hash = 2166136261u;
+    const QByteArray utf8 = tag.toUtf8();
+    for (char c : utf8) {
+        hash ^= quint8(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct Block {
+    QString tag;
+    QString command;
+    QByteArray standardOutput;
+    QByteArray standardError;
+};
+
+bool readBlock(QFile *data, const IndexEntry &entry, Block *block, bool withPayload = true)
+{
+    if (!data->seek(entry.offset)) return false;
+    const QByteArray bytes = data->read(entry.blockSize);
+    if (bytes.size() != qsizetype(entry.blockSize) || bytes.size() < qsizetype(sizeof(BlockHeader)))
+        return false;
+
+    BlockHeader header;
+    std::memcpy(&header, bytes.constData(), sizeof(header));
+    if (std::memcmp(header.magic, BlockMagic, sizeof(BlockMagic)) != 0
+        || sizeof(header) + quint64(header.tagSize) + header.commandSize + header.payloadSize != entry.blockSize) {
+        return false;
+    }
+
+    const char *strings = bytes.constData() + sizeof(header);
+    block->tag = QString::fromUtf8(strings, header.tagSize);
+    block->command = QString::fromUtf8(strings + header.tagSize, header.commandSize);
+    if (!withPayload) return true;
+
+    const QByteArray payload = qUncompress(reinterpret_cast<const uchar *>(strings + header.tagSize + header.commandSize),
+                                           qsizetype(header.payloadSize));
+    if (payload.size() != qsizetype(entry.stdoutSize) + entry.stderrSize) return false;
+    block->standardOutput = payload.left(entry.stdoutSize);
+    block->standardError = payload.mid(entry.stdoutSize);
+    return true;
+}
+
+bool matchesEntry(const IndexEntry &entry, const OutputArchive::Query &query, quint32 hash)
+{
+    if (!query.actionId.isEmpty() && entry.tagHash != hash) return false;
+    if (query.from.isValid() && entry.finishedMs < query.from.toMSecsSinceEpoch()) return false;
+    if (query.to.isValid() && entry.finishedMs > query.to.toMSecsSinceEpoch()) return false;
+    if (query.hasExitCode && entry.exitCode != query.exitCode) return false;
+    if (query.failedOnly && entry.exitCode == 0 && !(entry.flags & (ErrorFlag | CrashedFlag))) return false;
+    return true;
+}
+
+// Per scanning thread; QRegularExpression is only reentrant
+class LineMatcher
+{
+public:
+    explicit LineMatcher(const OutputArchive::Query &query)
+        : m_pattern(query.pattern)
+        , m_sensitivity(query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive)
+        , m_useRegex(query.regex)
+    {
+        if (m_useRegex) {
+            m_regex.setPattern(query.pattern);
+            if (!query.caseSensitive) m_regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        } else if (query.caseSensitive) {
+            m_needle = query.pattern.toUtf8();
+        }
+    }
+
+    bool matchesAll() const { return m_pattern.isEmpty(); }
+
+    // Cheap whole-block rejection before splitting into lines
+    bool mayMatch(const QByteArray &text) const
+    {
+        return m_needle.isEmpty() || text.contains(m_needle);
+    }
+
+    bool matches(QByteArrayView line) const
+    {
+        if (!m_needle.isEmpty()) return line.contains(m_needle);
+        const QString text = QString::fromUtf8(line);
+        return m_useRegex ? m_regex.match(text).hasMatch() : text.contains(m_pattern, m_sensitivity);
+    }
+
+private:
+    QString m_pattern;
+    Qt::CaseSensitivity m_sensitivity;
+    bool m_useRegex;
+    QRegularExpression m_regex;
+    QByteArray m_needle;
+};
+
+void matchLines(const QByteArray &text, const QString &stream, const LineMatcher &matcher,
+                const OutputArchive::Hit &base, int limit, QVector<OutputArchive::Hit> *hits)
+{
+    if (!matcher.mayMatch(text)) return;
+
+    qint64 lineNumber = 0;
+    qsizetype start = 0;
+    while (start < text.size() && hits->size() < limit) {
+        qsizetype end = text.indexOf('\n', start);
+        if (end < 0) end = text.size();
+        QByteArrayView line(text.constData() + start, end - start);
+        if (line.endsWith('\r')) line.chop(1);
+
+        if (matcher.matches(line)) {
+            OutputArchive::Hit hit = base;
+            hit.stream = stream;
+            hit.line = lineNumber;
+            hit.text = QString::fromUtf8(line);
+            hits->append(hit);
+        }
+        start = end + 1;
+        ++lineNumber;
+    }
+}
+
+} // namespace
+
+OutputArchive::Query OutputArchive::Query::fromMap(const QVariantMap &map)
+{
+    Query query;
+    query.pattern = map.value("pattern").toString();
+    query.regex = map.value("regex", false).toBool();
+    query.caseSensitive = map.value("caseSensitive", false).toBool();
+    query.actionId = map.value("actionId").toString();
+    query.from = map.value("from").toDateTime();
+    query.to = map.value("to").toDateTime();
+    query.hasExitCode = map.contains("exitCode");
+    query.exitCode = map.value("exitCode").toInt();
+    query.failedOnly = map.value("failed", false).toBool();
+    query.limit = qMax(1, map.value("limit", 100).toInt());
+    return query;
+}
+
+QVariantMap OutputArchive::Hit::toMap() const
+{
+    return {
+        { "segment", segment },
+        { "entry", entry },
+        { "actionId", actionId },
+        { "command", command },
+        { "finished", finished },
+        { "exitCode", exitCode },
+        { "stream", stream },
+        { "line", line },
+        { "text", text }
+    };
+}
+
+OutputArchive::OutputArchive(JobScheduler *scheduler, const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_scheduler(scheduler)
+    , m_directory(directory)
+{
+    // One writer keeps blocks and index entries in order
+    m_writer.setMaxThreadCount(1);
+    m_searches.setMaxThreadCount(2);
+
+    m_writer.start([this]() { openArchive(); });
+
+    // The scheduler drops tag and command line before a job's end is reported
+    connect(m_scheduler, &JobScheduler::jobQueued, this, [this](int jobId) {
+        m_pending.insert(jobId, { m_scheduler->tag(jobId), m_scheduler->commandLine(jobId), 0 });
+    });
+    connect(m_scheduler, &JobScheduler::jobStarted, this, [this](int jobId) {
+        auto it = m_pending.find(jobId);
+        if (it != m_pending.end()) it->startedAt = QDateTime::currentMSecsSinceEpoch();
+    });
+    connect(m_scheduler, &JobScheduler::jobFinished, this,
+            [this](int jobId, int exitCode, QProcess::ExitStatus exitStatus) {
+                archive(jobId, exitCode, exitStatus == QProcess::CrashExit ? CrashedFlag : 0);
+            });
+    connect(m_scheduler, &JobScheduler::jobError, this, [this](int jobId) {
+        archive(jobId, -1, ErrorFlag);
+    });
+    connect(m_scheduler, &JobScheduler::jobCanceled, this, [this](int jobId) {
+        m_pending.remove(jobId);
+    });
+}
+
+OutputArchive::~OutputArchive()
+{
+    m_searches.waitForDone();
+    m_scanPool.waitForDone();
+    m_writer.start([this]() { closeSegment(); });
+    m_writer.waitForDone();
+}
+
+void OutputArchive::archive(int jobId, int exitCode, quint32 flags)
+{
+    const Pending pending = m_pending.take(jobId);
+    const QSharedPointer<const JobScheduler::JobOutput> output = m_scheduler->output(jobId);
+
+    Record record;
+    record.tag = pending.tag;
+    record.command = pending.command;
+    record.finishedMs = QDateTime::currentMSecsSinceEpoch();
+    record.durationMs = pending.startedAt ? record.finishedMs - pending.startedAt : 0;
+    record.exitCode = exitCode;
+    record.jobId = jobId;
+    record.flags = flags;
+    if (output) {
+        record.standardOutput = output->standardOutput.contents();
+        record.standardError = output->standardError.contents();
+        if (output->standardOutput.truncated() || output->standardError.truncated()) record.flags |= TruncatedFlag;
+    }
+
+    // Compression and disk I/O stay off the UI thread
+    m_writer.start([this, record]() { write(record); });
+}
+
+QString OutputArchive::dataPath(int segment) const
+{
+    return m_directory + QString("/%1.dat").arg(segment, 8, 10, QChar('0'));
+}
+
+QString OutputArchive::indexPath(int segment) const
+{
+    return m_directory + QString("/%1.idx").arg(segment, 8, 10, QChar('0'));
+}
+
+QVector<int> OutputArchive::segments() const
+{
+    QVector<int> numbers;
+    const QStringList names = QDir(m_directory).entryList({ "*.idx" }, QDir::Files);
+    for (const QString &name : names) {
+        bool ok = false;
+        const int number = QFileInfo(name).completeBaseName().toInt(&ok);
+        if (ok && number > 0) numbers.append(number);
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+void OutputArchive::openArchive()
+{
+    if (m_opened) return;
+    m_opened = true;
+
+    if (!QDir().mkpath(m_directory)) {
+        qWarning() << "Could not create output archive" << m_directory;
+        return;
+    }
+
+    qint64 total = 0;
+    const QVector<int> existing = segments();
+    for (int segment : existing)
+        total += QFileInfo(dataPath(segment)).size() + QFileInfo(indexPath(segment)).size();
+    m_sizeBytes.store(total, std::memory_order_relaxed);
+
+    // Keep appending to the last segment until it is full
+    startSegment(existing.isEmpty() ? 1 : existing.constLast());
+    enforceRetention();
+}
+
+bool OutputArchive::startSegment(int segment)
+{
+    closeSegment();
+    m_segment = segment;
+
+    // A crash between block and index write leaves a partial entry; the
+    // orphaned block is harmless, nothing points at it
+    const QString index = indexPath(segment);
+    const qint64 indexSize = QFileInfo(index).size();
+    if (indexSize % qint64(sizeof(IndexEntry)) != 0) {
+        const qint64 valid = indexSize - indexSize % qint64(sizeof(IndexEntry));
+        QFile::resize(index, valid);
+        m_sizeBytes.fetch_sub(indexSize - valid, std::memory_order_relaxed);
+    }
+
+    m_data = std::make_unique<QFile>(dataPath(segment));
+    m_index = std::make_unique<QFile>(index);
+    if (!m_data->open(QIODevice::WriteOnly | QIODevice::Append)
+        || !m_index->open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Could not open archive segment" << dataPath(segment) << m_data->errorString();
+        closeSegment();
+        return false;
+    }
+    return true;
+}
+
+void OutputArchive::closeSegment()
+{
+    m_data.reset();
+    m_index.reset();
+}
+
+void OutputArchive::write(const Record &record)
+{
+    TRACE_SCOPE("archive write", "archive");
+    openArchive();
+    if (!m_data || m_data->size() >= SegmentBytes) {
+        if (!startSegment(m_segment + 1)) return;
+    }
+
+    const QByteArray tag = record.tag.toUtf8();
+    const QByteArray command = record.command.toUtf8();
+    const QByteArray payload = qCompress(record.standardOutput + record.standardError, CompressionLevel);
+
+    BlockHeader header;
+    std::memcpy(header.magic, BlockMagic, sizeof(BlockMagic));
+    header.tagSize = quint32(tag.size());
+    header.commandSize = quint32(command.size());
+    header.payloadSize = quint32(payload.size());
+
+    QByteArray block(reinterpret_cast<const char *>(&header), sizeof(header));
+    block.reserve(sizeof(header) + tag.size() + command.size() + payload.size());
+    block += tag;
+    block += command;
+    block += payload;
+
+    IndexEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.offset = m_data->size();
+    entry.finishedMs = record.finishedMs;
+    entry.blockSize = quint32(block.size());
+    entry.stdoutSize = quint32(record.standardOutput.size());
+    entry.stderrSize = quint32(record.standardError.size());
+    entry.exitCode = record.exitCode;
+    entry.tagHash = tagHash(record.tag);
+    entry.flags = record.flags;
+    entry.jobId = record.jobId;
+    entry.durationMs = quint32(qBound<qint64>(0, record.durationMs, std::numeric_limits<quint32>::max()));
+
+    // Block first: an index entry never points past the data
+    if (m_data->write(block) != block.size() || !m_data->flush()
+        || m_index->write(reinterpret_cast<const char *>(&entry), sizeof(entry)) != qint64(sizeof(entry))
+        || !m_index->flush()) {
+        qWarning() << "Could not write to output archive" << dataPath(m_segment);
+        return;
+    }
+
+    m_sizeBytes.fetch_add(block.size() + qint64(sizeof(entry)), std::memory_order_relaxed);
+    enforceRetention();
+    QMetaObject::invokeMethod(this, &OutputArchive::sizeChanged, Qt::QueuedConnection);
+}
+
+void OutputArchive::enforceRetention()
+{
+    const qint64 maxSize = m_maxSizeBytes.load(std::memory_order_relaxed);
+    const int maxAge = m_maxAgeDays.load(std::memory_order_relaxed);
+    const qint64 oldest = QDateTime::currentMSecsSinceEpoch() - maxAge * DayMs;
+
+    // Whole segments go, oldest first; the one being written stays
+    for (int segment : segments()) {
+        if (segment >= m_segment) break;
+
+        const QFileInfo index(indexPath(segment));
+        const bool tooBig = maxSize > 0 && m_sizeBytes.load(std::memory_order_relaxed) > maxSize;
+        const bool tooOld = maxAge > 0 && index.lastModified().toMSecsSinceEpoch() < oldest;
+        if (!tooBig && !tooOld) break;
+
+        const qint64 size = QFileInfo(dataPath(segment)).size() + index.size();
+        // A search may still have it open; on Windows it goes next time
+        if (!QFile::remove(indexPath(segment))) break;
+        QFile::remove(dataPath(segment));
+        m_sizeBytes.fetch_sub(size, std::memory_order_relaxed);
+        qDebug() << "Output archive segment" << segment << "removed," << (tooOld ? "expired" : "over size");
+    }
+}
+
+void OutputArchive::setMaxSizeBytes(qint64 bytes)
+{
+    if (m_maxSizeBytes.exchange(bytes) == bytes) return;
+    m_writer.start([this]() { enforceRetention(); });
+    emit retentionChanged();
+}
+
+void OutputArchive::setMaxAgeDays(int days)
+{
+    if (m_maxAgeDays.exchange(days) == days) return;
+    m_writer.start([this]() { enforceRetention(); });
+    emit retentionChanged();
+}
+
+QVector<OutputArchive::Hit> OutputArchive::scanSegment(int segment, const Query &query) const
+{
+    QVector<Hit> hits;
+    QFile index(indexPath(segment));
+    QFile data(dataPath(segment));
+    if (!index.open(QIODevice::ReadOnly) || !data.open(QIODevice::ReadOnly)) return hits;
+
+    // Entries written after this point are picked up by the next search
+    const qint64 count = index.size() / qint64(sizeof(IndexEntry));
+    if (count == 0) return hits;
+    const uchar *entries = index.map(0, count * qint64(sizeof(IndexEntry)));
+    if (!entries) return hits;
+
+    const quint32 hash = tagHash(query.actionId);
+    const LineMatcher matcher(query);
+
+    // Newest first
+    for (qint64 i = count - 1; i >= 0 && hits.size() < query.limit; --i) {
+        IndexEntry entry;
+        std::memcpy(&entry, entries + i * qint64(sizeof(IndexEntry)), sizeof(entry));
+        if (!matchesEntry(entry, query, hash)) continue;
+
+        Block block;
+        if (!readBlock(&data, entry, &block, !matcher.matchesAll())) continue;
+        if (!query.actionId.isEmpty() && block.tag != query.actionId) continue;
+
+        Hit base;
+        base.segment = segment;
+        base.entry = i;
+        base.actionId = block.tag;
+        base.command = block.command;
+        base.finished = QDateTime::fromMSecsSinceEpoch(entry.finishedMs);
+        base.exitCode = entry.exitCode;
+
+        if (matcher.matchesAll()) {
+            hits.append(base);
+            continue;
+        }
+        matchLines(block.standardOutput, "stdout", matcher, base, query.limit, &hits);
+        matchLines(block.standardError, "stderr", matcher, base, query.limit, &hits);
+    }
+    return hits;
+}
+
+QVector<OutputArchive::Hit> OutputArchive::search(const Query &query) const
+{
+    TRACE_SCOPE("archive search", "archive");
+    QVector<int> numbers = segments();
+    std::reverse(numbers.begin(), numbers.end()); // Newest segments get the first threads
+
+    // Each segment collects up to the limit on its own, newest entries
+    // first. Segments are written in order, so an older one is only
+    // skipped once the newer ones have filled the limit between them.
+    QMutex mutex;
+    QSemaphore done;
+    QVector<QVector<Hit>> results(numbers.size());
+    QVector<bool> scanned(numbers.size(), false);
+
+    const auto newerFull = [&](int position) {
+        qsizetype newer = 0;
+        for (int i = 0; i < position; ++i) {
+            if (!scanned.at(i)) return false;
+            newer += results.at(i).size();
+        }
+        return newer >= query.limit;
+    };
+
+    for (int position = 0; position < numbers.size(); ++position) {
+        const int segment = numbers.at(position);
+        m_scanPool.start([&, position, segment]() {
+            bool skip;
+            {
+                QMutexLocker locker(&mutex);
+                skip = newerFull(position);
+            }
+            QVector<Hit> local;
+            if (!skip) {
+                TRACE_SCOPE("archive scan segment", "archive");
+                local = scanSegment(segment, query);
+            }
+            {
+                QMutexLocker locker(&mutex);
+                results[position] = std::move(local);
+                scanned[position] = true;
+            }
+            done.release();
+        });
+    }
+    done.acquire(numbers.size());
+
+    // Merge newest first, then trim to the limit
+    QVector<Hit> hits;
+    for (const QVector<Hit> &local : std::as_const(results)) hits += local;
+    std::stable_sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) {
+        if (a.finished != b.finished) return a.finished > b.finished;
+        if (a.stream != b.stream) return a.stream > b.stream; // stdout before stderr
+        return a.line < b.line;
+    });
+    if (hits.size() > query.limit) hits.resize(query.limit);
+    return hits;
+}
+
+int OutputArchive::searchAsync(const QVariantMap &map)
+{
+    const int searchId = m_nextSearchId++;
+    const Query query = Query::fromMap(map);
+
+    m_searches.start([this, searchId, query]() {
+        QVariantList results;
+        for (const Hit &hit : search(query)) results.append(hit.toMap());
+        QMetaObject::invokeMethod(this, [this, searchId, results]() {
+            emit searchFinished(searchId, results);
+        }, Qt::QueuedConnection);
+    });
+    return searchId;
+}
+
+QVariantMap OutputArchive::entry(int segment, qint64 entry) const
+{
+    QFile index(indexPath(segment));
+    QFile data(dataPath(segment));
+    if (!index.open(QIODevice::ReadOnly) || !data.open(QIODevice::ReadOnly)) return QVariantMap();
+
+    IndexEntry indexEntry;
+    if (entry < 0 || !index.seek(entry * qint64(sizeof(IndexEntry)))
+        || index.read(reinterpret_cast<char *>(&indexEntry), sizeof(indexEntry)) != qint64(sizeof(indexEntry))) {
+        return QVariantMap();
+    }
+
+    Block block;
+    if (!readBlock(&data, indexEntry, &block)) return QVariantMap();
+
+    return {
+        { "actionId", block.tag },
+        { "command", block.command },
+        { "finished", QDateTime::fromMSecsSinceEpoch(indexEntry.finishedMs) },
+        { "durationMs", indexEntry.durationMs },
+        { "exitCode", indexEntry.exitCode },
+        { "jobId", indexEntry.jobId },
+        { "truncated", bool(indexEntry.flags & TruncatedFlag) },
+        { "stdout", QString::fromUtf8(block.standardOutput) },
+        { "stderr", QString::fromUtf8(block.standardError) }
+    };
+}
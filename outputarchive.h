@@ -0,0 +1,139 @@
+#ifndef OUTPUTARCHIVE_H
+#define OUTPUTARCHIVE_H
+
+#include <QObject>
+#include <QtQml/qqmlregistration.h>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QThreadPool>
+#include <QVariantList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+class JobScheduler;
+class QFile;
+
+// Output of every finished job, kept on disk after the scheduler has let
+// go of it. The archive directory holds numbered segments: a .dat file of
+// blocks (tag, command line and the zlib-compressed stdout + stderr) and a
+// .idx file of fixed-size entries with the block offset, action id hash,
+// finish time and exit code. Writes happen on a background thread; a
+// segment is closed at SegmentBytes, and whole segments are dropped once
+// the archive passes maxSizeBytes or is older than maxAgeDays. Searches
+// filter on the memory-mapped indexes first, then scan one segment per
+// thread and decompress one block at a time, so the archive is never
+// loaded into memory.
+class OutputArchive : public QObject
+{
+    Q_OBJECT
+    QML_ANONYMOUS
+    Q_PROPERTY(qint64 sizeBytes READ sizeBytes NOTIFY sizeChanged)
+    Q_PROPERTY(qint64 maxSizeBytes READ maxSizeBytes WRITE setMaxSizeBytes NOTIFY retentionChanged)
+    Q_PROPERTY(int maxAgeDays READ maxAgeDays WRITE setMaxAgeDays NOTIFY retentionChanged)
+
+public:
+    // An empty pattern matches every run that passes the filters
+    struct Query {
+        QString pattern;
+        bool regex = false;
+        bool caseSensitive = false;
+        QString actionId;
+        QDateTime from;
+        QDateTime to;
+        bool hasExitCode = false;
+        int exitCode = 0;
+        bool failedOnly = false;
+        int limit = 100;
+
+        static Query fromMap(const QVariantMap &map);
+    };
+
+    struct Hit {
+        int segment = 0;
+        qint64 entry = 0; // Index within the segment, for entry()
+        QString actionId;
+        QString command;
+        QDateTime finished;
+        int exitCode = 0;
+        QString stream;   // "stdout" or "stderr", empty for a run without pattern
+        qint64 line = -1; // Line number within the stream
+        QString text;
+
+        QVariantMap toMap() const;
+    };
+
+    OutputArchive(JobScheduler *scheduler, const QString &directory, QObject *parent = nullptr);
+    ~OutputArchive() override;
+
+    // Newest first, up to query.limit hits; blocks until all segments are scanned
+    QVector<Hit> search(const Query &query) const;
+    // Same on a background thread; answered by searchFinished
+    Q_INVOKABLE int searchAsync(const QVariantMap &query);
+    // A whole archived run: actionId, command, finished, exitCode, stdout, stderr
+    Q_INVOKABLE QVariantMap entry(int segment, qint64 entry) const;
+
+    qint64 sizeBytes() const { return m_sizeBytes.load(std::memory_order_relaxed); }
+    qint64 maxSizeBytes() const { return m_maxSizeBytes.load(std::memory_order_relaxed); }
+    void setMaxSizeBytes(qint64 bytes);
+    int maxAgeDays() const { return m_maxAgeDays.load(std::memory_order_relaxed); }
+    void setMaxAgeDays(int days);
+
+signals:
+    void sizeChanged();
+    void retentionChanged();
+    void searchFinished(int searchId, const QVariantList &hits);
+
+private:
+    struct Pending {
+        QString tag;
+        QString command;
+        qint64 startedAt = 0;
+    };
+
+    struct Record {
+        QString tag;
+        QString command;
+        QByteArray standardOutput;
+        QByteArray standardError;
+        qint64 finishedMs = 0;
+        qint64 durationMs = 0;
+        int exitCode = 0;
+        int jobId = 0;
+        quint32 flags = 0;
+    };
+
+    JobScheduler *m_scheduler;
+    QString m_directory;
+    QHash<int, Pending> m_pending; // Job id -> what the scheduler forgets at finish
+    int m_nextSearchId = 1;
+
+    std::atomic<qint64> m_sizeBytes { 0 };
+    std::atomic<qint64> m_maxSizeBytes { 512 * 1024 * 1024 };
+    std::atomic<int> m_maxAgeDays { 30 };
+
+    // Writer thread only
+    QThreadPool m_writer;
+    bool m_opened = false;
+    int m_segment = 0;
+    std::unique_ptr<QFile> m_data;
+    std::unique_ptr<QFile> m_index;
+
+    QThreadPool m_searches;          // One thread per running searchAsync
+    mutable QThreadPool m_scanPool;  // One task per segment
+
+    void archive(int jobId, int exitCode, quint32 flags);
+    void write(const Record &record);
+    void openArchive();
+    bool startSegment(int segment);
+    void closeSegment();
+    void enforceRetention();
+
+    QString dataPath(int segment) const;
+    QString indexPath(int segment) const;
+    QVector<int> segments() const; // Oldest first
+    QVector<Hit> scanSegment(int segment, const Query &query) const; // Newest first, up to query.limit
+};
+
+#endif // OUTPUTARCHIVE_H
@@ -0,0 +1,157 @@
+#include "outputbuffer.h"
+#include <cstring>
+
+OutputBuffer::OutputBuffer(qsizetype capacity, int lineCapacity)
+    : m_data(qMax<qsizetype>(capacity, 1), Qt::Uninitialized)
+    , m_lines(qMax(lineCapacity, 1))
+{
+}
+
+qint64 OutputBuffer::readFrom(QIODevice *device)
+{
+    const qsizetype capacity = m_data.size();
+    qint64 total = 0;
+
+    while (device->bytesAvailable() > 0) {
+        // Read into the contiguous span up to the end of the ring
+        const qsizetype pos = m_written % capacity;
+        const qint64 chunk = qMin<qint64>(device->bytesAvailable(), capacity - pos);
+        const qint64 n = device->read(m_data.data() + pos, chunk);
+        if (n <= 0) break;
+
+        const qint64 from = m_written;
+        m_written += n;
+        scanLines(from, m_written);
+        total += n;
+    }
+
+    return total;
+}
+
+void OutputBuffer::append(const char *data, qsizetype size)
+{
+    const qsizetype capacity = m_data.size();
+
+    // Only the last `capacity` bytes can survive; lines overlapping the
+    // skipped part are dropped by firstAvailableLine()
+    if (size > capacity) {
+        const qsizetype skipped = size - capacity;
+        m_written += skipped;
+        data += skipped;
+        size = capacity;
+    }
+
+    while (size > 0) {
+        const qsizetype pos = m_written % capacity;
+        const qsizetype chunk = qMin(size, capacity - pos);
+        std::memcpy(m_data.data() + pos, data, chunk);
+
+        const qint64 from = m_written;
+        m_written += chunk;
+        scanLines(from, m_written);
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void OutputBuffer::finish()
+{
+    if (m_lineStart < m_written) {
+        addLine(m_lineStart, m_written);
+        m_lineStart = m_written;
+    }
+}
+
+qsizetype OutputBuffer::size() const
+{
+    return static_cast<qsizetype>(qMin<qint64>(m_written, m_data.size()));
+}
+
+void OutputBuffer::scanLines(qint64 from, qint64 to)
+{
+    // [from, to) never wraps: callers pass one contiguous chunk
+    const qsizetype capacity = m_data.size();
+    const char *base = m_data.constData();
+    qint64 offset = from;
+
+    while (offset < to) {
+        const qsizetype pos = offset % capacity;
+        const void *hit = std::memchr(base + pos, '\n', to - offset);
+        if (!hit) break;
+
+        const qint64 newline = offset + (static_cast<const char *>(hit) - (base + pos));
+        addLine(m_lineStart, newline);
+        m_lineStart = newline + 1;
+        offset = newline + 1;
+    }
+}
+
+void OutputBuffer::addLine(qint64 start, qint64 end)
+{
+    m_lines[m_lineCount % m_lines.size()] = { start, end };
+    ++m_lineCount;
+}
+
+qint64 OutputBuffer::firstAvailableLine() const
+{
+    const qint64 oldestByte = m_written - m_data.size();
+    qint64 first = qMax<qint64>(0, m_lineCount - m_lines.size());
+
+    // Skip lines whose start has already been overwritten
+    while (first < m_lineCount && m_lines[first % m_lines.size()].start < oldestByte)
+        ++first;
+    return first;
+}
+
+QStringList OutputBuffer::lines(qint64 first, int count) const
+{
+    QStringList result;
+    first = qMax(first, firstAvailableLine());
+    const qint64 last = qMin(m_lineCount, first + count);
+    if (last <= first) return result;
+
+    result.reserve(last - first);
+    for (qint64 seq = first; seq < last; ++seq)
+        result.append(lineText(m_lines[seq % m_lines.size()]));
+    return result;
+}
+
+QStringList OutputBuffer::tailLines(int count) const
+{
+    return lines(m_lineCount - count, count);
+}
+
+QString OutputBuffer::lineText(const LineSpan &span) const
+{
+    const qsizetype capacity = m_data.size();
+    const qsizetype startPos = span.start % capacity;
+    qint64 length = span.end - span.start;
+
+    // Strip the '\r' of CRLF line endings
+    if (length > 0 && m_data.at((span.end - 1) % capacity) == '\r')
+        --length;
+
+    if (startPos + length <= capacity)
+        return QString::fromUtf8(m_data.constData() + startPos, length);
+
+    // Line wraps around the end of the ring
+    QByteArray joined;
+    joined.reserve(length);
+    joined.append(m_data.constData() + startPos, capacity - startPos);
+    joined.append(m_data.constData(), length - (capacity - startPos));
+    return QString::fromUtf8(joined);
+}
+
+QByteArray OutputBuffer::contents() const
+{
+    const qsizetype capacity = m_data.size();
+    if (m_written <= capacity)
+        return QByteArray(m_data.constData(), m_written);
+
+    const qsizetype pos = m_written % capacity;
+    QByteArray result;
+    result.reserve(capacity);
+    result.append(m_data.constData() + pos, capacity - pos);
+    result.append(m_data.constData(), pos);
+    return result;
+}
@@ -0,0 +1,53 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QStringList>
+#include <QVector>
+
+// Fixed-size ring buffer for a child process output channel. Data is read
+// straight from the device into the ring, and line boundaries are recorded
+// as absolute offsets while scanning the new bytes, so lines are only
+// materialised when someone asks for them. Memory stays bounded no matter
+// how much the child writes; the oldest bytes are simply overwritten.
+class OutputBuffer
+{
+public:
+    explicit OutputBuffer(qsizetype capacity = 256 * 1024, int lineCapacity = 2048);
+
+    qint64 readFrom(QIODevice *device);
+    void append(const char *data, qsizetype size);
+    void finish(); // Terminates a trailing line without newline
+
+    qsizetype capacity() const { return m_data.size(); }
+    qint64 totalBytes() const { return m_written; }
+    qsizetype size() const;
+    bool truncated() const { return m_written > m_data.size(); }
+
+    // Completed lines are numbered from 0 in the order they were written
+    qint64 lineCount() const { return m_lineCount; }
+    qint64 firstAvailableLine() const;
+    QStringList lines(qint64 first, int count) const;
+    QStringList tailLines(int count) const;
+
+    QByteArray contents() const; // Everything still held, oldest first
+
+private:
+    struct LineSpan {
+        qint64 start;
+        qint64 end; // Exclusive, newline not included
+    };
+
+    QByteArray m_data;
+    qint64 m_written = 0;
+    qint64 m_lineStart = 0; // Offset of the line currently being written
+    QVector<LineSpan> m_lines; // Ring of the most recent completed lines
+    qint64 m_lineCount = 0;
+
+    void scanLines(qint64 from, qint64 to);
+    void addLine(qint64 start, qint64 end);
+    QString lineText(const LineSpan &span) const;
+};
+
+#endif // OUTPUTBUFFER_H
@@ -0,0 +1,13 @@
+#include "processlauncher.h"
+#include <QProcess>
+
+ProcessLauncher::Request ProcessLauncher::fromCommandLine(const QString &commandLine)
+{
+    Request request;
+    QStringList parts = QProcess::splitCommand(commandLine);
+    if (!parts.isEmpty()) {
+        request.program = parts.takeFirst();
+        request.arguments = parts;
+    }
+    return request;
+}
@@ -0,0 +1,33 @@
+#ifndef PROCESSLAUNCHER_H
+#define PROCESSLAUNCHER_H
+
+#include <QString>
+#include <QStringList>
+
+// Fire-and-forget process launching with one implementation per platform:
+// posix_spawn on Linux/macOS (no fork of the GUI process, argv passed as a
+// vector, no shell unless the launch mode needs one) and CreateProcessW /
+// ShellExecuteExW on Windows.
+class ProcessLauncher
+{
+public:
+    struct Request {
+        QString program;
+        QStringList arguments;
+        QString workingDirectory;
+    };
+
+    // Splits a command line the way QProcess does ("quoted args" allowed)
+    static Request fromCommandLine(const QString &commandLine);
+
+    // Runs the program directly, detached from this process
+    static bool startDetached(const Request &request, qint64 *pid = nullptr, QString *error = nullptr);
+
+    // Runs a shell command line in a new terminal window that stays open
+    static bool startInConsole(const QString &commandLine, QString *error = nullptr);
+
+    // Runs a shell command line with elevated privileges
+    static bool startElevated(const QString &commandLine, QString *error = nullptr);
+};
+
+#endif // PROCESSLAUNCHER_H
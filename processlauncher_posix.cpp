@@ -0,0 +1,173 @@
+#include "processlauncher.h"
+#include <QByteArray>
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+namespace {
+
+// Nobody waits for detached children, so one shared thread reaps them to
+// keep them from lingering as zombies. It polls only the pids it was given;
+// waitpid(-1) or a SIGCHLD handler would steal the children of QProcess.
+class Reaper
+{
+public:
+    static Reaper &instance()
+    {
+        // Leaked on purpose: the thread may still be waiting at exit
+        static Reaper *reaper = new Reaper;
+        return *reaper;
+    }
+
+    void add(pid_t pid)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pids.append(pid);
+        m_wake.notify_one();
+    }
+
+private:
+    Reaper()
+    {
+        std::thread([this]() { run(); }).detach();
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            if (m_pids.isEmpty()) {
+                m_wake.wait(lock, [this]() { return !m_pids.isEmpty(); });
+            } else {
+                m_wake.wait_for(lock, std::chrono::milliseconds(500));
+            }
+            m_pids.removeIf([](pid_t pid) {
+                int status = 0;
+                pid_t rc;
+                while ((rc = waitpid(pid, &status, WNOHANG)) < 0 && errno == EINTR) {}
+                return rc != 0; // Reaped, or no longer ours to wait for
+            });
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    QVector<pid_t> m_pids;
+};
+
+bool spawn(const QStringList &argv, const QString &workingDirectory, qint64 *pid, QString *error)
+{
+    if (argv.isEmpty() || argv.first().isEmpty()) {
+        if (error) *error = "Empty command";
+        return false;
+    }
+
+    // Keep the encoded strings alive for the duration of the call
+    QVector<QByteArray> encoded;
+    encoded.reserve(argv.size());
+    for (const QString &arg : argv) encoded.append(QFile::encodeName(arg));
+
+    QVector<char *> args;
+    args.reserve(encoded.size() + 1);
+    for (QByteArray &arg : encoded) args.append(arg.data());
+    args.append(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+
+    if (!workingDirectory.isEmpty()) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+        posix_spawn_file_actions_addchdir_np(&actions, QFile::encodeName(workingDirectory).constData());
+#else
+        posix_spawn_file_actions_destroy(&actions);
+        // No spawn-time chdir on this libc
+        return QProcess::startDetached(argv.first(), argv.mid(1), workingDirectory, pid);
+#endif
+    }
+
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+
+    // Don't leak our blocked signals or ignored SIGPIPE into the child
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_SETSID
+    flags |= POSIX_SPAWN_SETSID; // Own session, survives our terminal going away
+#endif
+    posix_spawnattr_setflags(&attr, flags);
+
+    pid_t child = 0;
+    const int rc = posix_spawnp(&child, args.first(), &actions, &attr, args.data(), environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (rc != 0) {
+        if (error) *error = QString::fromLocal8Bit(std::strerror(rc));
+        return false;
+    }
+
+    Reaper::instance().add(child);
+    if (pid) *pid = child;
+    return true;
+}
+
+QString terminalEmulator()
+{
+    const QString preferred = qEnvironmentVariable("TERMINAL");
+    if (!preferred.isEmpty() && !QStandardPaths::findExecutable(preferred).isEmpty())
+        return preferred;
+
+    const QStringList candidates = { "x-terminal-emulator", "gnome-terminal", "konsole", "xterm" };
+    for (const QString &candidate : candidates) {
+        if (!QStandardPaths::findExecutable(candidate).isEmpty()) return candidate;
+    }
+    return QString();
+}
+
+} // namespace
+
+bool ProcessLauncher::startDetached(const Request &request, qint64 *pid, QString *error)
+{
+    QStringList argv = request.arguments;
+    argv.prepend(request.program);
+    return spawn(argv, request.workingDirectory, pid, error);
+}
+
+bool ProcessLauncher::startInConsole(const QString &commandLine, QString *error)
+{
+    const QString terminal = terminalEmulator();
+    if (terminal.isEmpty()) {
+        if (error) *error = "No terminal emulator found";
+        return false;
+    }
+
+    // Same behaviour as "cmd /k ... && pause": keep the window until a key press
+    const QString script = commandLine + "; printf '\\nPress Enter to close...'; read _";
+    return spawn({ terminal, "-e", "sh", "-c", script }, QString(), nullptr, error);
+}
+
+bool ProcessLauncher::startElevated(const QString &commandLine, QString *error)
+{
+    return spawn({ "pkexec", "sh", "-c", commandLine }, QString(), nullptr, error);
+}
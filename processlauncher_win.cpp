@@ -0,0 +1,107 @@
+#include "processlauncher.h"
+#include <QDir>
+#include <QVector>
+
+#include <windows.h>
+#include <shellapi.h>
+
+namespace {
+
+// Quote one argument following the MSVC runtime's command line parsing rules
+QString quoteArgument(const QString &arg)
+{
+    const bool needsQuotes = arg.isEmpty() || arg.contains(' ') || arg.contains('\t')
+                             || arg.contains('"');
+    if (!needsQuotes) return arg;
+
+    QString quoted = "\"";
+    int backslashes = 0;
+    for (QChar c : arg) {
+        if (c == '\\') {
+            ++backslashes;
+            continue;
+        }
+        if (c == '"') quoted += QString(backslashes * 2 + 1, '\\');
+        else quoted += QString(backslashes, '\\');
+        backslashes = 0;
+        quoted += c;
+    }
+    quoted += QString(backslashes * 2, '\\');
+    quoted += '"';
+    return quoted;
+}
+
+bool createProcess(const QString &commandLine, const QString &workingDirectory,
+                   DWORD creationFlags, qint64 *pid, QString *error)
+{
+    // CreateProcessW may modify the buffer, so hand it a private, sized copy
+    QVector<wchar_t> buffer(commandLine.size() + 1, 0);
+    commandLine.toWCharArray(buffer.data());
+
+    const QString nativeDir = QDir::toNativeSeparators(workingDirectory);
+
+    STARTUPINFOW si;
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    ZeroMemory(&pi, sizeof(pi));
+
+    const BOOL ok = CreateProcessW(NULL, buffer.data(), NULL, NULL, FALSE, creationFlags, NULL,
+                                   workingDirectory.isEmpty() ? NULL
+                                       : reinterpret_cast<LPCWSTR>(nativeDir.utf16()),
+                                   &si, &pi);
+    if (!ok) {
+        if (error) *error = QString("CreateProcess failed, error code %1").arg(GetLastError());
+        return false;
+    }
+
+    if (pid) *pid = pi.dwProcessId;
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    return true;
+}
+
+} // namespace
+
+bool ProcessLauncher::startDetached(const Request &request, qint64 *pid, QString *error)
+{
+    if (request.program.isEmpty()) {
+        if (error) *error = "Empty command";
+        return false;
+    }
+
+    QStringList parts;
+    parts.reserve(request.arguments.size() + 1);
+    parts << quoteArgument(QDir::toNativeSeparators(request.program));
+    for (const QString &arg : request.arguments) parts << quoteArgument(arg);
+
+    return createProcess(parts.join(' '), request.workingDirectory,
+                         CREATE_UNICODE_ENVIRONMENT | CREATE_NEW_CONSOLE, pid, error);
+}
+
+bool ProcessLauncher::startInConsole(const QString &commandLine, QString *error)
+{
+    // Use /k to keep open, then pause and close after key press
+    const QString fullCommand = QString("cmd.exe /k \"%1 && pause\"").arg(commandLine);
+    return createProcess(fullCommand, QString(), CREATE_NEW_CONSOLE, nullptr, error);
+}
+
+bool ProcessLauncher::startElevated(const QString &commandLine, QString *error)
+{
+    const QString parameters = "/k " + commandLine;
+
+    SHELLEXECUTEINFOW info;
+    ZeroMemory(&info, sizeof(info));
+    info.cbSize = sizeof(info);
+    info.fMask = SEE_MASK_NOASYNC;
+    info.lpVerb = L"runas";
+    info.lpFile = L"cmd.exe";
+    info.lpParameters = reinterpret_cast<LPCWSTR>(parameters.utf16());
+    info.nShow = SW_SHOWNORMAL;
+
+    if (!ShellExecuteExW(&info)) {
+        if (error) *error = QString("ShellExecuteEx failed, error code %1").arg(GetLastError());
+        return false;
+    }
+    return true;
+}
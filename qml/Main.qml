@@ -1,8 +1,7 @@
 import QtQuick
-import QtQuick.Controls
+import QtQuick.Controls.Basic
 import QtQuick.Window
 import QtQuick.Layouts
-import com.SRunner 1.0
 
 ApplicationWindow {
     id: root
@@ -27,7 +26,7 @@ ApplicationWindow {
     property int closeThreshold: 100
 
     property bool expanded: false
-    property bool followMouse: false
+    property bool followMouse: SettingsManager.followMouse
     property bool isDragging: false
     property string screenEdge: "right" // right, left, top, bottom
 
@@ -56,6 +55,8 @@ ApplicationWindow {
 
     MousePositionProvider {
         id: mouseProvider
+        // Only poll the cursor while something below actually uses it
+        active: isDragging || (followMouse && !expanded) || (expanded && !settingsOpen)
         onCursorPositionChanged: function(cursorPosition) {
             root.globalMouseX = cursorPosition.x
             root.globalMouseY = cursorPosition.y
@@ -73,8 +74,8 @@ ApplicationWindow {
     Component.onCompleted: initializePosition()
 
     function initializePosition() {
-        var savedX = settingsManager.getEdgeOffset("x")
-        var savedY = settingsManager.getEdgeOffset("y")
+        var savedX = SettingsManager.getEdgeOffset("x")
+        var savedY = SettingsManager.getEdgeOffset("y")
 
         // Set position to saved values
         root.x = Math.max(0, Math.min(savedX, Screen.width - root.width))
@@ -102,13 +103,13 @@ ApplicationWindow {
 
     function savePosition() {
         // Save current position
-        settingsManager.setEdgeOffset("x", root.x)
-        settingsManager.setEdgeOffset("y", root.y)
+        SettingsManager.setEdgeOffset("x", root.x)
+        SettingsManager.setEdgeOffset("y", root.y)
     }
 
     function loadPosition() {
-        var savedX = settingsManager.getEdgeOffset("x")
-        var savedY = settingsManager.getEdgeOffset("y")
+        var savedX = SettingsManager.getEdgeOffset("x")
+        var savedY = SettingsManager.getEdgeOffset("y")
 
         // Check that values are within screen bounds
         root.x = Math.max(0, Math.min(savedX, Screen.width - root.width))
@@ -400,6 +401,8 @@ ApplicationWindow {
             enabled: !expanded && !settingsOpen // Disable dragging when settings are open
 
             onPressed: function(mouse) {
+                // The provider may be idle while docked, sample the cursor now
+                mouseProvider.updateCursorPosition()
                 isDragging = true
                 dragStartX = root.globalMouseX
                 dragStartY = root.globalMouseY
@@ -475,7 +478,7 @@ ApplicationWindow {
         }
     }
 
-    // Modified Settings Popup
+    // Settings popup; Settings.qml is only built the first time it opens
     Rectangle {
         id: settings_popup
         width: 250
@@ -499,31 +502,32 @@ ApplicationWindow {
              onPositionChanged: function(mouse) { mouse.accepted = true }
              onReleased: function(mouse) { mouse.accepted = true }
          }
-        // Main content of the popup
-        ColumnLayout {
-            anchors.fill: parent
-            anchors.margins: 10
 
-            Text {
-                Layout.alignment: Qt.AlignHCenter
-                text: "Settings Panel"
-                font.pixelSize: 20
-                Layout.topMargin: 20
+        onVisibleChanged: {
+            if (visible) {
+                settingsLoader.active = true
+                settingsLoader.item.open()
+            } else if (settingsLoader.item) {
+                settingsLoader.item.close()
             }
+        }
 
-            Item {
-                Layout.fillHeight: true
-            }
+        Loader {
+            id: settingsLoader
+            active: false
 
-            // Close button
-            Button {
-                Layout.alignment: Qt.AlignRight
-                text: "Close"
-                onClicked: {
+            sourceComponent: Settings {
+                parent: settings_popup
+                width: settings_popup.width
+                height: settings_popup.height
+                onClosed: {
                     settings_popup.visible = false
                     settings_popup.z = -1
                     setImportantState(false);
                 }
+                onChangeImportantState: function(isImportant) {
+                    setImportantState(isImportant)
+                }
             }
         }
     }
@@ -1,8 +1,7 @@
 import QtQuick
-import QtQuick.Controls
+import QtQuick.Controls.Basic
 import QtQuick.Layouts
 import QtQuick.Window
-import com.SRunner 1.0
 
 Rectangle {
     id: root
@@ -18,6 +17,60 @@ Rectangle {
     signal changeImportantState(var isImportant)
 
     property bool dropModeActive: fileDropOverlay.visible
+    property var searchResults: []
+    property int batchId: 0
+    property string batchStatus: ""
+    property int outputJobId: 0
+    property string outputTag: ""
+
+    function updateSearch() {
+        searchResults = searchField.text.length > 0 ? ActionManager.searchActions(searchField.text, 30) : []
+    }
+
+    Connections {
+        target: ActionManager
+        function onActionsChanged() { root.updateSearch() }
+        function onActionsReloaded() { root.updateSearch() }
+
+        function onBatchStarted(batchId, actionId, total) {
+            root.batchId = batchId
+            root.batchStatus = actionId + ": 0/" + total
+        }
+        function onBatchProgress(batchId, completed, total, failed) {
+            if (batchId !== root.batchId) return
+            root.batchStatus = completed + "/" + total + (failed > 0 ? " (" + failed + " failed)" : "")
+        }
+        function onBatchFinished(batchId, actionId, summary) {
+            if (batchId !== root.batchId) return
+            root.batchId = 0
+            root.batchStatus = summary.error
+                    ? actionId + ": " + summary.error
+                    : actionId + ": " + summary.succeeded + " ok, " + summary.failed + " failed"
+            batchStatusTimer.restart()
+        }
+    }
+
+    // Follow the most recently started tracked job
+    Connections {
+        target: JobScheduler
+        function onJobStarted(jobId) {
+            root.outputJobId = jobId
+            root.outputTag = JobScheduler.tag(jobId)
+        }
+    }
+
+    JobOutputModel {
+        id: outputTail
+        scheduler: JobScheduler
+        jobId: root.outputJobId
+        maxLines: 50
+    }
+
+    Timer {
+        id: batchStatusTimer
+        interval: 4000
+        onTriggered: if (root.batchId === 0) root.batchStatus = ""
+    }
 
     function openDropArea(action) {
         // console.log("ssssssssssssss")
@@ -28,6 +81,9 @@ Rectangle {
     Keys.onEscapePressed: {
         if (fileDropOverlay.visible) {
             fileDropOverlay.visible = false
+        } else if (searchField.text.length > 0) {
+            searchField.clear()
+            root.forceActiveFocus()
         } else {
             root.closeBtn()
         }
@@ -119,8 +175,168 @@ Rectangle {
             radius: 2
         }
 
+        // Progress of the last multi-file drop
+        RowLayout {
+            visible: root.batchStatus.length > 0
+            Layout.fillWidth: true
+            spacing: 6
+
+            Label {
+                text: root.batchStatus
+                color: "#BDC3C7"
+                font.pixelSize: 11
+                elide: Text.ElideRight
+                Layout.fillWidth: true
+            }
+
+            Label {
+                visible: root.batchId !== 0
+                text: "Cancel"
+                color: "#E74C3C"
+                font.pixelSize: 11
+
+                MouseArea {
+                    anchors.fill: parent
+                    onClicked: ActionManager.cancelBatch(root.batchId)
+                }
+            }
+        }
+
+        // Tail of the last job's output
+        ColumnLayout {
+            visible: root.outputJobId !== 0 && outputTail.totalBytes > 0 && searchField.text.length === 0
+            Layout.fillWidth: true
+            spacing: 2
+
+            RowLayout {
+                Layout.fillWidth: true
+
+                Label {
+                    text: root.outputTag + (outputTail.truncated ? " (truncated)" : "")
+                    color: "#BDC3C7"
+                    font.pixelSize: 11
+                    elide: Text.ElideRight
+                    Layout.fillWidth: true
+                }
+
+                Label {
+                    text: "Hide"
+                    color: "#7F8C8D"
+                    font.pixelSize: 11
+
+                    MouseArea {
+                        anchors.fill: parent
+                        onClicked: root.outputJobId = 0
+                    }
+                }
+            }
+
+            ListView {
+                id: outputView
+                Layout.fillWidth: true
+                Layout.preferredHeight: 60
+                clip: true
+                model: outputTail
+                onCountChanged: positionViewAtEnd()
+
+                delegate: Text {
+                    width: outputView.width
+                    text: model.text
+                    color: "#ECF0F1"
+                    font.family: "monospace"
+                    font.pixelSize: 10
+                    elide: Text.ElideRight
+                }
+            }
+        }
+
+        // Search across all categories
+        TextField {
+            id: searchField
+            Layout.fillWidth: true
+            Layout.preferredHeight: 28
+            placeholderText: "Search actions..."
+            placeholderTextColor: "#7F8C8D"
+            color: "#ECF0F1"
+            font.pixelSize: 12
+            background: Rectangle {
+                color: "#34495E"
+                radius: 2
+                border.color: searchField.activeFocus ? "#2980B9" : "transparent"
+            }
+            onTextChanged: root.updateSearch()
+            Keys.onEscapePressed: function(event) {
+                clear()
+                root.forceActiveFocus()
+            }
+            Keys.onReturnPressed: {
+                if (root.searchResults.length > 0) {
+                    var first = root.searchResults[0]
+                    searchResultsView.trigger(first.actionId, first.type)
+                }
+            }
+        }
+
+        // Search results replace the tabs while a query is typed
+        ListView {
+            id: searchResultsView
+            visible: searchField.text.length > 0
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            spacing: 8
+            model: root.searchResults
+
+            function trigger(actionId, type) {
+                if (type === "exe_with_input") {
+                    fileDropOverlay.openWithAction(ActionManager.getAction(actionId))
+                } else {
+                    ActionManager.executeAction(actionId)
+                }
+            }
+
+            delegate: IconButton {
+                width: searchResultsView.width
+                height: 30
+                icon: modelData.icon
+                tooltip: modelData.description || modelData.name
+                actionName: modelData.name
+                onClicked: searchResultsView.trigger(modelData.actionId, modelData.type)
+            }
+
+            Label {
+                anchors.centerIn: parent
+                visible: searchResultsView.count === 0
+                text: "No matching actions"
+                color: "#BDC3C7"
+                font.pixelSize: 11
+            }
+        }
+
+        // Most used actions first, ranked by ExecutionHistory
+        GridView {
+            id: recentGrid
+            visible: searchField.text.length === 0 && count > 0
+            Layout.fillWidth: true
+            Layout.preferredHeight: Math.ceil(count / 2) * cellHeight
+            interactive: false
+            cellWidth: width / 2
+            cellHeight: 38
+            model: ActionManager.history.recent
+
+            delegate: IconButton {
+                width: recentGrid.cellWidth - 8
+                height: 30
+                icon: model.icon
+                tooltip: model.description || model.name
+                actionName: model.name
+                onClicked: searchResultsView.trigger(model.actionId, model.type)
+            }
+        }
+
         // Tab bar for categories
         Rectangle {
+            visible: searchField.text.length === 0
             Layout.fillWidth: true
             Layout.preferredHeight: 30
             color: "transparent"
@@ -130,11 +346,10 @@ Rectangle {
                 spacing: 0
 
                 Repeater {
-                    model: actionManager.categoriesKeys.length
+                    model: ActionManager.categoryModel
 
                     TabButton {
-                        text: actionManager.categoriesKeys[index].charAt(0).toUpperCase() +
-                              actionManager.categoriesKeys[index].slice(1)
+                        text: model.displayName
                         isCurrent: tabBar.currentIndex === index
                         Layout.fillWidth: true
                         onClicked: tabBar.currentIndex = index
@@ -146,34 +361,37 @@ Rectangle {
         // Tab content - Dynamic from action manager
         StackLayout {
             id: tabBar
+            visible: searchField.text.length === 0
             Layout.fillWidth: true
             Layout.fillHeight: true
             currentIndex: 0
 
             Repeater {
-                model: Object.keys(actionManager.categorizedActions)
+                model: ActionManager.categoryModel
 
-                GridLayout {
-                    columns: 2//Math.max(2, Math.floor(parent.width / 40))
-                    columnSpacing: 8
-                    rowSpacing: 8
+                GridView {
+                    id: actionGrid
                     Layout.fillWidth: true
                     Layout.fillHeight: true
-
-                    Repeater {
-                        model: actionManager.categorizedActions[modelData] // category actions
-                        delegate: IconButton {
-                            icon: modelData.icon
-                            tooltip: modelData.name
-                            actionName: modelData.name  // Pass the action name
-                            onClicked: {
-                                if (modelData.type === "exe_with_input") {
-                                    // Needs a file from user → open overlay
-                                    fileDropOverlay.openWithAction(modelData)
-                                } else {
-                                    // exe and exe_in_cmd (with static_file) → run directly
-                                    actionManager.executeAction(modelData.id)
-                                }
+                    clip: true
+                    cellWidth: width / 2
+                    cellHeight: 38
+                    model: actions // category actions, delegates are recycled by the view
+                    reuseItems: true
+
+                    delegate: IconButton {
+                        width: actionGrid.cellWidth - 8
+                        height: 30
+                        icon: model.icon
+                        tooltip: model.name
+                        actionName: model.name  // Pass the action name
+                        onClicked: {
+                            if (model.type === "exe_with_input") {
+                                // Needs a file from user → open overlay
+                                fileDropOverlay.openWithAction(model.action)
+                            } else {
+                                // exe and exe_in_cmd (with static_file) → run directly
+                                ActionManager.executeAction(model.actionId)
                             }
                         }
                     }
@@ -238,6 +456,34 @@ Rectangle {
                     horizontalAlignment: Text.AlignHCenter
                     Layout.fillWidth: true
                 }
+
+                Button {
+                    text: "Enter a path..."
+                    Layout.alignment: Qt.AlignHCenter
+                    onClicked: {
+                        fileDialogLoader.active = true
+                        fileDialogLoader.item.open()
+                    }
+                }
+            }
+        }
+
+        // Only built when somebody asks to type a path instead of dropping
+        Loader {
+            id: fileDialogLoader
+            active: false
+
+            sourceComponent: FileSelectDialog {
+                parent: fileDropOverlay
+                anchors.centerIn: parent
+                width: fileDropOverlay.width - 20
+                title: fileDropOverlay.currentAction ? fileDropOverlay.currentAction.name : "Select File"
+                onAccepted: {
+                    if (fileDropOverlay.currentAction && selectedFile)
+                        ActionManager.executeActionWithFile(fileDropOverlay.currentAction.id, selectedFile)
+                    fileDropOverlay.visible = false
+                    root.changeImportantState(false)
+                }
             }
         }
         DropArea {
@@ -261,7 +507,22 @@ Rectangle {
             }
 
             onDropped: function(drop) {
-                if (drop.hasUrls) {
+                if (drop.hasUrls && drop.urls.length > 1) {
+                    // Several files: one batch, expanded and fanned out in C++
+                    var urls = []
+                    for (var i = 0; i < drop.urls.length; ++i)
+                        urls.push(drop.urls[i].toString())
+
+                    if (fileDropOverlay.currentAction) {
+                        ActionManager.executeActionWithFiles(fileDropOverlay.currentAction.id, urls)
+                    }
+
+                    fileDropOverlay.visible = false
+                    root.changeImportantState(false)
+                    dropIndicator.border.color = "#3498DB"
+                    dropIndicator.border.width = 2
+                    dropText.text = "Drop file here"
+                } else if (drop.hasUrls) {
                     var filePath = drop.urls[0].toString()
                     if (filePath.startsWith("file:///")) {
                         filePath = filePath.substring(8)
@@ -271,7 +532,7 @@ Rectangle {
                     filePath = decodeURIComponent(filePath) // ✅ normalize path
 
                     if (fileDropOverlay.currentAction) {
-                        actionManager.executeActionWithFile(fileDropOverlay.currentAction.id, filePath)
+                        ActionManager.executeActionWithFile(fileDropOverlay.currentAction.id, filePath)
                     }
 
                     fileDropOverlay.visible = false
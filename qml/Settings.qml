@@ -1,9 +1,7 @@
 import QtQuick
-import QtQuick.Controls
+import QtQuick.Controls.Basic
 import QtQuick.Layouts
 import QtQuick.Window
-import com.SRunner 1.0
-import Qt.labs.settings 1.0
 
 Popup {
     id: settingsPopup
@@ -116,22 +114,22 @@ Popup {
 
                         LabeledColorPicker {
                             label: "Docked Color:"
-                            color: settingsManager.dockedColor
-                            onColorChanged: settingsManager.setDockedColor(color)
+                            color: SettingsManager.dockedColor
+                            onColorChanged: SettingsManager.setDockedColor(color)
                         }
 
                         LabeledColorPicker {
                             label: "Expanded Color:"
-                            color: settingsManager.expandedColor
-                            onColorChanged: settingsManager.setExpandedColor(color)
+                            color: SettingsManager.expandedColor
+                            onColorChanged: SettingsManager.setExpandedColor(color)
                         }
 
                         LabeledSlider {
                             label: "Corner Radius:"
                             from: 0
                             to: 10
-                            value: settingsManager.cornerRadius
-                            onValueChanged: settingsManager.setCornerRadius(value)
+                            value: SettingsManager.cornerRadius
+                            onValueChanged: SettingsManager.setCornerRadius(value)
                         }
                     }
                 }
@@ -148,7 +146,7 @@ Popup {
                             label: "Screen Edge:"
                             model: ["Right", "Left", "Top", "Bottom"]
                             currentIndex: {
-                                switch(settingsManager.screenEdge) {
+                                switch(SettingsManager.screenEdge) {
                                     case "right": return 0;
                                     case "left": return 1;
                                     case "top": return 2;
@@ -158,14 +156,14 @@ Popup {
                             }
                             onCurrentIndexChanged: {
                                 var edges = ["right", "left", "top", "bottom"];
-                                settingsManager.setScreenEdge(edges[currentIndex]);
+                                SettingsManager.setScreenEdge(edges[currentIndex]);
                             }
                         }
 
                         LabeledCheckBox {
                             text: "Follow Mouse"
-                            checked: settingsManager.followMouse
-                            onCheckedChanged: settingsManager.setFollowMouse(checked)
+                            checked: SettingsManager.followMouse
+                            onCheckedChanged: SettingsManager.setFollowMouse(checked)
                         }
 
                         LabeledCheckBox {
@@ -231,7 +229,7 @@ Popup {
                     backgroundColor: "#3182CE"
                     hoverColor: "#2B6CB0"
                     onClicked: {
-                        settingsManager.saveSettings()
+                        SettingsManager.saveSettings()
                         settingsPopup.visible = false
                     }
                 }
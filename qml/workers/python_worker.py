@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Persistent worker for ScriptRunner interpreter pools.
+
+Reads one JSON request per line from stdin and runs the script named by
+argv[0] in this interpreter, then writes one JSON response per line:
+
+    {"id": 7, "argv": ["tool.py", "a"], "cwd": "/dir"}
+    {"id": 7, "exit_code": 0, "stdout": "...", "stderr": "..."}
+
+Declare it in actions.json:
+
+    "pools": {
+        "python": { "program": "python3", "arguments": ["workers/python_worker.py"], "size": 2 }
+    }
+
+and set "pool": "python" on actions whose command is "script.py {file}".
+"""
+
+import contextlib
+import io
+import json
+import os
+import runpy
+import sys
+import traceback
+
+
+def run(request):
+    argv = request.get("argv") or []
+    out, err = io.StringIO(), io.StringIO()
+    exit_code = 0
+
+    saved_cwd, saved_argv, saved_path = os.getcwd(), sys.argv, list(sys.path)
+    try:
+        with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+            try:
+                if request.get("cwd"):
+                    os.chdir(request["cwd"])
+                script = os.path.abspath(argv[0])
+                sys.argv = list(argv)
+                sys.path.insert(0, os.path.dirname(script))
+                runpy.run_path(script, run_name="__main__")
+            except SystemExit as exit:
+                if isinstance(exit.code, int):
+                    exit_code = exit.code
+                elif exit.code is not None:
+                    print(exit.code, file=sys.stderr)
+                    exit_code = 1
+            except BaseException:
+                traceback.print_exc()
+                exit_code = 1
+    finally:
+        os.chdir(saved_cwd)
+        sys.argv, sys.path[:] = saved_argv, saved_path
+
+    return {"id": request.get("id"), "exit_code": exit_code,
+            "stdout": out.getvalue(), "stderr": err.getvalue()}
+
+
+def main():
+    # Only responses go to the real stdout; stray prints can't break framing
+    protocol = sys.stdout
+    sys.stdout = sys.stderr
+
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            request = json.loads(line)
+        except ValueError as error:
+            response = {"id": None, "exit_code": 1, "stdout": "", "stderr": str(error)}
+        else:
+            response = run(request)
+        protocol.write(json.dumps(response) + "\n")
+        protocol.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+#ifndef QMLSINGLETONS_H
+#define QMLSINGLETONS_H
+
+#include <QJSEngine>
+#include <QQmlEngine>
+#include <QtQml/qqmlregistration.h>
+
+#include "srunner.h"
+#include "settingsmanager.h"
+#include "actionmanager.h"
+#include "jobscheduler.h"
+#include "executiontelemetry.h"
+#include "triggerscheduler.h"
+#include "outputarchive.h"
+
+// The application's long-lived objects as QML singletons of the
+// ScriptRunner module. They are registered at compile time, so qmlsc
+// knows their types and compiles bindings against them; main() creates
+// the objects and sets s_instance before the engine loads any QML.
+template <typename T>
+struct QmlSingletonInstance
+{
+    inline static T *s_instance = nullptr;
+
+    static T *create(QQmlEngine *, QJSEngine *)
+    {
+        Q_ASSERT(s_instance);
+        // Owned by main(), never by the engine
+        QJSEngine::setObjectOwnership(s_instance, QJSEngine::CppOwnership);
+        return s_instance;
+    }
+};
+
+struct SRunnerSingleton : QmlSingletonInstance<SRunner>
+{
+    Q_GADGET
+    QML_FOREIGN(SRunner)
+    QML_NAMED_ELEMENT(SRunner)
+    QML_SINGLETON
+};
+
+struct SettingsManagerSingleton : QmlSingletonInstance<SettingsManager>
+{
+    Q_GADGET
+    QML_FOREIGN(SettingsManager)
+    QML_NAMED_ELEMENT(SettingsManager)
+    QML_SINGLETON
+};
+
+struct ActionManagerSingleton : QmlSingletonInstance<ActionManager>
+{
+    Q_GADGET
+    QML_FOREIGN(ActionManager)
+    QML_NAMED_ELEMENT(ActionManager)
+    QML_SINGLETON
+};
+
+struct JobSchedulerSingleton : QmlSingletonInstance<JobScheduler>
+{
+    Q_GADGET
+    QML_FOREIGN(JobScheduler)
+    QML_NAMED_ELEMENT(JobScheduler)
+    QML_SINGLETON
+};
+
+struct TelemetrySingleton : QmlSingletonInstance<ExecutionTelemetry>
+{
+    Q_GADGET
+    QML_FOREIGN(ExecutionTelemetry)
+    QML_NAMED_ELEMENT(Telemetry)
+    QML_SINGLETON
+};
+
+struct TriggersSingleton : QmlSingletonInstance<TriggerScheduler>
+{
+    Q_GADGET
+    QML_FOREIGN(TriggerScheduler)
+    QML_NAMED_ELEMENT(Triggers)
+    QML_SINGLETON
+};
+
+struct ArchiveSingleton : QmlSingletonInstance<OutputArchive>
+{
+    Q_GADGET
+    QML_FOREIGN(OutputArchive)
+    QML_NAMED_ELEMENT(Archive)
+    QML_SINGLETON
+};
+
+#endif // QMLSINGLETONS_H
@@ -0,0 +1,212 @@
+#include "resultcache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+#include <algorithm>
+
+static const quint32 EntryMagic = 0x53525243; // "SRRC"
+static const quint32 EntryVersion = 1;
+static const char EntrySuffix[] = ".result";
+// A file written this close to its hashing may change again without its
+// timestamp moving, so its memoised hash isn't trusted
+static const qint64 RacyWindowMs = 2000;
+
+ResultCache::ResultCache(const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+{
+}
+
+QString ResultCache::entryPath(const QByteArray &key) const
+{
+    return m_directory + "/" + QString::fromLatin1(key) + EntrySuffix;
+}
+
+QByteArray ResultCache::key(const QString &command, const QStringList &files)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(command.toUtf8());
+
+    QStringList sorted = files;
+    std::sort(sorted.begin(), sorted.end());
+    for (const QString &path : std::as_const(sorted)) {
+        hash.addData(QByteArrayView("\0", 1));
+        hash.addData(QFileInfo(path).absoluteFilePath().toUtf8());
+        hash.addData(QByteArrayView("\0", 1));
+        hash.addData(fileHash(path));
+    }
+    return hash.result().toHex();
+}
+
+QByteArray ResultCache::fileHash(const QString &path)
+{
+    const QFileInfo info(path);
+    if (!info.isFile()) return QByteArray("missing");
+
+    // Hashing large inputs on every run would eat the savings
+    FileHash &cached = m_fileHashes[info.absoluteFilePath()];
+    if (cached.size == info.size() && cached.modified == info.lastModified() && !cached.hash.isEmpty()
+        && cached.modified.msecsTo(cached.hashedAt) > RacyWindowMs)
+        return cached.hash;
+
+    const QDateTime hashedAt = QDateTime::currentDateTime();
+    QFile file(info.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return QByteArray("unreadable");
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    cached.size = info.size();
+    cached.modified = info.lastModified();
+    cached.hashedAt = hashedAt;
+    cached.hash = hash.result();
+    return cached.hash;
+}
+
+void ResultCache::scan()
+{
+    if (m_scanned) return;
+    m_scanned = true;
+
+    // Rebuild LRU order from modification times, which lookups refresh
+    QDir dir(m_directory);
+    const QFileInfoList entries = dir.entryInfoList({ QString("*") + EntrySuffix }, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &info : entries) {
+        const QByteArray key = info.completeBaseName().toLatin1();
+        Slot slot;
+        slot.size = info.size();
+        slot.stamp = m_nextStamp++;
+        m_slots.insert(key, slot);
+        m_lru.insert(slot.stamp, key);
+        m_sizeBytes += slot.size;
+    }
+}
+
+void ResultCache::touch(const QByteArray &key)
+{
+    auto it = m_slots.find(key);
+    if (it == m_slots.end()) return;
+
+    m_lru.remove(it->stamp);
+    it->stamp = m_nextStamp++;
+    m_lru.insert(it->stamp, key);
+
+    QFile file(entryPath(key));
+    if (file.open(QIODevice::ReadWrite))
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+void ResultCache::forget(const QByteArray &key)
+{
+    auto it = m_slots.find(key);
+    if (it == m_slots.end()) return;
+
+    m_lru.remove(it->stamp);
+    m_sizeBytes -= it->size;
+    m_slots.erase(it);
+    QFile::remove(entryPath(key));
+}
+
+void ResultCache::evict()
+{
+    while (m_sizeBytes > m_maxSizeBytes && !m_lru.isEmpty())
+        forget(m_lru.first());
+}
+
+bool ResultCache::lookup(const QByteArray &key, Entry *entry)
+{
+    scan();
+
+    if (m_slots.contains(key)) {
+        QFile file(entryPath(key));
+        if (file.open(QIODevice::ReadOnly)) {
+            QDataStream stream(&file);
+            quint32 magic = 0;
+            quint32 version = 0;
+            qint32 exitCode = 0;
+            Entry result;
+            stream >> magic >> version >> exitCode >> result.standardOutput >> result.standardError;
+            file.close();
+
+            if (stream.status() == QDataStream::Ok && magic == EntryMagic && version == EntryVersion) {
+                result.exitCode = exitCode;
+                *entry = result;
+                touch(key);
+                ++m_hits;
+                emit statsChanged();
+                return true;
+            }
+        }
+        // Unreadable or foreign entry - drop it
+        forget(key);
+    }
+
+    ++m_misses;
+    emit statsChanged();
+    return false;
+}
+
+bool ResultCache::store(const QByteArray &key, const Entry &entry)
+{
+    scan();
+    if (!QDir().mkpath(m_directory)) return false;
+
+    QSaveFile file(entryPath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Result cache not writable:" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << EntryMagic << EntryVersion << qint32(entry.exitCode)
+           << entry.standardOutput << entry.standardError;
+    if (stream.status() != QDataStream::Ok || !file.commit()) return false;
+
+    // Replaced in place; only the bookkeeping of an older copy goes
+    auto previous = m_slots.find(key);
+    if (previous != m_slots.end()) {
+        m_lru.remove(previous->stamp);
+        m_sizeBytes -= previous->size;
+        m_slots.erase(previous);
+    }
+
+    Slot slot;
+    slot.size = QFileInfo(entryPath(key)).size();
+    slot.stamp = m_nextStamp++;
+    m_slots.insert(key, slot);
+    m_lru.insert(slot.stamp, key);
+    m_sizeBytes += slot.size;
+
+    evict();
+    emit statsChanged();
+    return true;
+}
+
+void ResultCache::clear()
+{
+    scan();
+    const QList<QByteArray> keys = m_slots.keys();
+    for (const QByteArray &key : keys) forget(key);
+    m_hits = 0;
+    m_misses = 0;
+    emit statsChanged();
+}
+
+double ResultCache::hitRate() const
+{
+    const int lookups = m_hits + m_misses;
+    return lookups ? double(m_hits) / lookups : 0.0;
+}
+
+void ResultCache::setMaxSizeBytes(qint64 bytes)
+{
+    bytes = qMax<qint64>(0, bytes);
+    if (m_maxSizeBytes == bytes) return;
+    m_maxSizeBytes = bytes;
+    scan();
+    evict();
+    emit statsChanged();
+}
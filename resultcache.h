@@ -0,0 +1,83 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QObject>
+#include <QtQml/qqmlregistration.h>
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+
+// On-disk memo of results for actions flagged "cacheable". The key is a
+// SHA-256 over the rendered command line and the content of every file
+// input, so editing an input file misses the cache. Entries live one per
+// file under the cache directory, named by key, and the least recently
+// used ones are evicted once the total size passes maxSizeBytes.
+class ResultCache : public QObject
+{
+    Q_OBJECT
+    QML_ANONYMOUS
+    Q_PROPERTY(int hits READ hits NOTIFY statsChanged)
+    Q_PROPERTY(int misses READ misses NOTIFY statsChanged)
+    Q_PROPERTY(double hitRate READ hitRate NOTIFY statsChanged)
+    Q_PROPERTY(qint64 sizeBytes READ sizeBytes NOTIFY statsChanged)
+    Q_PROPERTY(qint64 maxSizeBytes READ maxSizeBytes WRITE setMaxSizeBytes NOTIFY statsChanged)
+
+public:
+    struct Entry {
+        int exitCode = 0;
+        QByteArray standardOutput;
+        QByteArray standardError;
+    };
+
+    explicit ResultCache(const QString &directory, QObject *parent = nullptr);
+
+    QByteArray key(const QString &command, const QStringList &files);
+    bool lookup(const QByteArray &key, Entry *entry);
+    bool store(const QByteArray &key, const Entry &entry);
+    Q_INVOKABLE void clear();
+
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+    double hitRate() const;
+    qint64 sizeBytes() const { return m_sizeBytes; }
+    qint64 maxSizeBytes() const { return m_maxSizeBytes; }
+    void setMaxSizeBytes(qint64 bytes);
+
+signals:
+    void statsChanged();
+
+private:
+    struct Slot {
+        qint64 size = 0;
+        quint64 stamp = 0; // Position in m_lru
+    };
+
+    struct FileHash {
+        qint64 size = -1;
+        QDateTime modified;
+        QDateTime hashedAt;
+        QByteArray hash;
+    };
+
+    QString m_directory;
+    bool m_scanned = false;
+    QHash<QByteArray, Slot> m_slots;
+    QMap<quint64, QByteArray> m_lru; // Oldest first
+    quint64 m_nextStamp = 1;
+    qint64 m_sizeBytes = 0;
+    qint64 m_maxSizeBytes = 64 * 1024 * 1024;
+    int m_hits = 0;
+    int m_misses = 0;
+    QHash<QString, FileHash> m_fileHashes; // Content hashes, reused while size and mtime match
+
+    QString entryPath(const QByteArray &key) const;
+    void scan();
+    void touch(const QByteArray &key);
+    void forget(const QByteArray &key);
+    void evict();
+    QByteArray fileHash(const QString &path);
+};
+
+#endif // RESULTCACHE_H
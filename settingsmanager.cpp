@@ -1,12 +1,17 @@
-#include "SettingsManager.h"
+#include "settingsmanager.h"
+#include "trace.h"
 #include <QDebug>
 #include <QGuiApplication>
 
+// Coalesces bursts such as a window drag into a single write
+static const int FlushDelayMs = 500;
+
 SettingsManager::SettingsManager(QObject *parent)
     : QObject(parent)
     , m_settings(QSettings::IniFormat, QSettings::UserScope,
                  QGuiApplication::organizationName(),
                  QGuiApplication::applicationName())
+    , m_fileName(m_settings.fileName())
 {
     // Default values
     m_screenEdge = "right";
@@ -14,17 +19,36 @@ SettingsManager::SettingsManager(QObject *parent)
     m_expandedColor = QColor("#2C3E50");
     m_cornerRadius = 4;
     m_followMouse = false;
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushDelayMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &SettingsManager::flush);
+
+    // One writer thread keeps flushes ordered
+    m_flushPool.setMaxThreadCount(1);
+
+    if (QCoreApplication *app = QCoreApplication::instance())
+        connect(app, &QCoreApplication::aboutToQuit, this, &SettingsManager::flushNow);
+}
+
+SettingsManager::~SettingsManager()
+{
+    flushNow();
 }
 
 void SettingsManager::loadSettings()
 {
-    m_settings.beginGroup("Window");
-    m_screenEdge = m_settings.value("screenEdge", "right").toString();
-    m_dockedColor = m_settings.value("dockedColor", QColor("#3498DB")).value<QColor>();
-    m_expandedColor = m_settings.value("expandedColor", QColor("#2C3E50")).value<QColor>();
-    m_cornerRadius = m_settings.value("cornerRadius", 4).toInt();
-    m_followMouse = m_settings.value("followMouse", false).toBool();
-    m_settings.endGroup();
+    TRACE_SCOPE("loadSettings", "settings");
+    // Pull the whole file into memory once; getters never hit QSettings
+    m_cache.clear();
+    const QStringList keys = m_settings.allKeys();
+    for (const QString &key : keys) m_cache.insert(key, m_settings.value(key));
+
+    m_screenEdge = cachedValue("Window/screenEdge", "right").toString();
+    m_dockedColor = cachedValue("Window/dockedColor", QColor("#3498DB")).value<QColor>();
+    m_expandedColor = cachedValue("Window/expandedColor", QColor("#2C3E50")).value<QColor>();
+    m_cornerRadius = cachedValue("Window/cornerRadius", 4).toInt();
+    m_followMouse = cachedValue("Window/followMouse", false).toBool();
 
     emit settingsLoaded();
     qDebug() << "Settings loaded from" << m_settings.fileName();
@@ -32,59 +56,110 @@ void SettingsManager::loadSettings()
 
 void SettingsManager::saveSettings()
 {
-    m_settings.beginGroup("Window");
-    m_settings.setValue("screenEdge", m_screenEdge);
-    m_settings.setValue("dockedColor", m_dockedColor);
-    m_settings.setValue("expandedColor", m_expandedColor);
-    m_settings.setValue("cornerRadius", m_cornerRadius);
-    m_settings.setValue("followMouse", m_followMouse);
-    m_settings.endGroup();
-    m_settings.sync();
+    TRACE_SCOPE("saveSettings", "settings");
+    setCachedValue("Window/screenEdge", m_screenEdge);
+    setCachedValue("Window/dockedColor", m_dockedColor);
+    setCachedValue("Window/expandedColor", m_expandedColor);
+    setCachedValue("Window/cornerRadius", m_cornerRadius);
+    setCachedValue("Window/followMouse", m_followMouse);
+    flush();
 
     emit settingsSaved();
     qDebug() << "Settings saved to" << m_settings.fileName();
 }
 
+void SettingsManager::flush()
+{
+    m_flushTimer.stop();
+    if (m_dirty.isEmpty()) return;
+
+    QHash<QString, QVariant> values;
+    for (const QString &key : std::as_const(m_dirty)) values.insert(key, m_cache.value(key));
+    m_dirty.clear();
+
+    m_flushPool.start([this, values]() { writeBackend(values); });
+}
+
+void SettingsManager::flushNow()
+{
+    TRACE_SCOPE("flushNow", "settings");
+    m_flushTimer.stop();
+    m_flushPool.waitForDone();
+    if (m_dirty.isEmpty()) return;
+
+    QHash<QString, QVariant> values;
+    for (const QString &key : std::as_const(m_dirty)) values.insert(key, m_cache.value(key));
+    m_dirty.clear();
+
+    writeBackend(values);
+}
+
+int SettingsManager::backendWriteCount() const
+{
+    return m_backendWrites.load();
+}
+
+QVariant SettingsManager::cachedValue(const QString &key, const QVariant &defaultValue) const
+{
+    return m_cache.value(key, defaultValue);
+}
+
+void SettingsManager::setCachedValue(const QString &key, const QVariant &value)
+{
+    auto it = m_cache.find(key);
+    if (it != m_cache.end() && it.value() == value) return;
+
+    m_cache.insert(key, value);
+    m_dirty.insert(key);
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
+
+void SettingsManager::writeBackend(const QHash<QString, QVariant> &values)
+{
+    TRACE_SCOPE("settings write", "settings");
+    // Own QSettings instance: this runs on the flush thread
+    QSettings settings(m_fileName, QSettings::IniFormat);
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+        settings.setValue(it.key(), it.value());
+    settings.sync();
+    ++m_backendWrites;
+}
+
 int SettingsManager::getEdgeOffset(const QString &edge)
 {
-    m_settings.beginGroup("EdgePositions");
-    int offset = m_settings.value(edge, 100).toInt(); // Default 100 pixels from top/left
-    m_settings.endGroup();
-    return offset;
+    return cachedValue("EdgePositions/" + edge, 100).toInt(); // Default 100 pixels from top/left
 }
 
 void SettingsManager::setEdgeOffset(const QString &edge, int offset)
 {
-    m_settings.beginGroup("EdgePositions");
-    m_settings.setValue(edge, offset);
-    m_settings.endGroup();
+    setCachedValue("EdgePositions/" + edge, offset);
 }
 
 // Saved position
 void SettingsManager::setSavedX(qreal x)
 {
-    if (m_settings.value("Window/savedX", 0).toReal() != x) {
-        m_settings.setValue("Window/savedX", x);
+    if (savedX() != x) {
+        setCachedValue("Window/savedX", x);
         emit savedXChanged();
     }
 }
 
 void SettingsManager::setSavedY(qreal y)
 {
-    if (m_settings.value("Window/savedY", 0).toReal() != y) {
-        m_settings.setValue("Window/savedY", y);
+    if (savedY() != y) {
+        setCachedValue("Window/savedY", y);
         emit savedYChanged();
     }
 }
 
 qreal SettingsManager::savedX() const
 {
-    return m_settings.value("Window/savedX", 0).toReal();
+    return cachedValue("Window/savedX", 0).toReal();
 }
 
 qreal SettingsManager::savedY() const
 {
-    return m_settings.value("Window/savedY", 0).toReal();
+    return cachedValue("Window/savedY", 0).toReal();
 }
 
 // Getters
@@ -4,6 +4,12 @@
 #include <QObject>
 #include <QSettings>
 #include <QColor>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariant>
+#include <atomic>
 
 class SettingsManager : public QObject
 {
@@ -18,9 +24,18 @@ class SettingsManager : public QObject
 
 public:
     explicit SettingsManager(QObject *parent = nullptr);
+    ~SettingsManager() override;
 
     Q_INVOKABLE void loadSettings();
     Q_INVOKABLE void saveSettings();
+
+    // Values live in memory; changed keys are written in the background
+    // shortly after the last change, and synchronously on quit
+    Q_INVOKABLE void flush();
+    Q_INVOKABLE void flushNow();
+    // Flushes that reached the settings file, however many keys each wrote
+    Q_INVOKABLE int backendWriteCount() const;
+
     Q_INVOKABLE int getEdgeOffset(const QString &edge);
     Q_INVOKABLE void setEdgeOffset(const QString &edge, int offset);
 
@@ -56,12 +71,23 @@ signals:
     void settingsSaved();
 
 private:
-    QSettings m_settings;
+    QSettings m_settings; // Only read at load; writes go through writeBackend()
+    const QString m_fileName;
+    QHash<QString, QVariant> m_cache;
+    QSet<QString> m_dirty;
+    QTimer m_flushTimer;
+    QThreadPool m_flushPool;
+    std::atomic<int> m_backendWrites{0};
+
     QString m_screenEdge;
     QColor m_dockedColor;
     QColor m_expandedColor;
     int m_cornerRadius;
     bool m_followMouse;
+
+    QVariant cachedValue(const QString &key, const QVariant &defaultValue) const;
+    void setCachedValue(const QString &key, const QVariant &value);
+    void writeBackend(const QHash<QString, QVariant> &values);
 };
 
 #endif // SETTINGSMANAGER_H
@@ -1,4 +1,5 @@
-#include "SRunner.h"
+#include "srunner.h"
+#include "jobscheduler.h"
 #include <QDebug>
 #include <QDir>
 
@@ -7,54 +8,82 @@
 #include <shellapi.h>
 #endif
 
-SRunner::SRunner(QObject *parent)
+SRunner::SRunner(JobScheduler *scheduler, QObject *parent)
     : QObject(parent)
-    , m_process(new QProcess(this))
+    , m_scheduler(scheduler)
 {
-    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            [this](int exitCode, QProcess::ExitStatus exitStatus) {
-                QString command = m_process->program() + " " + m_process->arguments().join(" ");
-                emit executionFinished(command, exitCode);
+    Q_ASSERT(m_scheduler);
+
+    // The scheduler is shared, so only report jobs this runner submitted
+    connect(m_scheduler, &JobScheduler::jobFinished, this,
+            [this](int jobId, int exitCode, QProcess::ExitStatus) {
+                if (m_commands.contains(jobId))
+                    emit executionFinished(m_commands.take(jobId), exitCode);
+            });
+
+    connect(m_scheduler, &JobScheduler::jobError, this,
+            [this](int jobId, const QString &error) {
+                if (m_commands.contains(jobId))
+                    emit executionError(m_commands.take(jobId), error);
             });
 
-    connect(m_process, &QProcess::errorOccurred,
-            [this](QProcess::ProcessError error) {
-                QString command = m_process->program() + " " + m_process->arguments().join(" ");
-                emit executionError(command, m_process->errorString());
+    connect(m_scheduler, &JobScheduler::jobCanceled, this,
+            [this](int jobId) {
+                if (m_commands.contains(jobId))
+                    emit executionError(m_commands.take(jobId), "Canceled");
             });
 }
 
-void SRunner::runExe(const QString &path)
+JobScheduler *SRunner::jobScheduler() const
+{
+    return m_scheduler;
+}
+
+int SRunner::submit(const QString &command, const QString &program,
+                    const QStringList &arguments, const QString &workingDirectory)
+{
+    JobScheduler::JobSpec spec;
+    spec.program = program;
+    spec.arguments = arguments;
+    spec.workingDirectory = workingDirectory;
+
+    // Jobs start from the event loop, so the id can be recorded after submit
+    const int jobId = m_scheduler->submit(spec);
+    m_commands.insert(jobId, command);
+    return jobId;
+}
+
+int SRunner::runExe(const QString &path)
 {
     QString cleanedPath = path.trimmed();
     if (cleanedPath.isEmpty()) {
         emit executionError(path, "Empty path provided");
-        return;
+        return 0;
     }
 
     emit executionStarted(cleanedPath);
 
     if (!QFile::exists(cleanedPath)) {
         emit executionError(cleanedPath, "File does not exist");
-        return;
+        return 0;
     }
 
-    m_process->start(cleanedPath, QStringList());
+    return submit(cleanedPath, cleanedPath, QStringList());
 }
 
-void SRunner::runExeInCmd(const QString &path)
+int SRunner::runExeInCmd(const QString &path)
 {
     QString cleanedPath = path.trimmed();
     if (cleanedPath.isEmpty()) {
         emit executionError(path, "Empty path provided");
-        return;
+        return 0;
     }
 
     emit executionStarted(cleanedPath);
 
     if (!QFile::exists(cleanedPath)) {
         emit executionError(cleanedPath, "File does not exist");
-        return;
+        return 0;
     }
 
 #ifdef Q_OS_WIN
@@ -69,27 +98,26 @@ void SRunner::runExeInCmd(const QString &path)
 
     arguments << filename;
 
-    m_process->setWorkingDirectory(directory);
-    m_process->start(command, arguments);
+    return submit(cleanedPath, command, arguments, directory);
 #else
     // For non-Windows systems, use xterm or similar
-    m_process->start("xterm", QStringList() << "-e" << cleanedPath);
+    return submit(cleanedPath, "xterm", QStringList() << "-e" << cleanedPath);
 #endif
 }
 
-void SRunner::runExeAsAdmin(const QString &path)
+int SRunner::runExeAsAdmin(const QString &path)
 {
     QString cleanedPath = path.trimmed();
     if (cleanedPath.isEmpty()) {
         emit executionError(path, "Empty path provided");
-        return;
+        return 0;
     }
 
     emit executionStarted(cleanedPath);
 
     if (!QFile::exists(cleanedPath)) {
         emit executionError(cleanedPath, "File does not exist");
-        return;
+        return 0;
     }
 
 #ifdef Q_OS_WIN
@@ -107,25 +135,27 @@ void SRunner::runExeAsAdmin(const QString &path)
     if (reinterpret_cast<intptr_t>(result) <= 32) {
         emit executionError(cleanedPath, "Failed to execute as administrator");
     }
+    // ShellExecute detaches, there is no job to track
+    return 0;
 #else
     // For Linux/macOS, use pkexec or sudo (this is simplified)
-    m_process->start("pkexec", QStringList() << cleanedPath);
+    return submit(cleanedPath, "pkexec", QStringList() << cleanedPath);
 #endif
 }
 
-void SRunner::executeCommand(const QString &command)
+int SRunner::executeCommand(const QString &command)
 {
     QString cleanedCommand = command.trimmed();
     if (cleanedCommand.isEmpty()) {
         emit executionError(command, "Empty command provided");
-        return;
+        return 0;
     }
 
     emit executionStarted(cleanedCommand);
 
 #ifdef Q_OS_WIN
-    m_process->start("cmd.exe", QStringList() << "/c" << cleanedCommand);
+    return submit(cleanedCommand, "cmd.exe", QStringList() << "/c" << cleanedCommand);
 #else
-    m_process->start("sh", QStringList() << "-c" << cleanedCommand);
+    return submit(cleanedCommand, "sh", QStringList() << "-c" << cleanedCommand);
 #endif
 }
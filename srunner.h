@@ -3,18 +3,24 @@
 
 #include <QObject>
 #include <QProcess>
+#include <QHash>
+
+class JobScheduler;
 
 class SRunner : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit SRunner(QObject *parent = nullptr);
+    // Commands run as jobs of the application's shared scheduler
+    explicit SRunner(JobScheduler *scheduler, QObject *parent = nullptr);
+
+    JobScheduler *jobScheduler() const;
 
-    Q_INVOKABLE void runExe(const QString &path);
-    Q_INVOKABLE void runExeInCmd(const QString &path);
-    Q_INVOKABLE void runExeAsAdmin(const QString &path);
-    Q_INVOKABLE void executeCommand(const QString &command);
+    Q_INVOKABLE int runExe(const QString &path);
+    Q_INVOKABLE int runExeInCmd(const QString &path);
+    Q_INVOKABLE int runExeAsAdmin(const QString &path);
+    Q_INVOKABLE int executeCommand(const QString &command);
 
 signals:
     void executionStarted(const QString &command);
@@ -22,7 +28,11 @@ signals:
     void executionError(const QString &command, const QString &error);
 
 private:
-    QProcess *m_process;
+    JobScheduler *m_scheduler;
+    QHash<int, QString> m_commands; // job id -> command reported in signals
+
+    int submit(const QString &command, const QString &program,
+               const QStringList &arguments, const QString &workingDirectory = QString());
 };
 
 #endif // SRUNNER_H
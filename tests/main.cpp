@@ -0,0 +1,32 @@
+#include "testsuite.h"
+#include <QGuiApplication>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+#include <QTest>
+#include <memory>
+
+int main(int argc, char *argv[])
+{
+    // Tests never need a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    app.setOrganizationName("ScriptRunnerTests");
+    app.setApplicationName("ScriptRunnerTests");
+    // Settings, history and caches go to throwaway test locations
+    QStandardPaths::setTestModeEnabled(true);
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    QStringList arguments = app.arguments();
+    QString only;
+    if (arguments.size() > 1 && TestSuite::registry().count(arguments.at(1)))
+        only = arguments.takeAt(1);
+
+    int failures = 0;
+    for (const auto &[name, create] : TestSuite::registry()) {
+        if (!only.isEmpty() && name != only) continue;
+        std::unique_ptr<QObject> test(create());
+        failures += QTest::qExec(test.get(), arguments);
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+#ifndef TESTSUITE_H
+#define TESTSUITE_H
+
+#include <QObject>
+#include <functional>
+#include <map>
+
+// All test classes live in the one tst_scriptrunner binary. Each test file
+// registers its class with SCRIPTRUNNER_TEST(Class); main() runs them in
+// name order, or just the one named on the command line.
+namespace TestSuite {
+
+using Factory = std::function<QObject *()>;
+
+inline std::map<QString, Factory> &registry()
+{
+    static std::map<QString, Factory> classes;
+    return classes;
+}
+
+struct Registration
+{
+    Registration(const char *name, Factory factory)
+    {
+        registry().emplace(QString::fromLatin1(name), std::move(factory));
+    }
+};
+
+} // namespace TestSuite
+
+#define SCRIPTRUNNER_TEST(Class) \
+    static const TestSuite::Registration Class##Registration(#Class, []() -> QObject * { return new Class; });
+
+#endif // TESTSUITE_H
@@ -0,0 +1,47 @@
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+namespace TestUtil {
+
+// A generated catalog of count "exe" actions spread over 20 categories.
+// Every action gets the keys of extra on top of the generated ones.
+inline QByteArray catalogJson(int count, const QJsonObject &extra = QJsonObject())
+{
+    static const char *const Words[] = { "build", "deploy", "backup", "convert", "resize",
+                                         "clean", "sync", "archive", "render", "upload" };
+    QJsonArray actions;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject action {
+            { "id", QString("action-%1").arg(i) },
+            { "name", QString("%1 %2 %3").arg(Words[i % 10], Words[(i / 10) % 10]).arg(i) },
+            { "category", QString("category-%1").arg(i % 20) },
+            { "description", QString("Generated action number %1").arg(i) },
+            { "type", "exe" },
+            { "command", "true" },
+        };
+        for (auto it = extra.constBegin(); it != extra.constEnd(); ++it) action.insert(it.key(), it.value());
+        actions.append(action);
+    }
+    return QJsonDocument(QJsonObject { { "actions", actions } }).toJson(QJsonDocument::Compact);
+}
+
+inline QString writeFile(const QString &directory, const QString &name, const QByteArray &data)
+{
+    const QString path = QDir(directory).filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return QString();
+    file.write(data);
+    return path;
+}
+
+} // namespace TestUtil
+
+#endif // TESTUTIL_H
@@ -0,0 +1,251 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "actionmanager.h"
+#include "catalogcache.h"
+#include "jobscheduler.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+class ActionCatalogTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void loadsAndFindsActions();
+    void cacheFollowsContent();
+    void cacheKeepsTypedFields();
+    void loadErrors();
+    void reloadsAfterSaveByRename();
+    void coldVersusCachedLoad_data();
+    void coldVersusCachedLoad();
+    void lookup_data();
+    void lookup();
+    void executeDispatch_data();
+    void executeDispatch();
+
+private:
+    QTemporaryDir m_dir;
+
+    QString writeCatalog(int count, const QJsonObject &extra = QJsonObject());
+};
+
+QString ActionCatalogTest::writeCatalog(int count, const QJsonObject &extra)
+{
+    return TestUtil::writeFile(m_dir.path(), QString("actions-%1.json").arg(count),
+                               TestUtil::catalogJson(count, extra));
+}
+
+static void addSizes()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10") << 10;
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("100k") << 100000;
+}
+
+// A spread of existing ids, so lookups don't keep hitting the same bucket
+static QStringList sampleIds(int count, int samples)
+{
+    QStringList ids;
+    for (int i = 0; i < samples; ++i) ids.append(QString("action-%1").arg((qint64(i) * 7919) % count));
+    return ids;
+}
+
+void ActionCatalogTest::loadsAndFindsActions()
+{
+    ActionManager manager;
+    QVERIFY(manager.loadActions(writeCatalog(40)));
+
+    QCOMPARE(manager.actions().size(), 40);
+    QCOMPARE(manager.categoriesKeys().size(), 20);
+
+    const ActionDefinition *action = manager.findAction("action-23");
+    QVERIFY(action);
+    QCOMPARE(action->id, QString("action-23"));
+    QCOMPARE(action->category, QString("category-3"));
+    QCOMPARE(action->kind, ActionDefinition::Exe);
+    QVERIFY(!manager.findAction("action-40"));
+}
+
+void ActionCatalogTest::cacheFollowsContent()
+{
+    const QString path = writeCatalog(30);
+    {
+        ActionManager manager;
+        QVERIFY(manager.loadActions(path));
+    }
+    QVERIFY(QFile::exists(CatalogCache::cachePath(path)));
+    const QDateTime modified = QFileInfo(path).lastModified();
+
+    // Same size, same timestamp, different content
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+    data.replace("Generated action number 7\"", "Rewritten action number 7\"");
+    QVERIFY(file.seek(0));
+    QCOMPARE(file.write(data), data.size());
+    QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    file.close();
+    QCOMPARE(QFileInfo(path).lastModified(), modified);
+
+    ActionManager manager;
+    QVERIFY(manager.loadActions(path));
+    const ActionDefinition *action = manager.findAction("action-7");
+    QVERIFY(action);
+    QCOMPARE(action->description, QString("Rewritten action number 7"));
+}
+
+void ActionCatalogTest::cacheKeepsTypedFields()
+{
+    const QString path = TestUtil::writeFile(m_dir.path(), "typed.json", TestUtil::catalogJson(3, QJsonObject {
+        { "batch", "chunked" },
+        { "max_parallel", 6 },
+    }));
+    {
+        ActionManager manager;
+        QVERIFY(manager.loadActions(path));
+    }
+
+    QVector<ActionDefinition> actions;
+    QJsonObject pools;
+    QVERIFY(CatalogCache::load(path, &actions, &pools));
+    QCOMPARE(actions.size(), 3);
+    QCOMPARE(actions.at(2).batchMode, ActionDefinition::Chunked);
+    QCOMPARE(actions.at(2).maxParallel, 6);
+}
+
+void ActionCatalogTest::loadErrors()
+{
+    QByteArray json = TestUtil::catalogJson(5);
+    json.replace(R"("id":"action-1",)", R"("id":"action-1","max_parallel":"many",)");
+    json.replace(R"("id":"action-3")", R"("id":"action-2")");
+    const QString path = TestUtil::writeFile(m_dir.path(), "broken.json", json);
+
+    // Broken entries are left out and reported, the rest loads
+    ActionManager manager;
+    QVERIFY(manager.loadActions(path));
+    QCOMPARE(manager.actions().size(), 3);
+    QVERIFY(!manager.findAction("action-1"));
+    QCOMPARE(manager.findAction("action-2")->name, QString("backup build 2"));
+    QCOMPARE(manager.loadErrors(), QStringList({
+        "$.actions[1].max_parallel: must be a number from 0 to 1024",
+        "$.actions[3].id: duplicate action id \"action-2\", the first one is used",
+    }));
+
+    // Not cached while broken, so the errors come back on the next start
+    QVERIFY(!QFile::exists(CatalogCache::cachePath(path)));
+
+    // A file that doesn't parse keeps the old catalog
+    TestUtil::writeFile(m_dir.path(), "broken.json", R"({"actions": 3})");
+    QVERIFY(!manager.reloadActions());
+    QCOMPARE(manager.loadErrors(), QStringList { "$.actions: must be an array" });
+    QCOMPARE(manager.actions().size(), 3);
+
+    TestUtil::writeFile(m_dir.path(), "broken.json", TestUtil::catalogJson(5));
+    QVERIFY(manager.reloadActions());
+    QVERIFY(manager.loadErrors().isEmpty());
+    QCOMPARE(manager.actions().size(), 5);
+    QVERIFY(QFile::exists(CatalogCache::cachePath(path)));
+}
+
+void ActionCatalogTest::reloadsAfterSaveByRename()
+{
+    QTemporaryDir dir;
+    const QString path = TestUtil::writeFile(dir.path(), "actions.json", TestUtil::catalogJson(2));
+    ActionManager manager;
+    QVERIFY(manager.loadActions(path));
+    manager.setWatchEnabled(true);
+
+    // Written next to the file, then moved into its place, as most editors do;
+    // the second save only works if the first one re-armed the watch
+    for (int count : { 3, 4 }) {
+        QSignalSpy added(&manager, &ActionManager::actionAdded);
+        const QString temp = TestUtil::writeFile(dir.path(), "actions.json.tmp", TestUtil::catalogJson(count));
+        QVERIFY(QFile::remove(path));
+        QVERIFY(QFile::rename(temp, path));
+        QTRY_COMPARE_WITH_TIMEOUT(manager.actions().size(), count, 5000);
+        QCOMPARE(added.count(), 1);
+    }
+}
+
+void ActionCatalogTest::coldVersusCachedLoad_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("cached");
+    for (int count : { 1000, 10000, 100000 }) {
+        QTest::addRow("json %d", count) << count << false;
+        QTest::addRow("cache %d", count) << count << true;
+    }
+}
+
+void ActionCatalogTest::coldVersusCachedLoad()
+{
+    QFETCH(int, count);
+    QFETCH(bool, cached);
+    const QString path = writeCatalog(count);
+    const QString cachePath = CatalogCache::cachePath(path);
+    QFile::remove(cachePath);
+    if (cached) {
+        ActionManager manager;
+        QVERIFY(manager.loadActions(path));
+        QVERIFY(QFile::exists(cachePath));
+    }
+
+    // A cold load also writes the cache; that is part of its price
+    QBENCHMARK {
+        if (!cached) QFile::remove(cachePath);
+        ActionManager manager;
+        QVERIFY(manager.loadActions(path));
+        QCOMPARE(manager.actions().size(), count);
+    }
+}
+
+void ActionCatalogTest::lookup_data()
+{
+    addSizes();
+}
+
+void ActionCatalogTest::lookup()
+{
+    QFETCH(int, count);
+    ActionManager manager;
+    QVERIFY(manager.loadActions(writeCatalog(count)));
+    const QStringList ids = sampleIds(count, 1000);
+
+    // 1000 lookups per iteration
+    int found = 0;
+    QBENCHMARK {
+        for (const QString &id : ids) found += manager.findAction(id) != nullptr;
+    }
+    QVERIFY(found > 0);
+}
+
+void ActionCatalogTest::executeDispatch_data()
+{
+    addSizes();
+}
+
+void ActionCatalogTest::executeDispatch()
+{
+    QFETCH(int, count);
+    JobScheduler scheduler;
+    ActionManager manager;
+    manager.setJobScheduler(&scheduler);
+    // Tracked, so a run is a queued job; the event loop never runs, so
+    // nothing is spawned and only the dispatch path is measured
+    QVERIFY(manager.loadActions(writeCatalog(count, { { "detached", false } })));
+    const QStringList ids = sampleIds(count, 1000);
+
+    int next = 0;
+    QBENCHMARK {
+        manager.executeAction(ids.at(next++ % ids.size()));
+    }
+    QCOMPARE(scheduler.queuedCount(), next);
+    scheduler.cancelAll();
+}
+
+SCRIPTRUNNER_TEST(ActionCatalogTest)
+#include "tst_actioncatalog.moc"
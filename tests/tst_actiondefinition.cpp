@@ -0,0 +1,192 @@
+#include "testsuite.h"
+#include "actiondefinition.h"
+#include "actionschema.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTest>
+
+class ActionDefinitionTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void validateRoot_data();
+    void validateRoot();
+    void validateAction_data();
+    void validateAction();
+    void typedFields();
+    void resolveInputs_data();
+    void resolveInputs();
+
+private:
+    static QJsonObject json(const char *text) { return QJsonDocument::fromJson(text).object(); }
+};
+
+void ActionDefinitionTest::validateRoot_data()
+{
+    QTest::addColumn<QByteArray>("root");
+    QTest::addColumn<QStringList>("errors");
+
+    QTest::newRow("valid") << QByteArray(R"({"actions": [], "pools": {"py": {"program": "python3"}}})")
+                           << QStringList();
+    QTest::newRow("no actions") << QByteArray("{}") << QStringList { "$.actions: is required" };
+    QTest::newRow("actions not an array") << QByteArray(R"({"actions": {}})")
+                                          << QStringList { "$.actions: must be an array" };
+    QTest::newRow("pools not an object") << QByteArray(R"({"actions": [], "pools": []})")
+                                         << QStringList { "$.pools: must be an object" };
+    QTest::newRow("pool without program") << QByteArray(R"({"actions": [], "pools": {"py": {"size": 100}}})")
+                                          << QStringList { "$.pools.py.program: is required",
+                                                           "$.pools.py.size: must be a number from 1 to 64" };
+}
+
+void ActionDefinitionTest::validateRoot()
+{
+    QFETCH(QByteArray, root);
+    QFETCH(QStringList, errors);
+    QCOMPARE(ActionSchema::validateRoot(QJsonDocument::fromJson(root).object()), errors);
+}
+
+void ActionDefinitionTest::validateAction_data()
+{
+    QTest::addColumn<QByteArray>("action");
+    QTest::addColumn<QString>("error"); // Empty when the action is valid
+
+    QTest::newRow("minimal") << QByteArray(R"({"id": "a", "type": "exe", "command": "true"})") << QString();
+    QTest::newRow("everything") << QByteArray(R"({"id": "a", "type": "exe_with_args", "command": "tool {mode} {file}",
+        "inputs": [{"id": "file", "type": "file", "filters": "*.txt"},
+                   {"id": "mode", "type": "choice", "choices": ["fast", "slow"], "default": "fast"},
+                   {"id": "force", "type": "bool", "true_value": "-f", "false_value": ""}],
+        "pool": "py", "detached": false, "cacheable": true, "limits": {"timeout_sec": 10, "nice": 5},
+        "schedule": "*/5 * * * *", "watch": {"path": "/tmp", "patterns": ["*.txt"]},
+        "batch": "chunked", "max_parallel": 4})") << QString();
+    QTest::newRow("not an object") << QByteArray("[1]") << QString("$.actions[0]: must be an object");
+    QTest::newRow("no id") << QByteArray(R"({"type": "exe", "command": "true"})")
+                           << QString("$.actions[0].id: is required");
+    QTest::newRow("unknown type") << QByteArray(R"({"id": "a", "type": "script", "command": "true"})")
+                                  << QString("$.actions[0].type: unknown type \"script\"");
+    QTest::newRow("no command") << QByteArray(R"({"id": "a", "type": "exe"})")
+                                << QString("$.actions[0].command: is required");
+    QTest::newRow("name not a string") << QByteArray(R"({"id": "a", "name": 3, "type": "exe", "command": "true"})")
+                                       << QString("$.actions[0].name: must be a string");
+    QTest::newRow("unknown input type")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "inputs": [{"id": "x", "type": "files"}]})")
+        << QString("$.actions[0].inputs[0].type: unknown input type \"files\"");
+    QTest::newRow("duplicate input")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "inputs": [{"id": "x"}, {"id": "x"}]})")
+        << QString("$.actions[0].inputs[1].id: duplicate input id \"x\"");
+    QTest::newRow("choice without choices")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "inputs": [{"id": "x", "type": "choice"}]})")
+        << QString("$.actions[0].inputs[0].choices: is required for choice inputs");
+    QTest::newRow("true_value on text")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "inputs": [{"id": "x", "true_value": "y"}]})")
+        << QString("$.actions[0].inputs[0].true_value: only applies to bool inputs");
+    QTest::newRow("unknown pool") << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "pool": "node"})")
+                                  << QString("$.actions[0].pool: no pool named \"node\"");
+    QTest::newRow("limit out of range")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "limits": {"nice": 40}})")
+        << QString("$.actions[0].limits.nice: must be a number from -20 to 19");
+    QTest::newRow("unknown limit")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "limits": {"memory": 1}})")
+        << QString("$.actions[0].limits.memory: is not a known key");
+    QTest::newRow("bad schedule") << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "schedule": "soon"})")
+                                  << QString("$.actions[0].schedule: ");
+    QTest::newRow("watch without path")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "watch": {"recursive": true}})")
+        << QString("$.actions[0].watch.path: is required");
+    QTest::newRow("unknown batch mode") << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "batch": "all"})")
+                                        << QString("$.actions[0].batch: must be per_file or chunked");
+    QTest::newRow("negative max_parallel")
+        << QByteArray(R"({"id": "a", "type": "exe", "command": "true", "max_parallel": -1})")
+        << QString("$.actions[0].max_parallel: must be a number from 0 to 1024");
+}
+
+void ActionDefinitionTest::validateAction()
+{
+    QFETCH(QByteArray, action);
+    QFETCH(QString, error);
+
+    const QJsonValue value = QJsonDocument::fromJson("[" + action + "]").array().first();
+    const QStringList errors = ActionSchema::validateAction(value, "$.actions[0]", json(R"({"py": {}})"));
+    if (error.isEmpty()) {
+        QVERIFY2(errors.isEmpty(), qPrintable(errors.join('\n')));
+    } else {
+        QCOMPARE(errors.size(), 1);
+        QVERIFY2(errors.first().startsWith(error), qPrintable(errors.first()));
+    }
+}
+
+void ActionDefinitionTest::typedFields()
+{
+    const ActionDefinition chunked = ActionDefinition::fromJson(
+        json(R"({"id": "a", "type": "exe", "command": "true {files}", "batch": "chunked", "max_parallel": 3})"));
+    QCOMPARE(chunked.batchMode, ActionDefinition::Chunked);
+    QCOMPARE(chunked.maxParallel, 3);
+    QCOMPARE(chunked.object().value("batch").toString(), QString("chunked"));
+
+    const ActionDefinition plain = ActionDefinition::fromJson(json(R"({"id": "b", "type": "exe", "command": "true"})"));
+    QCOMPARE(plain.batchMode, ActionDefinition::PerFile);
+    QCOMPARE(plain.maxParallel, 0);
+    QVERIFY(plain.detached);
+}
+
+void ActionDefinitionTest::resolveInputs_data()
+{
+    QTest::addColumn<QVariantMap>("given");
+    QTest::addColumn<bool>("pathsProvided");
+    QTest::addColumn<bool>("ok");
+    QTest::addColumn<QVariantMap>("resolved");
+
+    const QVariantMap defaults { { "name", "world" }, { "verbose", "" }, { "mode", "fast" } };
+    QTest::newRow("defaults") << QVariantMap { { "file", "/tmp/a.txt" } } << false << true
+                              << QVariantMap { { "file", "/tmp/a.txt" }, { "name", "world" }, { "verbose", "" },
+                                               { "mode", "fast" } };
+    QTest::newRow("given wins") << QVariantMap { { "file", "/tmp/a.txt" }, { "name", "there" }, { "mode", "slow" } }
+                                << false << true
+                                << QVariantMap { { "file", "/tmp/a.txt" }, { "name", "there" }, { "verbose", "" },
+                                                 { "mode", "slow" } };
+    QTest::newRow("empty text takes the default") << QVariantMap { { "file", "/tmp/a.txt" }, { "name", "" } }
+                                                  << false << true
+                                                  << QVariantMap { { "file", "/tmp/a.txt" }, { "name", "world" },
+                                                                   { "verbose", "" }, { "mode", "fast" } };
+    QTest::newRow("bool true") << QVariantMap { { "file", "/tmp/a.txt" }, { "verbose", true } } << false << true
+                               << QVariantMap { { "file", "/tmp/a.txt" }, { "name", "world" }, { "verbose", "-v" },
+                                                { "mode", "fast" } };
+    QTest::newRow("bool as text") << QVariantMap { { "file", "/tmp/a.txt" }, { "verbose", "1" } } << false << true
+                                  << QVariantMap { { "file", "/tmp/a.txt" }, { "name", "world" }, { "verbose", "-v" },
+                                                   { "mode", "fast" } };
+    QTest::newRow("required missing") << QVariantMap() << false << false << QVariantMap();
+    QTest::newRow("paths provided") << QVariantMap() << true << true << defaults;
+}
+
+void ActionDefinitionTest::resolveInputs()
+{
+    QFETCH(QVariantMap, given);
+    QFETCH(bool, pathsProvided);
+    QFETCH(bool, ok);
+    QFETCH(QVariantMap, resolved);
+
+    const ActionDefinition action = ActionDefinition::fromJson(json(R"({
+        "id": "greet", "type": "exe_with_args", "command": "greet {verbose:raw} {name} {mode} {file}",
+        "inputs": [
+            {"id": "file", "type": "file", "required": true},
+            {"id": "name", "default": "world"},
+            {"id": "verbose", "type": "bool", "default": false, "true_value": "-v", "false_value": ""},
+            {"id": "mode", "type": "choice", "choices": ["fast", "slow"], "default": "fast"},
+            {"id": "note"}
+        ]})"));
+    QVERIFY(action.hasNonFileInputs);
+
+    QVariantMap result;
+    QString error;
+    QCOMPARE(action.resolveInputs(given, &result, &error, pathsProvided), ok);
+    if (ok) {
+        QCOMPARE(result, resolved);
+        QVERIFY(error.isEmpty());
+    } else {
+        QCOMPARE(error, QString("Input 'file' is required"));
+    }
+}
+
+SCRIPTRUNNER_TEST(ActionDefinitionTest)
+#include "tst_actiondefinition.moc"
@@ -0,0 +1,108 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "actionmanager.h"
+#include "actionmodels.h"
+#include <QMap>
+#include <QTemporaryDir>
+#include <QTest>
+
+class ActionModelsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void build_data();
+    void build();
+    void open_data();
+    void open();
+
+private:
+    QTemporaryDir m_dir;
+
+    bool load(ActionManager *manager, int count);
+};
+
+bool ActionModelsTest::load(ActionManager *manager, int count)
+{
+    const QString path = TestUtil::writeFile(m_dir.path(), QString("actions-%1.json").arg(count),
+                                             TestUtil::catalogJson(count));
+    return manager->loadActions(path);
+}
+
+static void addSizes()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+}
+
+// Category name -> action ids, as ActionManager hands it to the model
+static QMap<QString, QStringList> categories(const ActionManager &manager)
+{
+    QMap<QString, QStringList> result;
+    for (const ActionDefinition &action : manager.actions()) result[action.category].append(action.id);
+    return result;
+}
+
+void ActionModelsTest::build_data()
+{
+    addSizes();
+}
+
+void ActionModelsTest::build()
+{
+    QFETCH(int, count);
+    ActionManager manager;
+    QVERIFY(load(&manager, count));
+    const QMap<QString, QStringList> ids = categories(manager);
+
+    // A reload rebuilds the models in place; the old ones go on the next
+    // pass of the event loop, which is part of the cost
+    ActionCategoryModel model(&manager);
+    QBENCHMARK {
+        model.reset(ids);
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+
+    QCOMPARE(model.rowCount(), 20);
+    QCOMPARE(model.actions("category-0")->rowCount(), count / 20);
+}
+
+void ActionModelsTest::open_data()
+{
+    addSizes();
+}
+
+void ActionModelsTest::open()
+{
+    QFETCH(int, count);
+    ActionManager manager;
+    QVERIFY(load(&manager, count));
+    const ActionCategoryModel *model = manager.categoryModel();
+
+    // What the menu reads when it opens: every tab, then the delegates of
+    // the first tab's visible cells
+    const int visibleCells = 16;
+    int read = 0;
+    QBENCHMARK {
+        for (int row = 0; row < model->rowCount(); ++row) {
+            const QModelIndex index = model->index(row);
+            read += !model->data(index, ActionCategoryModel::DisplayNameRole).toString().isEmpty();
+            model->data(index, ActionCategoryModel::ActionsRole);
+        }
+
+        const ActionListModel *actions = model->actions(model->data(model->index(0),
+                                                                    ActionCategoryModel::NameRole).toString());
+        for (int row = 0; row < qMin(visibleCells, actions->rowCount()); ++row) {
+            const QModelIndex index = actions->index(row);
+            read += !actions->data(index, ActionListModel::NameRole).toString().isEmpty();
+            actions->data(index, ActionListModel::IconRole);
+            actions->data(index, ActionListModel::TypeRole);
+            actions->data(index, ActionListModel::ActionIdRole);
+        }
+    }
+    QVERIFY(read > 0);
+}
+
+SCRIPTRUNNER_TEST(ActionModelsTest)
+#include "tst_actionmodels.moc"
@@ -0,0 +1,149 @@
+#include "testsuite.h"
+#include "actionsearchindex.h"
+#include <QTest>
+
+class ActionSearchTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void exactMatch();
+    void prefixMatch();
+    void wordPrefixMatch();
+    void fuzzyMatch();
+    void ranking();
+    void shortQueryUsesWordPrefixes();
+    void removedActionsAreNotFound();
+    void queryLatency_data();
+    void queryLatency();
+
+private:
+    ActionSearchIndex m_index;
+
+    QStringList ids(const QString &query, int limit = 20) const;
+    int scoreOf(const QString &query, const QString &actionId) const;
+};
+
+QStringList ActionSearchTest::ids(const QString &query, int limit) const
+{
+    QStringList result;
+    for (const ActionSearchIndex::Match &match : m_index.search(query, limit)) result.append(match.actionId);
+    return result;
+}
+
+int ActionSearchTest::scoreOf(const QString &query, const QString &actionId) const
+{
+    for (const ActionSearchIndex::Match &match : m_index.search(query, 100)) {
+        if (match.actionId == actionId) return match.score;
+    }
+    return -1;
+}
+
+void ActionSearchTest::init()
+{
+    // One document per tier for the query "backup"
+    m_index.clear();
+    m_index.insert({ "backup", "Run Snapshot", "", "tools" });               // Exact id
+    m_index.insert({ "b1", "Backup", "", "tools" });                         // Exact name
+    m_index.insert({ "b2", "Backup Photos", "", "tools" });                  // Name prefix
+    m_index.insert({ "b3", "Nightly backup job", "", "tools" });             // Word prefix
+    m_index.insert({ "b4", "Offsitebackups", "", "tools" });                 // Substring
+    m_index.insert({ "b5", "Backpup mirror", "", "tools" });                 // Typo
+    m_index.insert({ "c1", "Convert Images", "Resize and convert", "media" }); // Unrelated
+}
+
+void ActionSearchTest::exactMatch()
+{
+    QCOMPARE(ids("backup").value(0), QString("backup"));
+    QCOMPARE(ids("Convert Images").value(0), QString("c1"));
+    QVERIFY(scoreOf("backup", "backup") > scoreOf("backup", "b1"));
+}
+
+void ActionSearchTest::prefixMatch()
+{
+    QVERIFY(ids("backup ph").contains("b2"));
+    QVERIFY(scoreOf("backup", "b2") > scoreOf("backup", "b3"));
+}
+
+void ActionSearchTest::wordPrefixMatch()
+{
+    // "back" starts the second word only
+    QVERIFY(ids("back").contains("b3"));
+    QVERIFY(scoreOf("backup", "b3") > scoreOf("backup", "b4"));
+    // A word prefix must stay inside the word
+    QVERIFY(scoreOf("backup j", "b3") < scoreOf("backup", "b3"));
+}
+
+void ActionSearchTest::fuzzyMatch()
+{
+    QVERIFY(ids("backup").contains("b5"));
+    QVERIFY(ids("nightlly backup").contains("b3"));
+    QVERIFY(!ids("backup").contains("c1"));
+    QVERIFY(scoreOf("backup", "b5") < scoreOf("backup", "b4"));
+}
+
+void ActionSearchTest::ranking()
+{
+    const QStringList expected { "backup", "b1", "b2", "b3", "b4", "b5" };
+    QCOMPARE(ids("backup"), expected);
+    QCOMPARE(ids("BACKUP"), expected);
+    QCOMPARE(ids("backup", 3), expected.mid(0, 3));
+}
+
+void ActionSearchTest::shortQueryUsesWordPrefixes()
+{
+    const QStringList found = ids("ni");
+    QCOMPARE(found, QStringList { "b3" });
+    QVERIFY(ids("co").contains("c1"));
+    QVERIFY(ids("x").isEmpty());
+}
+
+void ActionSearchTest::removedActionsAreNotFound()
+{
+    m_index.remove("b1");
+    QVERIFY(!ids("backup").contains("b1"));
+    QCOMPARE(m_index.size(), 6);
+
+    // Re-inserting replaces the old document
+    m_index.insert({ "b2", "Photo Backup", "", "tools" });
+    QVERIFY(scoreOf("backup", "b2") < 900);
+    QCOMPARE(m_index.size(), 6);
+}
+
+void ActionSearchTest::queryLatency_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QString>("query");
+
+    // The search box wants an answer within 1 ms at 100k actions
+    for (int count : { 1000, 10000, 100000 }) {
+        QTest::addRow("short %d", count) << count << "ba";
+        QTest::addRow("word %d", count) << count << "backup";
+        QTest::addRow("typo %d", count) << count << "bakcup deploy";
+    }
+}
+
+void ActionSearchTest::queryLatency()
+{
+    QFETCH(int, count);
+    QFETCH(QString, query);
+    static const char *const Words[] = { "build", "deploy", "backup", "convert", "resize",
+                                         "clean", "sync", "archive", "render", "upload" };
+    ActionSearchIndex index;
+    for (int i = 0; i < count; ++i) {
+        index.insert({ QString("action-%1").arg(i),
+                       QString("%1 %2 %3").arg(Words[i % 10], Words[(i / 10) % 10]).arg(i),
+                       QString("Generated action number %1").arg(i),
+                       QString("category-%1").arg(i % 20) });
+    }
+
+    int found = 0;
+    QBENCHMARK {
+        found = index.search(query, 20).size();
+    }
+    QVERIFY(found > 0);
+}
+
+SCRIPTRUNNER_TEST(ActionSearchTest)
+#include "tst_actionsearch.moc"
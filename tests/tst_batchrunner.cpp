@@ -0,0 +1,203 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "actiondefinition.h"
+#include "batchrunner.h"
+#include "jobscheduler.h"
+#include <QFile>
+#include <QJsonObject>
+#include <QSet>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+class BatchRunnerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyDropFails();
+    void cancelFromProgressSlot();
+    void fileNamesStayWhole_data();
+    void fileNamesStayWhole();
+    void chunkedPacking();
+    void maxParallel();
+
+private:
+    QTemporaryDir m_dir;
+
+    static ActionDefinition action(const QString &command, int maxParallel, const QString &batch = QString());
+    // A script that appends each of its arguments to log as one line
+    static QString argumentLogger(const QTemporaryDir &dir, const QString &log);
+    static QVariantMap runBatch(const ActionDefinition &action, const QStringList &paths, const QVariantMap &inputs);
+};
+
+ActionDefinition BatchRunnerTest::action(const QString &command, int maxParallel, const QString &batch)
+{
+    QJsonObject object {
+        { "id", "touch" },
+        { "name", "Touch" },
+        { "type", "exe" },
+        { "command", command },
+        { "max_parallel", maxParallel },
+    };
+    if (!batch.isEmpty()) object.insert("batch", batch);
+    return ActionDefinition::fromJson(object);
+}
+
+QString BatchRunnerTest::argumentLogger(const QTemporaryDir &dir, const QString &log)
+{
+    return TestUtil::writeFile(dir.path(), "log-arguments.sh",
+                               QString("for f in \"$@\"; do printf '%s\\n' \"$f\"; done >> '%1'\n").arg(log).toUtf8());
+}
+
+QVariantMap BatchRunnerTest::runBatch(const ActionDefinition &action, const QStringList &paths, const QVariantMap &inputs)
+{
+    JobScheduler scheduler;
+    BatchRunner runner(&scheduler);
+    QSignalSpy finished(&runner, &BatchRunner::batchFinished);
+    runner.start(action, paths, inputs);
+    if (!finished.wait(60000)) return QVariantMap();
+    return finished.first().at(2).toMap();
+}
+
+void BatchRunnerTest::emptyDropFails()
+{
+    JobScheduler scheduler;
+    BatchRunner runner(&scheduler);
+    QSignalSpy finished(&runner, &BatchRunner::batchFinished);
+
+    const int batchId = runner.start(action("true {file}", 0), { m_dir.filePath("nothing-*.txt") }, QVariantMap());
+    QTRY_COMPARE(finished.count(), 1);
+
+    QCOMPARE(finished.first().at(0).toInt(), batchId);
+    const QVariantMap summary = finished.first().at(2).toMap();
+    QCOMPARE(summary.value("total").toInt(), 0);
+    QVERIFY(!summary.value("error").toString().isEmpty());
+}
+
+void BatchRunnerTest::cancelFromProgressSlot()
+{
+    QStringList files;
+    for (int i = 0; i < 6; ++i) files.append(TestUtil::writeFile(m_dir.path(), QString("file%1.txt").arg(i), "x"));
+
+    JobScheduler scheduler;
+    BatchRunner runner(&scheduler);
+    QSignalSpy finished(&runner, &BatchRunner::batchFinished);
+
+    // Canceling from a slot drops the batch while complete() is emitting
+    int batchId = 0;
+    connect(&runner, &BatchRunner::batchProgress, this, [&](int id, int completed) {
+        if (id == batchId && completed == 1) runner.cancel(batchId);
+    });
+
+    batchId = runner.start(action("true {file}", 1), files, QVariantMap());
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 10000);
+
+    const QVariantMap summary = finished.first().at(2).toMap();
+    QVERIFY(summary.value("canceled").toBool());
+    QCOMPARE(summary.value("total").toInt(), files.size());
+    QVERIFY(summary.value("skipped").toInt() > 0);
+
+    // Nothing runs or reports for the batch afterwards
+    QTest::qWait(200);
+    QCOMPARE(finished.count(), 1);
+}
+
+void BatchRunnerTest::fileNamesStayWhole_data()
+{
+    QTest::addColumn<QString>("command");
+    QTest::addColumn<QString>("batch");
+
+    QTest::newRow("per file") << "sh {script} {file}" << "";
+    QTest::newRow("chunked") << "sh {script} {files}" << "chunked";
+    QTest::newRow("appended") << "sh {script}" << "chunked";
+    QTest::newRow("inside an argument") << "sh {script} --input={file}" << "";
+}
+
+void BatchRunnerTest::fileNamesStayWhole()
+{
+    QFETCH(QString, command);
+    QFETCH(QString, batch);
+
+    QTemporaryDir dir;
+    const QString log = dir.filePath("arguments.log");
+    const QString script = argumentLogger(dir, log);
+    QTemporaryDir files;
+    const QStringList names { "say \"hi\".txt", "two  spaces.txt", "\"\"\"quoted\"\"\".txt", "plain.txt" };
+    QStringList paths;
+    for (const QString &name : names) paths.append(TestUtil::writeFile(files.path(), name, "x"));
+
+    const QVariantMap summary = runBatch(action(command, 1, batch), { files.path() }, { { "script", script } });
+    QCOMPARE(summary.value("succeeded").toInt(), names.size());
+
+    QFile file(log);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QStringList logged = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+    const QString prefix = command.contains("--input=") ? "--input=" : "";
+    for (QString &line : logged) {
+        QVERIFY(line.startsWith(prefix));
+        line.remove(0, prefix.size());
+    }
+    logged.sort();
+    paths.sort();
+    QCOMPARE(logged, paths);
+}
+
+void BatchRunnerTest::chunkedPacking()
+{
+    // Enough long names to need more than one command line
+    const qsizetype limit = BatchRunner::commandLineLimit();
+    const int count = int(limit / 200) + 50;
+    if (count > 50000) QSKIP("Argument limit too large to fill in a test");
+
+    QTemporaryDir dir;
+    const QString log = dir.filePath("arguments.log");
+    const QString script = argumentLogger(dir, log);
+    QTemporaryDir files;
+    const QString padding(190, 'x');
+    QSet<QString> paths;
+    for (int i = 0; i < count; ++i)
+        paths.insert(TestUtil::writeFile(files.path(), QString("%1-%2.txt").arg(i, 6, 10, QChar('0')).arg(padding), QByteArray()));
+
+    const QVariantMap summary = runBatch(action("sh {script} {files}", 0, "chunked"), { files.path() },
+                                         { { "script", script } });
+    QCOMPARE(summary.value("total").toInt(), count);
+    QCOMPARE(summary.value("succeeded").toInt(), count);
+    QCOMPARE(summary.value("invocations").toInt(), 2);
+
+    // Every file reached the script exactly once
+    QFile file(log);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QStringList logged = QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(logged.size(), count);
+    QCOMPARE(QSet<QString>(logged.cbegin(), logged.cend()), paths);
+}
+
+void BatchRunnerTest::maxParallel()
+{
+    QTemporaryDir dir;
+    const QString script = TestUtil::writeFile(dir.path(), "wait.sh", "sleep 0.2\n");
+    QStringList files;
+    for (int i = 0; i < 8; ++i) files.append(TestUtil::writeFile(dir.path(), QString("file%1.txt").arg(i), "x"));
+
+    JobScheduler scheduler;
+    scheduler.setMaxConcurrency(8);
+    BatchRunner runner(&scheduler);
+    QSignalSpy finished(&runner, &BatchRunner::batchFinished);
+
+    int running = 0;
+    int peak = 0;
+    connect(&scheduler, &JobScheduler::jobStarted, this, [&]() { peak = qMax(peak, ++running); });
+    connect(&scheduler, &JobScheduler::jobFinished, this, [&]() { --running; });
+
+    runner.start(action("sh {script} {file}", 2), files, { { "script", script } });
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 10000);
+
+    const QVariantMap summary = finished.first().at(2).toMap();
+    QCOMPARE(summary.value("succeeded").toInt(), files.size());
+    QCOMPARE(summary.value("invocations").toInt(), files.size());
+    QCOMPARE(peak, 2);
+}
+
+SCRIPTRUNNER_TEST(BatchRunnerTest)
+#include "tst_batchrunner.moc"
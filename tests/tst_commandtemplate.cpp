@@ -0,0 +1,113 @@
+#include "testsuite.h"
+#include "commandtemplate.h"
+#include <QProcess>
+#include <QRegularExpression>
+#include <QTest>
+
+class CommandTemplateTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void render();
+    void renderArguments_data();
+    void renderArguments();
+    void renderVersusRegex_data();
+    void renderVersusRegex();
+};
+
+// What command building did before templates were compiled: a regex scan
+// of the source and a replace() over the whole string per placeholder
+static QString regexRender(const QString &source, const QVariantMap &inputs)
+{
+    QString result = source;
+    QRegularExpression re("\\{([^}]+)\\}"); // Built per call, as it was
+    QRegularExpressionMatchIterator it = re.globalMatch(source);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        const QString placeholder = match.captured(1);
+        result.replace("{" + placeholder + "}", CommandTemplate::escapeArgument(inputs.value(placeholder).toString()));
+    }
+    return result;
+}
+
+void CommandTemplateTest::render()
+{
+    const CommandTemplate tpl = CommandTemplate::compile("tool {file} --mode {mode:raw} {}");
+    QCOMPARE(tpl.render({ { "file", "a b.txt" }, { "mode", "fast" } }),
+             QString("tool \"a b.txt\" --mode fast {}"));
+    QCOMPARE(tpl.render({ { "file", "a.txt" } }), QString("tool a.txt --mode  {}"));
+}
+
+void CommandTemplateTest::renderArguments_data()
+{
+    QTest::addColumn<QString>("source");
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<QStringList>("expected");
+
+    QTest::newRow("plain") << "echo {v}" << "hello" << QStringList { "echo", "hello" };
+    QTest::newRow("spaces") << "echo {v}" << "a b" << QStringList { "echo", "a b" };
+    QTest::newRow("empty") << "echo {v} x" << "" << QStringList { "echo", "", "x" };
+    QTest::newRow("quotes stay inside")
+        << "echo {v}" << "a\" --evil \"b" << QStringList { "echo", "a\" --evil \"b" };
+    QTest::newRow("prefix") << "tool --out={v}" << "x y" << QStringList { "tool", "--out=x y" };
+    QTest::newRow("quoted in template")
+        << "tool \"{v} done\"" << "a\"b" << QStringList { "tool", "a\"b done" };
+    QTest::newRow("raw is split") << "tool {v:raw}" << "-a \"b c\"" << QStringList { "tool", "-a", "b c" };
+    QTest::newRow("triple quote literal")
+        << "tool \"say \"\"\"hi\"\"\"\"" << "" << QStringList { "tool", "say \"hi\"" };
+}
+
+void CommandTemplateTest::renderArguments()
+{
+    QFETCH(QString, source);
+    QFETCH(QString, value);
+    QFETCH(QStringList, expected);
+
+    const CommandTemplate tpl = CommandTemplate::compile(source);
+    QCOMPARE(tpl.renderArguments({ { "v", value } }), expected);
+
+    // Without placeholders the split is exactly QProcess's
+    if (!tpl.hasPlaceholders()) QCOMPARE(expected, QProcess::splitCommand(source));
+}
+
+void CommandTemplateTest::renderVersusRegex_data()
+{
+    QTest::addColumn<int>("placeholders");
+    QTest::addColumn<bool>("compiled");
+    for (int count : { 1, 5, 10, 25, 50 }) {
+        QTest::addRow("regex %d", count) << count << false;
+        QTest::addRow("compiled %d", count) << count << true;
+    }
+}
+
+void CommandTemplateTest::renderVersusRegex()
+{
+    QFETCH(int, placeholders);
+    QFETCH(bool, compiled);
+
+    QString source = "tool";
+    QVariantMap inputs;
+    for (int i = 0; i < placeholders; ++i) {
+        source += QString(" --opt%1 {arg%1}").arg(i);
+        inputs.insert(QString("arg%1").arg(i), i % 2 ? QString("value %1").arg(i) : QString("v%1").arg(i));
+    }
+    const CommandTemplate tpl = CommandTemplate::compile(source);
+    QCOMPARE(tpl.render(inputs), regexRender(source, inputs));
+
+    // The template is compiled once at load; only rendering runs per launch
+    QString command;
+    if (compiled) {
+        QBENCHMARK {
+            command = tpl.render(inputs);
+        }
+    } else {
+        QBENCHMARK {
+            command = regexRender(source, inputs);
+        }
+    }
+    QVERIFY(!command.isEmpty());
+}
+
+SCRIPTRUNNER_TEST(CommandTemplateTest)
+#include "tst_commandtemplate.moc"
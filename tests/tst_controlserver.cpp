@@ -0,0 +1,200 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "actionmanager.h"
+#include "controlserver.h"
+#include "jobscheduler.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTest>
+#include <memory>
+#include <vector>
+
+// One control connection; replies and events are collected as they arrive
+class ControlClient : public QObject
+{
+public:
+    QLocalSocket socket;
+    QList<QJsonObject> messages;
+
+    explicit ControlClient(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+        connect(&socket, &QLocalSocket::readyRead, this, [this]() {
+            while (socket.canReadLine())
+                messages.append(QJsonDocument::fromJson(socket.readLine()).object());
+        });
+    }
+
+    bool connectToServer()
+    {
+        socket.connectToServer(ControlServer::serverName());
+        return socket.waitForConnected(2000);
+    }
+
+    void request(const QJsonObject &message)
+    {
+        socket.write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+    }
+
+    QList<QJsonObject> events(const QString &event) const
+    {
+        QList<QJsonObject> matching;
+        for (const QJsonObject &message : messages) {
+            if (message.value("event").toString() == event) matching.append(message);
+        }
+        return matching;
+    }
+
+    int replies() const
+    {
+        int count = 0;
+        for (const QJsonObject &message : messages) count += message.contains("id");
+        return count;
+    }
+};
+
+class ControlServerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void watchReportsOwnRunOnly();
+    void detachedRunIsDoneAtOnce();
+    void concurrentClients_data();
+    void concurrentClients();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_actionsPath;
+    std::unique_ptr<JobScheduler> m_scheduler;
+    std::unique_ptr<ActionManager> m_actions;
+    std::unique_ptr<ControlServer> m_server;
+};
+
+void ControlServerTest::initTestCase()
+{
+    // Never talk to a real instance of the user
+    qputenv("SCRIPTRUNNER_SOCKET", QString("ScriptRunnerTest-%1").arg(QCoreApplication::applicationPid()).toUtf8());
+
+#ifdef Q_OS_WIN
+    const QString echo = "cmd /c echo hi";
+#else
+    const QString echo = "sh -c \"echo hi\"";
+#endif
+    const QJsonArray actions {
+        QJsonObject { { "id", "echo" }, { "name", "Echo" }, { "type", "exe" },
+                      { "command", echo }, { "detached", false } },
+        QJsonObject { { "id", "gui" }, { "name", "Gui" }, { "type", "exe" }, { "command", echo } },
+    };
+    m_actionsPath = TestUtil::writeFile(m_dir.path(), "actions.json",
+                                        QJsonDocument(QJsonObject { { "actions", actions } }).toJson());
+    QVERIFY(!m_actionsPath.isEmpty());
+}
+
+void ControlServerTest::init()
+{
+    m_scheduler = std::make_unique<JobScheduler>();
+    m_actions = std::make_unique<ActionManager>();
+    m_actions->setJobScheduler(m_scheduler.get());
+    QVERIFY(m_actions->loadActions(m_actionsPath));
+    m_server = std::make_unique<ControlServer>(m_actions.get(), m_scheduler.get());
+    QVERIFY(m_server->listen());
+}
+
+void ControlServerTest::cleanup()
+{
+    m_server.reset();
+    m_actions.reset();
+    m_scheduler.reset();
+}
+
+void ControlServerTest::watchReportsOwnRunOnly()
+{
+    ControlClient watcher;
+    ControlClient other;
+    QVERIFY(watcher.connectToServer());
+    QVERIFY(other.connectToServer());
+
+    // The same action, run by the GUI and by another client around the watched run
+    m_actions->executeAction("echo");
+    other.request({ { "id", 1 }, { "cmd", "run" }, { "action", "echo" } });
+    watcher.request({ { "id", 2 }, { "cmd", "run" }, { "action", "echo" }, { "watch", true } });
+    QTRY_COMPARE_WITH_TIMEOUT(other.replies(), 1, 5000);
+    m_actions->executeAction("echo");
+
+    QTRY_COMPARE_WITH_TIMEOUT(watcher.events("done").size(), 1, 10000);
+    QTRY_COMPARE_WITH_TIMEOUT(m_scheduler->runningCount() + m_scheduler->queuedCount(), 0, 10000);
+    QTest::qWait(100);
+
+    QCOMPARE(watcher.events("done").size(), 1);
+    QVERIFY(watcher.events("done").constFirst().value("success").toBool());
+    QVERIFY(other.events("done").isEmpty());
+
+    QSet<int> jobs;
+    for (const QJsonObject &event : watcher.events("job")) jobs.insert(event.value("job").toInt());
+    QCOMPARE(jobs.size(), 1);
+
+    QStringList lines;
+    for (const QJsonObject &event : watcher.events("output")) {
+        for (const QJsonValue &line : event.value("lines").toArray()) lines.append(line.toString().trimmed());
+    }
+    QCOMPARE(lines, QStringList { "hi" });
+}
+
+void ControlServerTest::detachedRunIsDoneAtOnce()
+{
+    ControlClient watcher;
+    QVERIFY(watcher.connectToServer());
+    watcher.request({ { "id", 1 }, { "cmd", "run" }, { "action", "gui" }, { "watch", true } });
+
+    QTRY_COMPARE_WITH_TIMEOUT(watcher.events("done").size(), 1, 5000);
+    QVERIFY(watcher.events("job").isEmpty());
+}
+
+void ControlServerTest::concurrentClients_data()
+{
+    QTest::addColumn<int>("clients");
+    QTest::newRow("1") << 1;
+    QTest::newRow("16") << 16;
+    QTest::newRow("64") << 64;
+}
+
+void ControlServerTest::concurrentClients()
+{
+    QFETCH(int, clients);
+    const int requestsPerClient = 200;
+
+    std::vector<std::unique_ptr<ControlClient>> connections;
+    for (int i = 0; i < clients; ++i) {
+        connections.push_back(std::make_unique<ControlClient>());
+        QVERIFY(connections.back()->connectToServer());
+        // Let the server accept before its backlog fills up
+        QCoreApplication::processEvents();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int n = 0; n < requestsPerClient; ++n) {
+        for (auto &client : connections)
+            client->request({ { "id", n }, { "cmd", n % 2 ? "status" : "list" } });
+    }
+    for (auto &client : connections) {
+        QTRY_COMPARE_WITH_TIMEOUT(client->replies(), requestsPerClient, 30000);
+    }
+
+    const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+    const double perSecond = clients * requestsPerClient * 1000.0 / elapsed;
+    QTest::setBenchmarkResult(perSecond, QTest::Events);
+    qInfo().noquote() << clients << "clients:" << qRound(perSecond) << "requests/s";
+}
+
+SCRIPTRUNNER_TEST(ControlServerTest)
+#include "tst_controlserver.moc"
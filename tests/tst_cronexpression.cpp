@@ -0,0 +1,94 @@
+#include "testsuite.h"
+#include "cronexpression.h"
+#include <QTest>
+
+class CronExpressionTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseErrors_data();
+    void parseErrors();
+    void next_data();
+    void next();
+};
+
+void CronExpressionTest::parseErrors_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("error");
+
+    QTest::newRow("four fields") << "0 * * *" << "Schedule \"0 * * *\" needs 5 fields: minute hour day month weekday";
+    QTest::newRow("minute out of range") << "60 * * * *" << "Invalid minute field \"60\"";
+    QTest::newRow("hour out of range") << "0 24 * * *" << "Invalid hour field \"24\"";
+    QTest::newRow("day zero") << "0 0 0 * *" << "Invalid day of month field \"0\"";
+    QTest::newRow("backwards range") << "0 0 * 5-2 *" << "Invalid month field \"5-2\"";
+    QTest::newRow("unknown day name") << "0 0 * * FUN" << "Invalid weekday field \"FUN\"";
+    QTest::newRow("zero step") << "*/0 * * * *" << "Invalid minute field \"*/0\"";
+    QTest::newRow("unknown macro") << "@fortnightly" << "Unknown schedule macro @fortnightly";
+    QTest::newRow("macro with fields") << "@daily 5" << "Unexpected text after @daily";
+    QTest::newRow("interval without unit") << "@every 30" << "Invalid interval \"@every 30\", expected e.g. @every 30s";
+    QTest::newRow("interval too short") << "@every 0.5s" << "Invalid interval \"@every 0.5s\", expected e.g. @every 30s";
+}
+
+void CronExpressionTest::parseErrors()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, error);
+
+    QString message;
+    const CronExpression cron = CronExpression::parse(text, &message);
+    QVERIFY(!cron.isValid());
+    QCOMPARE(message, error);
+    QVERIFY(!cron.next(QDateTime::currentDateTime()).isValid());
+}
+
+void CronExpressionTest::next_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QDateTime>("after");
+    QTest::addColumn<QDateTime>("expected");
+
+    // 2026-01-01 is a Thursday
+    const QDate thursday(2026, 1, 1);
+    const auto at = [](const QDate &date, int hour, int minute, int second = 0) {
+        return QDateTime(date, QTime(hour, minute, second));
+    };
+
+    QTest::newRow("every minute") << "* * * * *" << at(thursday, 10, 15, 30) << at(thursday, 10, 16);
+    QTest::newRow("strictly after") << "15 10 * * *" << at(thursday, 10, 15) << at(thursday.addDays(1), 10, 15);
+    QTest::newRow("step") << "*/15 * * * *" << at(thursday, 10, 16) << at(thursday, 10, 30);
+    QTest::newRow("step from a start") << "5/20 * * * *" << at(thursday, 10, 26) << at(thursday, 10, 45);
+    QTest::newRow("list") << "0 8,12,18 * * *" << at(thursday, 12, 0) << at(thursday, 18, 0);
+    QTest::newRow("hour wraps to the next day") << "30 6 * * *" << at(thursday, 7, 0) << at(thursday.addDays(1), 6, 30);
+    QTest::newRow("office hours on friday") << "*/15 9-17 * * MON-FRI" << at(thursday.addDays(1), 17, 50)
+                                            << at(thursday.addDays(4), 9, 0);
+    QTest::newRow("day of month only") << "0 0 13 * *" << at(thursday, 0, 0) << at(QDate(2026, 1, 13), 0, 0);
+    QTest::newRow("day of week only") << "0 0 * * FRI" << at(thursday, 0, 0) << at(QDate(2026, 1, 2), 0, 0);
+    // Both restricted: either one matching is enough, as in classic cron
+    QTest::newRow("day of month or week") << "0 0 13 * FRI" << at(QDate(2026, 1, 10), 0, 0)
+                                          << at(QDate(2026, 1, 13), 0, 0);
+    QTest::newRow("sunday as 7") << "0 12 * * 7" << at(thursday, 0, 0) << at(QDate(2026, 1, 4), 12, 0);
+    QTest::newRow("month names") << "0 0 1 MAR-APR *" << at(thursday, 0, 0) << at(QDate(2026, 3, 1), 0, 0);
+    QTest::newRow("leap day") << "0 0 29 2 *" << at(QDate(2026, 3, 1), 0, 0) << at(QDate(2028, 2, 29), 0, 0);
+    QTest::newRow("never") << "0 0 30 2 *" << at(thursday, 0, 0) << QDateTime();
+    QTest::newRow("hourly") << "@hourly" << at(thursday, 10, 15) << at(thursday, 11, 0);
+    QTest::newRow("weekly") << "@weekly" << at(thursday, 10, 15) << at(QDate(2026, 1, 4), 0, 0);
+    QTest::newRow("yearly") << "@yearly" << at(thursday, 0, 0) << at(QDate(2027, 1, 1), 0, 0);
+    QTest::newRow("every 90 seconds") << "@every 1.5m" << at(thursday, 10, 15, 30) << at(thursday, 10, 17, 0);
+}
+
+void CronExpressionTest::next()
+{
+    QFETCH(QString, text);
+    QFETCH(QDateTime, after);
+    QFETCH(QDateTime, expected);
+
+    QString error;
+    const CronExpression cron = CronExpression::parse(text, &error);
+    QVERIFY2(cron.isValid(), qPrintable(error));
+    QCOMPARE(cron.next(after), expected);
+}
+
+SCRIPTRUNNER_TEST(CronExpressionTest)
+#include "tst_cronexpression.moc"
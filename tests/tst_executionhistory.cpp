@@ -0,0 +1,182 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "actionmanager.h"
+#include "executionhistory.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtEndian>
+
+class ExecutionHistoryTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void roundTrip();
+    void tornRecordIsCut();
+    void compaction();
+    void sharedBetweenInstances();
+    void loadLargeLog_data();
+    void loadLargeLog();
+
+private:
+    QTemporaryDir m_dir;
+    ActionManager m_manager;
+    int m_logs = 0;
+
+    QString newLog() { return m_dir.filePath(QString("history-%1.log").arg(++m_logs)); }
+};
+
+template <typename T>
+static void put(QByteArray *out, T value)
+{
+    const T le = qToLittleEndian(value);
+    out->append(reinterpret_cast<const char *>(&le), sizeof(T));
+}
+
+void ExecutionHistoryTest::initTestCase()
+{
+    QVERIFY(m_manager.loadActions(TestUtil::writeFile(m_dir.path(), "actions.json", TestUtil::catalogJson(10))));
+}
+
+void ExecutionHistoryTest::roundTrip()
+{
+    const QString path = newLog();
+    {
+        ExecutionHistory history(&m_manager, path);
+        history.record("action-1", true);
+        history.record("action-1", false);
+        history.record("action-1", true);
+        history.record("action-2", true);
+        history.record("no-such-action", true);
+        QCOMPARE(history.runCount(), 4);
+    }
+
+    ExecutionHistory history(&m_manager, path);
+    QCOMPARE(history.runCount(), 4);
+    QCOMPARE(history.topActions(2), QStringList({ "action-1", "action-2" }));
+    const QVariantMap stats = history.stats("action-1");
+    QCOMPARE(stats.value("runs").toInt(), 3);
+    QCOMPARE(stats.value("failures").toInt(), 1);
+    QVERIFY(history.stats("no-such-action").isEmpty());
+}
+
+void ExecutionHistoryTest::tornRecordIsCut()
+{
+    const QString path = newLog();
+    {
+        ExecutionHistory history(&m_manager, path);
+        history.record("action-3", true);
+    }
+    const qint64 intact = QFileInfo(path).size();
+
+    // A run record cut off mid-write
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::Append));
+    file.write(QByteArray("\x02\x00\x00", 3));
+    file.close();
+
+    ExecutionHistory history(&m_manager, path);
+    QCOMPARE(history.runCount(), 1);
+    QCOMPARE(QFileInfo(path).size(), intact);
+    history.record("action-3", true);
+    QCOMPARE(history.stats("action-3").value("runs").toInt(), 2);
+}
+
+void ExecutionHistoryTest::compaction()
+{
+    const QString path = newLog();
+    const int runs = 5000;
+    {
+        ExecutionHistory history(&m_manager, path);
+        for (int i = 0; i < runs; ++i) history.record(QString("action-%1").arg(i % 3), i % 10 != 0);
+
+        // Past 4096 raw runs the log is rewritten as one summary per action
+        QTRY_VERIFY(QFileInfo(path).size() < 2000 * 14);
+        history.record("action-4", true);
+        QCOMPARE(history.runCount(), runs + 1);
+    }
+
+    ExecutionHistory history(&m_manager, path);
+    QCOMPARE(history.runCount(), runs + 1);
+    QCOMPARE(history.stats("action-0").value("runs").toInt(), 1667);
+    QCOMPARE(history.stats("action-0").value("failures").toInt(), 167);
+    QCOMPARE(history.stats("action-4").value("runs").toInt(), 1);
+}
+
+void ExecutionHistoryTest::sharedBetweenInstances()
+{
+    // Two processes on one log, as the GUI and a headless --run are
+    const QString path = newLog();
+    ExecutionHistory gui(&m_manager, path);
+    ExecutionHistory headless(&m_manager, path);
+
+    gui.record("action-1", true);
+    headless.record("action-2", true);
+    gui.record("action-3", true);
+    QCOMPARE(gui.runCount(), 3);
+
+    // A compaction in one must not lose what the other appends
+    for (int i = 0; i < 4100; ++i) gui.record("action-1", true);
+    QTRY_VERIFY(QFileInfo(path).size() < 1000);
+    headless.record("action-2", false);
+    headless.record("action-5", true);
+
+    ExecutionHistory reader(&m_manager, path);
+    QCOMPARE(reader.runCount(), 4105);
+    QCOMPARE(reader.stats("action-1").value("runs").toInt(), 4101);
+    QCOMPARE(reader.stats("action-2").value("runs").toInt(), 2);
+    QCOMPARE(reader.stats("action-2").value("failures").toInt(), 1);
+    QCOMPARE(reader.stats("action-3").value("runs").toInt(), 1);
+    QCOMPARE(reader.stats("action-5").value("runs").toInt(), 1);
+}
+
+void ExecutionHistoryTest::loadLargeLog_data()
+{
+    QTest::addColumn<int>("runs");
+    QTest::newRow("1M") << 1000000;
+    QTest::newRow("5M") << 5000000;
+}
+
+void ExecutionHistoryTest::loadLargeLog()
+{
+    QFETCH(int, runs);
+    const int actions = 1000;
+
+    // Written directly in the log format: header, ids, then raw runs
+    QByteArray log("SRHL", 4);
+    put<quint32>(&log, 2);
+    put<quint64>(&log, 1);
+    for (int i = 0; i < actions; ++i) {
+        const QByteArray id = QString("action-%1").arg(i).toUtf8();
+        log.append(char(1));
+        put<quint16>(&log, quint16(id.size()));
+        log.append(id);
+    }
+    const qint64 start = QDateTime::currentMSecsSinceEpoch() - qint64(runs) * 1000;
+    log.reserve(log.size() + qsizetype(runs) * 14);
+    for (int i = 0; i < runs; ++i) {
+        log.append(char(2));
+        put<quint32>(&log, quint32((qint64(i) * 7919) % actions));
+        put<qint64>(&log, start + qint64(i) * 1000);
+        log.append(char(i % 10 != 0));
+    }
+    const QString path = TestUtil::writeFile(m_dir.path(), QString("large-%1.log").arg(runs), log);
+    QVERIFY(!path.isEmpty());
+
+    // The first load of a raw log folds every run; compaction follows in
+    // the background and isn't timed
+    QElapsedTimer timer;
+    timer.start();
+    ExecutionHistory history(&m_manager, path);
+    const qint64 elapsed = timer.elapsed();
+    QCOMPARE(history.runCount(), runs);
+    QTest::setBenchmarkResult(elapsed, QTest::WalltimeMilliseconds);
+}
+
+SCRIPTRUNNER_TEST(ExecutionHistoryTest)
+#include "tst_executionhistory.moc"
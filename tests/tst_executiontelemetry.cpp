@@ -0,0 +1,113 @@
+#include "testsuite.h"
+#include "executiontelemetry.h"
+#include "jobscheduler.h"
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+class ExecutionTelemetryTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void countsRuns();
+    void sampledPeakRss();
+    void exports();
+
+private:
+    // Runs the scripts one after another under one tag and waits until all are recorded
+    static void run(JobScheduler &scheduler, ExecutionTelemetry &telemetry, const QStringList &scripts,
+                    const QString &tag);
+};
+
+void ExecutionTelemetryTest::run(JobScheduler &scheduler, ExecutionTelemetry &telemetry, const QStringList &scripts,
+                                 const QString &tag)
+{
+    QSignalSpy recorded(&telemetry, &ExecutionTelemetry::statsChanged);
+    scheduler.setMaxConcurrency(1);
+    for (const QString &script : scripts) {
+        JobScheduler::JobSpec spec;
+        spec.program = "sh";
+        spec.arguments = QStringList { "-c", script };
+        spec.tag = tag;
+        scheduler.submit(spec);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(recorded.count(), scripts.size(), 10000);
+}
+
+void ExecutionTelemetryTest::countsRuns()
+{
+    JobScheduler scheduler;
+    ExecutionTelemetry telemetry(&scheduler);
+    run(scheduler, telemetry, { "echo ok", "sleep 0.2; echo ok", "exit 3" }, "action-a");
+    run(scheduler, telemetry, { "true" }, "action-b");
+
+    const QVariantMap a = telemetry.actionStats("action-a");
+    QCOMPARE(a.value("runs").toULongLong(), quint64(3));
+    QCOMPARE(a.value("failures").toULongLong(), quint64(1));
+    QCOMPARE(a.value("runMs").toMap().value("count").toULongLong(), quint64(3));
+    QCOMPARE(a.value("spawnMs").toMap().value("count").toULongLong(), quint64(3));
+    QCOMPARE(a.value("firstOutputMs").toMap().value("count").toULongLong(), quint64(2));
+    QVERIFY(a.value("runMs").toMap().value("max").toDouble() >= 200);
+
+    // Heaviest total run time first
+    const QVariantList summary = telemetry.summary();
+    QCOMPARE(summary.size(), 2);
+    QCOMPARE(summary.first().toMap().value("actionId").toString(), QString("action-a"));
+
+    // A canceled job never counts as a run
+    JobScheduler::JobSpec spec;
+    spec.program = "sleep";
+    spec.arguments = QStringList { "10" };
+    spec.tag = "action-b";
+    const int jobId = scheduler.submit(spec);
+    QVERIFY(scheduler.cancel(jobId));
+    QTest::qWait(100);
+    QCOMPARE(telemetry.actionStats("action-b").value("runs").toULongLong(), quint64(1));
+
+    telemetry.reset();
+    QVERIFY(telemetry.summary().isEmpty());
+}
+
+void ExecutionTelemetryTest::sampledPeakRss()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Peak RSS is read from /proc");
+#else
+    JobScheduler scheduler;
+    ExecutionTelemetry telemetry(&scheduler);
+
+    // About 20 MB held in a shell variable, and alive for several samples
+    run(scheduler, telemetry, { "x=$(head -c 20000000 /dev/zero | tr '\\0' a); sleep 0.5; echo ${#x}" }, "big");
+    const QVariantMap rss = telemetry.actionStats("big").value("sampledPeakRssKiB").toMap();
+    QCOMPARE(rss.value("count").toULongLong(), quint64(1));
+    QVERIFY2(rss.value("max").toDouble() > 15000, qPrintable(rss.value("max").toString()));
+#endif
+}
+
+void ExecutionTelemetryTest::exports()
+{
+    JobScheduler scheduler;
+    ExecutionTelemetry telemetry(&scheduler);
+    run(scheduler, telemetry, { "exit 0", "exit 2" }, "say \"hi\"");
+
+    const QString text = telemetry.prometheusText();
+    QVERIFY(text.contains("scriptrunner_run_time_seconds_count{action=\"say \\\"hi\\\"\"} 2\n"));
+    QVERIFY(text.contains("scriptrunner_runs_total{action=\"say \\\"hi\\\"\",exit_code=\"2\"} 1\n"));
+    QVERIFY(text.contains("# TYPE scriptrunner_sampled_peak_rss_kib gauge\n"));
+
+    const QJsonObject action = telemetry.toJson().value("actions").toObject().value("say \"hi\"").toObject();
+    QCOMPARE(action.value("runs").toInteger(), qint64(2));
+    QCOMPARE(action.value("last_exit_code").toInt(), 2);
+    QCOMPARE(action.value("exit_codes").toObject().value("2").toInteger(), qint64(1));
+    QVERIFY(action.contains("sampled_peak_rss_kib"));
+
+    QTemporaryDir dir;
+    QVERIFY(telemetry.exportTo(dir.filePath("metrics.prom")));
+    QVERIFY(telemetry.exportTo(dir.filePath("metrics.json")));
+    QVERIFY(!telemetry.exportTo(dir.filePath("missing/metrics.json")));
+}
+
+SCRIPTRUNNER_TEST(ExecutionTelemetryTest)
+#include "tst_executiontelemetry.moc"
@@ -0,0 +1,118 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "interpreterpool.h"
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+class InterpreterPoolTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void runsScripts();
+    void cancelDoesNotBlock();
+    void warmVersusColdStart_data();
+    void warmVersusColdStart();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_python;
+    QString m_hello;
+    QString m_sleep;
+
+    InterpreterPool::Config config() const;
+};
+
+void InterpreterPoolTest::initTestCase()
+{
+    m_python = QStandardPaths::findExecutable("python3");
+    if (m_python.isEmpty()) QSKIP("python3 is needed for the stub worker");
+
+    m_hello = TestUtil::writeFile(m_dir.path(), "hello.py", "print('hello')\n");
+    m_sleep = TestUtil::writeFile(m_dir.path(), "sleep.py", "import time\ntime.sleep(60)\n");
+    QVERIFY(!m_hello.isEmpty() && !m_sleep.isEmpty());
+}
+
+InterpreterPool::Config InterpreterPoolTest::config() const
+{
+    InterpreterPool::Config config;
+    config.program = m_python;
+    config.arguments = QStringList { SCRIPTRUNNER_SOURCE_DIR "/qml/workers/python_worker.py" };
+    config.workingDirectory = m_dir.path();
+    config.size = 2;
+    return config;
+}
+
+void InterpreterPoolTest::runsScripts()
+{
+    InterpreterPool pool("test", config());
+    QSignalSpy finished(&pool, &InterpreterPool::finished);
+
+    pool.invoke(1, { m_hello });
+    pool.invoke(2, { m_hello });
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 2, 10000);
+    for (const QList<QVariant> &arguments : std::as_const(finished)) {
+        QCOMPARE(arguments.at(1).toInt(), 0);
+        QCOMPARE(arguments.at(2).toByteArray(), QByteArray("hello\n"));
+    }
+}
+
+void InterpreterPoolTest::cancelDoesNotBlock()
+{
+    InterpreterPool pool("test", config());
+    QSignalSpy finished(&pool, &InterpreterPool::finished);
+    QTRY_COMPARE_WITH_TIMEOUT(pool.idleCount(), 2, 10000);
+
+    pool.invoke(1, { m_sleep });
+    QCOMPARE(pool.idleCount(), 1);
+
+    // The busy worker is replaced; its process is stopped in the background
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(pool.cancel(1));
+    QVERIFY2(timer.elapsed() < 100, qPrintable(QString("cancel took %1 ms").arg(timer.elapsed())));
+
+    QTRY_COMPARE_WITH_TIMEOUT(pool.idleCount(), 2, 10000);
+    pool.invoke(2, { m_hello });
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 10000);
+    QCOMPARE(finished.at(0).at(0).toInt(), 2);
+}
+
+void InterpreterPoolTest::warmVersusColdStart_data()
+{
+    QTest::addColumn<bool>("pooled");
+    QTest::newRow("pool") << true;
+    QTest::newRow("cold spawn") << false;
+}
+
+void InterpreterPoolTest::warmVersusColdStart()
+{
+    QFETCH(bool, pooled);
+
+    if (pooled) {
+        InterpreterPool pool("test", config());
+        QSignalSpy finished(&pool, &InterpreterPool::finished);
+        QTRY_COMPARE_WITH_TIMEOUT(pool.idleCount(), 2, 10000);
+
+        int requestId = 0;
+        QBENCHMARK {
+            pool.invoke(++requestId, { m_hello });
+            QVERIFY(finished.wait(10000));
+        }
+    } else {
+        QBENCHMARK {
+            QProcess process;
+            process.start(m_python, { m_hello });
+            QVERIFY(process.waitForFinished(10000));
+            QCOMPARE(process.readAllStandardOutput().trimmed(), QByteArray("hello"));
+        }
+    }
+}
+
+SCRIPTRUNNER_TEST(InterpreterPoolTest)
+#include "tst_interpreterpool.moc"
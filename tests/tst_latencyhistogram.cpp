@@ -0,0 +1,53 @@
+#include "testsuite.h"
+#include "latencyhistogram.h"
+#include <QTest>
+
+class LatencyHistogramTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void bucketsCoverEveryValue();
+    void countAtOrBelowNeverOvercounts();
+    void percentiles();
+};
+
+void LatencyHistogramTest::bucketsCoverEveryValue()
+{
+    for (quint64 value : { 0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull }) {
+        const int index = LatencyHistogram::bucketIndex(value);
+        QVERIFY(LatencyHistogram::bucketLowerBound(index) <= value);
+        QVERIFY(LatencyHistogram::bucketUpperBound(index) >= value);
+    }
+}
+
+void LatencyHistogramTest::countAtOrBelowNeverOvercounts()
+{
+    LatencyHistogram histogram;
+    // 1000 and 1023 share the bucket [960, 1023]
+    histogram.record(10);
+    histogram.record(1000);
+    histogram.record(1023);
+
+    QCOMPARE(histogram.countAtOrBelow(9), quint64(0));
+    QCOMPARE(histogram.countAtOrBelow(10), quint64(1));
+    // The straddling bucket holds 1023, which is above the bound
+    QCOMPARE(histogram.countAtOrBelow(1000), quint64(1));
+    QCOMPARE(histogram.countAtOrBelow(1023), quint64(3));
+    QCOMPARE(histogram.countAtOrBelow(~0ull), quint64(3));
+}
+
+void LatencyHistogramTest::percentiles()
+{
+    LatencyHistogram histogram;
+    for (quint64 value = 1; value <= 100; ++value) histogram.record(value);
+
+    QCOMPARE(histogram.count(), quint64(100));
+    QCOMPARE(histogram.max(), quint64(100));
+    QCOMPARE(histogram.percentile(100), quint64(100));
+    // Within a bucket's 12.5% of the exact value
+    QVERIFY(histogram.percentile(50) >= 50 && histogram.percentile(50) <= 57);
+}
+
+SCRIPTRUNNER_TEST(LatencyHistogramTest)
+#include "tst_latencyhistogram.moc"
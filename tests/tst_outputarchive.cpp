@@ -0,0 +1,217 @@
+#include "testsuite.h"
+#include "jobscheduler.h"
+#include "outputarchive.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+class OutputArchiveTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void writeAndSearch();
+    void newestSegmentWins();
+    void retention();
+    void tornIndexIsCut();
+
+private:
+    // Runs the scripts one after another and waits until all are archived
+    static void run(JobScheduler &scheduler, OutputArchive &archive, const QStringList &scripts,
+                    const QString &tag = "action");
+    static QString segmentPath(const QTemporaryDir &dir, int segment, const char *suffix);
+};
+
+void OutputArchiveTest::run(JobScheduler &scheduler, OutputArchive &archive, const QStringList &scripts,
+                            const QString &tag)
+{
+    QSignalSpy written(&archive, &OutputArchive::sizeChanged);
+    scheduler.setMaxConcurrency(1);
+    for (const QString &script : scripts) {
+        JobScheduler::JobSpec spec;
+        spec.program = "sh";
+        spec.arguments = QStringList { "-c", script };
+        spec.tag = tag;
+        scheduler.submit(spec);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(written.count(), scripts.size(), 10000);
+}
+
+QString OutputArchiveTest::segmentPath(const QTemporaryDir &dir, int segment, const char *suffix)
+{
+    return dir.path() + QString("/%1.%2").arg(segment, 8, 10, QChar('0')).arg(suffix);
+}
+
+void OutputArchiveTest::writeAndSearch()
+{
+    QTemporaryDir dir;
+    JobScheduler scheduler;
+    OutputArchive archive(&scheduler, dir.path());
+
+    QStringList scripts;
+    for (int i = 0; i < 10; ++i) scripts.append(QString("echo match-%1; echo other; echo warn-%1 >&2").arg(i));
+    run(scheduler, archive, scripts.mid(0, 5), "action-a");
+    run(scheduler, archive, scripts.mid(5), "action-b");
+    run(scheduler, archive, { "echo broken; exit 3" }, "action-b");
+
+    OutputArchive::Query query;
+    query.pattern = "MATCH-";
+    QVector<OutputArchive::Hit> hits = archive.search(query);
+    QCOMPARE(hits.size(), 10);
+    QCOMPARE(hits.first().text, QString("match-9"));
+    QCOMPARE(hits.first().stream, QString("stdout"));
+    QCOMPARE(hits.first().line, qint64(0));
+    QCOMPARE(hits.last().text, QString("match-0"));
+
+    query.caseSensitive = true;
+    QVERIFY(archive.search(query).isEmpty());
+
+    query.pattern = "warn-[0-4]$";
+    query.regex = true;
+    query.actionId = "action-a";
+    hits = archive.search(query);
+    QCOMPARE(hits.size(), 5);
+    QCOMPARE(hits.first().stream, QString("stderr"));
+    QCOMPARE(hits.first().actionId, QString("action-a"));
+
+    query = OutputArchive::Query();
+    query.failedOnly = true;
+    hits = archive.search(query);
+    QCOMPARE(hits.size(), 1);
+    QCOMPARE(hits.first().exitCode, 3);
+    QVERIFY(hits.first().stream.isEmpty());
+
+    const QVariantMap entry = archive.entry(hits.first().segment, hits.first().entry);
+    QCOMPARE(entry.value("actionId").toString(), QString("action-b"));
+    QCOMPARE(entry.value("stdout").toString(), QString("broken\n"));
+
+    query = OutputArchive::Query();
+    query.limit = 4;
+    QCOMPARE(archive.search(query).size(), 4);
+}
+
+void OutputArchiveTest::newestSegmentWins()
+{
+    QTemporaryDir dir;
+    {
+        JobScheduler scheduler;
+        OutputArchive archive(&scheduler, dir.path());
+        QStringList scripts;
+        for (int i = 0; i < 20; ++i)
+            scripts.append(QString("for l in $(seq 0 49); do echo \"match old-%1-$l\"; done").arg(i));
+        run(scheduler, archive, scripts);
+    }
+
+    // An empty later segment is picked up and appended to on open
+    QFile(segmentPath(dir, 2, "idx")).open(QIODevice::WriteOnly);
+    QFile(segmentPath(dir, 2, "dat")).open(QIODevice::WriteOnly);
+
+    JobScheduler scheduler;
+    OutputArchive archive(&scheduler, dir.path());
+    QStringList scripts;
+    for (int i = 0; i < 5; ++i) scripts.append(QString("echo match new-%1").arg(i));
+    run(scheduler, archive, scripts);
+
+    // The old segment has a thousand hits; it must not crowd out the new one
+    OutputArchive::Query query;
+    query.pattern = "match";
+    query.limit = 5;
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        const QVector<OutputArchive::Hit> hits = archive.search(query);
+        QCOMPARE(hits.size(), 5);
+        for (int i = 0; i < 5; ++i) {
+            QCOMPARE(hits.at(i).segment, 2);
+            QCOMPARE(hits.at(i).text, QString("match new-%1").arg(4 - i));
+        }
+    }
+
+    // Past the new segment the newest old run follows, line by line
+    query.limit = 30;
+    const QVector<OutputArchive::Hit> hits = archive.search(query);
+    QCOMPARE(hits.size(), 30);
+    QCOMPARE(hits.at(5).segment, 1);
+    QCOMPARE(hits.at(5).text, QString("match old-19-0"));
+    QCOMPARE(hits.last().text, QString("match old-19-24"));
+}
+
+void OutputArchiveTest::retention()
+{
+    QTemporaryDir dir;
+    {
+        JobScheduler scheduler;
+        OutputArchive archive(&scheduler, dir.path());
+        run(scheduler, archive, { "echo first" });
+    }
+    QFile(segmentPath(dir, 2, "idx")).open(QIODevice::WriteOnly);
+    QFile(segmentPath(dir, 2, "dat")).open(QIODevice::WriteOnly);
+
+    // Over the size limit: whole segments go, the current one stays
+    {
+        JobScheduler scheduler;
+        OutputArchive archive(&scheduler, dir.path());
+        run(scheduler, archive, { "echo second" });
+        QVERIFY(QFile::exists(segmentPath(dir, 1, "idx")));
+
+        archive.setMaxSizeBytes(1);
+        QTRY_VERIFY(!QFile::exists(segmentPath(dir, 1, "idx")));
+        QVERIFY(!QFile::exists(segmentPath(dir, 1, "dat")));
+        QVERIFY(QFile::exists(segmentPath(dir, 2, "idx")));
+
+        const QVector<OutputArchive::Hit> hits = archive.search(OutputArchive::Query());
+        QCOMPARE(hits.size(), 1);
+        QCOMPARE(hits.first().segment, 2);
+        QCOMPARE(archive.sizeBytes(), QFileInfo(segmentPath(dir, 2, "idx")).size()
+                                          + QFileInfo(segmentPath(dir, 2, "dat")).size());
+    }
+
+    // Past the age limit: dropped as soon as the archive opens
+    QFile(segmentPath(dir, 3, "idx")).open(QIODevice::WriteOnly);
+    QFile(segmentPath(dir, 3, "dat")).open(QIODevice::WriteOnly);
+    {
+        QFile index(segmentPath(dir, 2, "idx"));
+        QVERIFY(index.open(QIODevice::ReadWrite));
+        QVERIFY(index.setFileTime(QDateTime::currentDateTime().addDays(-40), QFileDevice::FileModificationTime));
+    }
+    JobScheduler scheduler;
+    OutputArchive archive(&scheduler, dir.path());
+    QTRY_VERIFY(!QFile::exists(segmentPath(dir, 2, "idx")));
+    QVERIFY(QFile::exists(segmentPath(dir, 3, "idx")));
+}
+
+void OutputArchiveTest::tornIndexIsCut()
+{
+    QTemporaryDir dir;
+    {
+        JobScheduler scheduler;
+        OutputArchive archive(&scheduler, dir.path());
+        run(scheduler, archive, { "echo run-0", "echo run-1" });
+    }
+
+    // A crash halfway through an index entry
+    const QString index = segmentPath(dir, 1, "idx");
+    const qint64 entries = QFileInfo(index).size();
+    {
+        QFile file(index);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write(QByteArray(20, '\x7f'));
+    }
+
+    JobScheduler scheduler;
+    OutputArchive archive(&scheduler, dir.path());
+    run(scheduler, archive, { "echo run-2" });
+    QCOMPARE(QFileInfo(index).size(), entries / 2 * 3);
+
+    OutputArchive::Query query;
+    query.pattern = "run-";
+    const QVector<OutputArchive::Hit> hits = archive.search(query);
+    QCOMPARE(hits.size(), 3);
+    QCOMPARE(hits.first().text, QString("run-2"));
+    QCOMPARE(hits.first().entry, qint64(2));
+    QCOMPARE(archive.entry(1, 2).value("stdout").toString(), QString("run-2\n"));
+}
+
+SCRIPTRUNNER_TEST(OutputArchiveTest)
+#include "tst_outputarchive.moc"
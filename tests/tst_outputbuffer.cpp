@@ -0,0 +1,119 @@
+#include "testsuite.h"
+#include "outputbuffer.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QSignalSpy>
+#include <QTest>
+
+class OutputBufferTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void keepsLines();
+    void ringIsCapped();
+    void readsFromDevice();
+    void throughput_data();
+    void throughput();
+};
+
+void OutputBufferTest::keepsLines()
+{
+    OutputBuffer buffer(1024, 16);
+    buffer.append("one\ntwo\r\nthr", 12);
+    QCOMPARE(buffer.lineCount(), qint64(2));
+    QCOMPARE(buffer.tailLines(5), QStringList({ "one", "two" }));
+
+    buffer.append("ee", 2);
+    buffer.finish();
+    QCOMPARE(buffer.tailLines(1), QStringList({ "three" }));
+    QVERIFY(!buffer.truncated());
+}
+
+void OutputBufferTest::ringIsCapped()
+{
+    const qsizetype capacity = 4096;
+    OutputBuffer buffer(capacity, 64);
+
+    // 10000 numbered lines, far more than the ring holds
+    QByteArray written;
+    for (int i = 0; i < 10000; ++i) {
+        const QByteArray line = QByteArray::number(i) + '\n';
+        buffer.append(line.constData(), line.size());
+        written += line;
+    }
+
+    QCOMPARE(buffer.capacity(), capacity);
+    QCOMPARE(buffer.size(), capacity);
+    QCOMPARE(buffer.totalBytes(), qint64(written.size()));
+    QVERIFY(buffer.truncated());
+    QCOMPARE(buffer.contents(), written.right(capacity));
+
+    // Line spans are capped too; the newest ones are intact
+    QCOMPARE(buffer.lineCount(), qint64(10000));
+    QVERIFY(buffer.firstAvailableLine() >= 10000 - 64);
+    QCOMPARE(buffer.tailLines(2), QStringList({ "9998", "9999" }));
+    QCOMPARE(buffer.lines(0, 1), QStringList({ QString::number(buffer.firstAvailableLine()) }));
+
+    // A single write bigger than the ring keeps only its end
+    OutputBuffer small(8, 4);
+    small.append("0123456789abcdef\n", 17);
+    QCOMPARE(small.contents(), QByteArray("9abcdef\n"));
+    QCOMPARE(small.totalBytes(), qint64(17));
+}
+
+void OutputBufferTest::readsFromDevice()
+{
+    QByteArray data;
+    for (int i = 0; i < 100; ++i) data += "line " + QByteArray::number(i) + '\n';
+
+    QBuffer device(&data);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    OutputBuffer buffer(512, 32);
+    QCOMPARE(buffer.readFrom(&device), qint64(data.size()));
+    QCOMPARE(buffer.lineCount(), qint64(100));
+    QCOMPARE(buffer.tailLines(1), QStringList({ "line 99" }));
+}
+
+void OutputBufferTest::throughput_data()
+{
+    QTest::addColumn<bool>("buffered");
+    QTest::newRow("OutputBuffer") << true;
+    QTest::newRow("readAllStandardOutput") << false; // The pipe alone, for comparison
+}
+
+void OutputBufferTest::throughput()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Uses a POSIX shell");
+#else
+    QFETCH(bool, buffered);
+
+    // 80 byte lines through a real pipe, the shape of a chatty build log
+    const qint64 total = 256 * 1024 * 1024;
+    QProcess process;
+    process.setProgram("sh");
+    process.setArguments({ "-c", QString("yes %1 | head -c %2").arg(QString(79, 'x')).arg(total) });
+
+    OutputBuffer buffer;
+    qint64 received = 0;
+    connect(&process, &QProcess::readyReadStandardOutput, this, [&]() {
+        received += buffered ? buffer.readFrom(&process) : process.readAllStandardOutput().size();
+    });
+
+    QSignalSpy finished(&process, &QProcess::finished);
+    QElapsedTimer timer;
+    timer.start();
+    process.start();
+    QVERIFY(finished.wait(60000));
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+    QCOMPARE(received, total);
+
+    QTest::setBenchmarkResult(double(received) * 1e9 / elapsedNs, QTest::BytesPerSecond);
+    if (buffered) QCOMPARE(buffer.totalBytes(), total);
+#endif
+}
+
+SCRIPTRUNNER_TEST(OutputBufferTest)
+#include "tst_outputbuffer.moc"
@@ -0,0 +1,87 @@
+#include "testsuite.h"
+#include "processlauncher.h"
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#ifndef Q_OS_WIN
+#include <cerrno>
+#include <signal.h>
+#endif
+
+class ProcessLauncherTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void startsDetached();
+    void launchLatency_data();
+    void launchLatency();
+
+private:
+    ProcessLauncher::Request m_noop; // Exits at once, so only the launch is timed
+};
+
+void ProcessLauncherTest::initTestCase()
+{
+#ifdef Q_OS_WIN
+    m_noop = { QStandardPaths::findExecutable("cmd.exe"), { "/c", "exit" }, QString() };
+#else
+    m_noop = { QStandardPaths::findExecutable("true"), {}, QString() };
+#endif
+    if (m_noop.program.isEmpty()) QSKIP("No no-op program to launch");
+}
+
+void ProcessLauncherTest::startsDetached()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Uses a POSIX shell");
+#else
+    QTemporaryDir dir;
+    const QString marker = dir.filePath("ran");
+    const ProcessLauncher::Request request = ProcessLauncher::fromCommandLine("sh -c \"pwd > ran\"");
+    QCOMPARE(request.program, QString("sh"));
+
+    ProcessLauncher::Request inDir = request;
+    inDir.workingDirectory = dir.path();
+    qint64 pid = 0;
+    QString error;
+    QVERIFY2(ProcessLauncher::startDetached(inDir, &pid, &error), qPrintable(error));
+    QVERIFY(pid > 0);
+    QTRY_VERIFY(QFile::exists(marker));
+
+    // Reaped once it exits, not left behind as a zombie
+    QTRY_VERIFY_WITH_TIMEOUT(kill(pid_t(pid), 0) < 0 && errno == ESRCH, 5000);
+#endif
+}
+
+void ProcessLauncherTest::launchLatency_data()
+{
+    QTest::addColumn<bool>("native");
+    QTest::newRow("ProcessLauncher") << true;
+    QTest::newRow("QProcess") << false;
+}
+
+void ProcessLauncherTest::launchLatency()
+{
+    QFETCH(bool, native);
+
+    // Time until the call returns, which is what the menu click waits for
+    bool started = true;
+    if (native) {
+        QBENCHMARK {
+            started &= ProcessLauncher::startDetached(m_noop);
+        }
+    } else {
+        QBENCHMARK {
+            started &= QProcess::startDetached(m_noop.program, m_noop.arguments);
+        }
+    }
+    QVERIFY(started);
+}
+
+SCRIPTRUNNER_TEST(ProcessLauncherTest)
+#include "tst_processlauncher.moc"
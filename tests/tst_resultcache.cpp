@@ -0,0 +1,65 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "resultcache.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+class ResultCacheTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void hitsForSameInputs();
+    void contentChangeMisses();
+};
+
+void ResultCacheTest::hitsForSameInputs()
+{
+    QTemporaryDir dir;
+    const QString input = TestUtil::writeFile(dir.path(), "input.txt", "first");
+    ResultCache cache(dir.filePath("cache"));
+
+    const QByteArray key = cache.key("convert {file}", { input });
+    QVERIFY(cache.store(key, { 0, "converted", QByteArray() }));
+
+    ResultCache::Entry entry;
+    QVERIFY(cache.lookup(cache.key("convert {file}", { input }), &entry));
+    QCOMPARE(entry.standardOutput, QByteArray("converted"));
+    QVERIFY(!cache.lookup(cache.key("convert --fast {file}", { input }), &entry));
+    QCOMPARE(cache.hits(), 1);
+    QCOMPARE(cache.misses(), 1);
+}
+
+void ResultCacheTest::contentChangeMisses()
+{
+    QTemporaryDir dir;
+    const QString input = TestUtil::writeFile(dir.path(), "input.txt", "first");
+    ResultCache cache(dir.filePath("cache"));
+
+    const QByteArray before = cache.key("convert {file}", { input });
+    QVERIFY(cache.store(before, { 0, "from first", QByteArray() }));
+    const QDateTime modified = QFileInfo(input).lastModified();
+
+    // Same size and timestamp: only the content tells the inputs apart
+    QFile file(input);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write("other"), qint64(5));
+    QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    file.close();
+
+    const QByteArray after = cache.key("convert {file}", { input });
+    QVERIFY(after != before);
+    ResultCache::Entry entry;
+    QVERIFY(!cache.lookup(after, &entry));
+
+    // Putting the old content back finds the old result again
+    TestUtil::writeFile(dir.path(), "input.txt", "first");
+    QCOMPARE(cache.key("convert {file}", { input }), before);
+    QVERIFY(cache.lookup(before, &entry));
+    QCOMPARE(entry.standardOutput, QByteArray("from first"));
+}
+
+SCRIPTRUNNER_TEST(ResultCacheTest)
+#include "tst_resultcache.moc"
@@ -0,0 +1,63 @@
+#include "testsuite.h"
+#include "settingsmanager.h"
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QTest>
+
+class SettingsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void dragIsCoalesced();
+    void flushNowWritesPendingValues();
+};
+
+void SettingsTest::dragIsCoalesced()
+{
+    SettingsManager settings;
+    settings.loadSettings();
+    const int writesBefore = settings.backendWriteCount();
+    const qreal start = settings.savedX() + 1000;
+
+    // A one second drag: a position update every frame
+    QElapsedTimer drag;
+    drag.start();
+    int moves = 0;
+    while (drag.elapsed() < 1000) {
+        settings.setSavedX(start + moves);
+        settings.setSavedY(start + moves);
+        ++moves;
+        QTest::qWait(16);
+    }
+    settings.flushNow();
+
+    // One flush per delay window plus the final one, not one per move
+    const int writes = settings.backendWriteCount() - writesBefore;
+    QVERIFY2(writes >= 1 && writes <= 4, qPrintable(QString("%1 writes for %2 moves").arg(writes).arg(moves)));
+    QVERIFY(moves > 20);
+
+    QSettings file(QSettings::IniFormat, QSettings::UserScope,
+                   QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    QCOMPARE(file.value("Window/savedX").toReal(), start + moves - 1);
+    QCOMPARE(file.value("Window/savedY").toReal(), start + moves - 1);
+}
+
+void SettingsTest::flushNowWritesPendingValues()
+{
+    SettingsManager settings;
+    settings.loadSettings();
+    const int writesBefore = settings.backendWriteCount();
+
+    settings.setEdgeOffset("left", settings.getEdgeOffset("left") + 1);
+    settings.setSavedX(settings.savedX() + 1);
+    settings.flushNow();
+    QCOMPARE(settings.backendWriteCount(), writesBefore + 1);
+
+    // Nothing changed since, nothing to write
+    settings.flushNow();
+    QCOMPARE(settings.backendWriteCount(), writesBefore + 1);
+}
+
+SCRIPTRUNNER_TEST(SettingsTest)
+#include "tst_settings.moc"
@@ -0,0 +1,168 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+#include <algorithm>
+
+// Launches the real appScriptRunner binary, so the numbers include
+// process start, library loading and static initialisation
+class StartupTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void headlessVersusGui_data();
+    void headlessVersusGui();
+    void compiledQmlFirstFrame_data();
+    void compiledQmlFirstFrame();
+
+private:
+    QTemporaryDir m_home;
+    QString m_actions;
+
+    QProcessEnvironment environment() const;
+    qint64 headlessRun();
+    qint64 guiFirstFrame(const QProcessEnvironment &environment, qint64 *reportedMs = nullptr);
+};
+
+// Launches per measurement; the median keeps one slow start from skewing it
+static const int Runs = 5;
+// Both modes load the same catalog and start this action, a plain "true"
+static const char NoOpAction[] = "action-0";
+
+static qint64 median(QList<qint64> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.at(values.size() / 2);
+}
+
+void StartupTest::initTestCase()
+{
+    if (!QFileInfo(SCRIPTRUNNER_APP).isExecutable()) QSKIP("appScriptRunner was not built");
+    m_actions = TestUtil::writeFile(m_home.path(), "actions.json", TestUtil::catalogJson(200));
+    QVERIFY(!m_actions.isEmpty());
+}
+
+QProcessEnvironment StartupTest::environment() const
+{
+    // Settings, history and the control socket stay out of the user's
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("HOME", m_home.path());
+    environment.insert("XDG_CONFIG_HOME", m_home.filePath("config"));
+    environment.insert("XDG_DATA_HOME", m_home.filePath("data"));
+    environment.insert("XDG_CACHE_HOME", m_home.filePath("cache"));
+    environment.insert("SCRIPTRUNNER_SOCKET", QString("scriptrunner-startup-%1").arg(QCoreApplication::applicationPid()));
+    environment.insert("QT_QPA_PLATFORM", "offscreen");
+    environment.insert("QT_QUICK_BACKEND", "software");
+    return environment;
+}
+
+qint64 StartupTest::headlessRun()
+{
+    QProcess process;
+    process.setProcessEnvironment(environment());
+    QElapsedTimer timer;
+    timer.start();
+    process.start(SCRIPTRUNNER_APP, { "--run", NoOpAction, "--actions", m_actions });
+    if (!process.waitForFinished(30000) || process.exitCode() != 0) {
+        qWarning() << "Headless run failed:" << process.readAllStandardError();
+        return -1;
+    }
+    return timer.elapsed();
+}
+
+qint64 StartupTest::guiFirstFrame(const QProcessEnvironment &environment, qint64 *reportedMs)
+{
+    static const QRegularExpression FirstFrame("First frame after (\\d+) ms");
+
+    QProcessEnvironment withLog = environment;
+    withLog.insert("QT_LOGGING_RULES", "scriptrunner.startup.debug=true");
+
+    QProcess process;
+    process.setProcessEnvironment(withLog);
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    QElapsedTimer timer;
+    timer.start();
+    process.start(SCRIPTRUNNER_APP, { "--new-instance", "--actions", m_actions, "--action", NoOpAction });
+
+    // The GUI keeps running; stop it once the first frame is reported
+    qint64 elapsed = -1;
+    QByteArray output;
+    while (elapsed < 0 && timer.elapsed() < 30000 && process.waitForReadyRead(30000 - timer.elapsed())) {
+        output += process.readAll();
+        const QRegularExpressionMatch match = FirstFrame.match(QString::fromLocal8Bit(output));
+        if (match.hasMatch()) {
+            elapsed = timer.elapsed();
+            if (reportedMs) *reportedMs = match.captured(1).toLongLong();
+        }
+    }
+
+    process.kill();
+    process.waitForFinished();
+    if (elapsed < 0) qWarning() << "No first frame reported:" << output.right(2000);
+    return elapsed;
+}
+
+void StartupTest::headlessVersusGui_data()
+{
+    QTest::addColumn<bool>("gui");
+    QTest::newRow("headless --run") << false;
+    QTest::newRow("gui first frame") << true;
+}
+
+void StartupTest::headlessVersusGui()
+{
+    QFETCH(bool, gui);
+#ifdef Q_OS_WIN
+    // A GUI subsystem binary sends qDebug to the debugger, not to stderr
+    if (gui) QSKIP("First frame is only reported on stderr off Windows");
+#endif
+
+    QList<qint64> times;
+    for (int run = 0; run < Runs; ++run) {
+        const qint64 elapsed = gui ? guiFirstFrame(environment()) : headlessRun();
+        QVERIFY(elapsed >= 0);
+        times.append(elapsed);
+    }
+    QTest::setBenchmarkResult(median(times), QTest::WalltimeMilliseconds);
+}
+
+void StartupTest::compiledQmlFirstFrame_data()
+{
+    QTest::addColumn<bool>("diskCache");
+    QTest::newRow("compiled") << true;
+    QTest::newRow("QML_DISABLE_DISK_CACHE") << false;
+}
+
+void StartupTest::compiledQmlFirstFrame()
+{
+    QFETCH(bool, diskCache);
+#ifdef Q_OS_WIN
+    QSKIP("First frame is only reported on stderr off Windows");
+#endif
+
+    // Without the disk cache the engine ignores the compilation units built
+    // into the binary and compiles every QML file from source at load
+    QProcessEnvironment environment = this->environment();
+    if (!diskCache) environment.insert("QML_DISABLE_DISK_CACHE", "1");
+
+    QList<qint64> times;
+    QList<qint64> reported;
+    for (int run = 0; run < Runs; ++run) {
+        qint64 inProcess = -1;
+        const qint64 elapsed = guiFirstFrame(environment, &inProcess);
+        QVERIFY(elapsed >= 0);
+        times.append(elapsed);
+        reported.append(inProcess);
+    }
+    qInfo() << "First frame after main():" << median(reported) << "ms";
+    QTest::setBenchmarkResult(median(times), QTest::WalltimeMilliseconds);
+}
+
+SCRIPTRUNNER_TEST(StartupTest)
+#include "tst_startup.moc"
@@ -0,0 +1,145 @@
+#include "testsuite.h"
+#include "timerwheel.h"
+#include <QHash>
+#include <QRandomGenerator>
+#include <QTest>
+#include <algorithm>
+
+class TimerWheelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void neverEarly();
+    void rescheduleAndCancel();
+    void overflowAndRefill();
+    void longGap();
+    void thousandsOfTimers();
+};
+
+// Ring of 512 slots of 100 ms: anything 51.2 s out starts in the overflow
+static const qint64 Resolution = 100;
+static const qint64 RingMs = TimerWheel::SlotCount * Resolution;
+
+void TimerWheelTest::neverEarly()
+{
+    TimerWheel wheel(0, Resolution);
+    QCOMPARE(wheel.nextDue(), qint64(-1));
+
+    wheel.schedule(1, 250);
+    wheel.schedule(2, 50);
+    wheel.schedule(3, 1000);
+    QCOMPARE(wheel.size(), 3);
+    QCOMPARE(wheel.nextDue(), qint64(100)); // Rounded up to its tick
+
+    QVERIFY(wheel.advance(99).isEmpty());
+    QCOMPARE(wheel.advance(100), QVector<quint64> { 2 });
+    QVERIFY(wheel.advance(299).isEmpty());
+    QCOMPARE(wheel.advance(300), QVector<quint64> { 1 });
+    QCOMPARE(wheel.nextDue(), qint64(1000));
+    QCOMPARE(wheel.advance(5000), QVector<quint64> { 3 });
+    QCOMPARE(wheel.size(), 0);
+    QCOMPARE(wheel.nextDue(), qint64(-1));
+
+    // Already due when scheduled: the next advance picks it up
+    wheel.schedule(4, 10);
+    QCOMPARE(wheel.advance(5100), QVector<quint64> { 4 });
+}
+
+void TimerWheelTest::rescheduleAndCancel()
+{
+    TimerWheel wheel(0, Resolution);
+    wheel.schedule(1, 500);
+    wheel.schedule(1, 2000);
+    QCOMPARE(wheel.size(), 1);
+    QCOMPARE(wheel.dueTime(1), qint64(2000));
+    QVERIFY(wheel.advance(1000).isEmpty());
+
+    // From the ring into the overflow and back
+    wheel.schedule(1, 2 * RingMs);
+    QCOMPARE(wheel.nextDue(), 2 * RingMs);
+    wheel.schedule(1, 1500);
+    QCOMPARE(wheel.nextDue(), qint64(1500));
+
+    wheel.schedule(2, 3 * RingMs);
+    QVERIFY(wheel.cancel(2));
+    QVERIFY(!wheel.cancel(2));
+    QVERIFY(!wheel.contains(2));
+    QCOMPARE(wheel.advance(10 * RingMs), QVector<quint64> { 1 });
+
+    wheel.schedule(3, 20 * RingMs);
+    wheel.clear();
+    QCOMPARE(wheel.size(), 0);
+    QCOMPARE(wheel.nextDue(), qint64(-1));
+}
+
+void TimerWheelTest::overflowAndRefill()
+{
+    TimerWheel wheel(0, Resolution);
+    wheel.schedule(1, 100000);
+    wheel.schedule(2, 60000);
+    wheel.schedule(3, 60000);
+    wheel.schedule(4, 90000);
+    QCOMPARE(wheel.nextDue(), qint64(60000));
+
+    // Turning the ring pulls the overflow into slots; nothing fires early
+    QVERIFY(wheel.advance(59999).isEmpty());
+    QCOMPARE(wheel.nextDue(), qint64(60000));
+    QVector<quint64> fired = wheel.advance(60000);
+    std::sort(fired.begin(), fired.end());
+    QCOMPARE(fired, QVector<quint64>({ 2, 3 }));
+
+    // A cancel after the refill finds the timer in its slot
+    QVERIFY(wheel.cancel(4));
+    QVERIFY(wheel.advance(99999).isEmpty());
+    QCOMPARE(wheel.advance(100000), QVector<quint64> { 1 });
+    QCOMPARE(wheel.size(), 0);
+}
+
+void TimerWheelTest::longGap()
+{
+    // A suspend: the clock jumps several turns of the ring at once
+    TimerWheel wheel(0, Resolution);
+    wheel.schedule(1, 1000);
+    wheel.schedule(2, 3 * RingMs);
+    wheel.schedule(3, 20 * RingMs);
+
+    const QVector<quint64> fired = wheel.advance(5 * RingMs);
+    QCOMPARE(fired, QVector<quint64>({ 1, 2 }));
+    QCOMPARE(wheel.nextDue(), 20 * RingMs);
+    QCOMPARE(wheel.advance(20 * RingMs), QVector<quint64> { 3 });
+}
+
+void TimerWheelTest::thousandsOfTimers()
+{
+    const qint64 start = 1000000;
+    TimerWheel wheel(start, Resolution);
+    QHash<quint64, qint64> due;
+    QRandomGenerator random(42);
+    for (quint64 id = 0; id < 10000; ++id) {
+        const qint64 at = start + random.bounded(qint64(3600 * 1000));
+        wheel.schedule(id, at);
+        due.insert(id, at);
+    }
+    QCOMPARE(wheel.size(), 10000);
+
+    // Jump straight from one wakeup to the next, as the scheduler does
+    int wakeups = 0;
+    qint64 now = start;
+    while (wheel.nextDue() >= 0) {
+        const qint64 next = wheel.nextDue();
+        QVERIFY(next >= now);
+        now = next;
+        ++wakeups;
+        for (quint64 id : wheel.advance(now)) {
+            QVERIFY2(due.value(id) <= now, "fired early");
+            QVERIFY2(now - due.value(id) < Resolution, "fired more than a tick late");
+            due.remove(id);
+        }
+    }
+    QVERIFY(due.isEmpty());
+    QVERIFY(wakeups <= 10000);
+}
+
+SCRIPTRUNNER_TEST(TimerWheelTest)
+#include "tst_timerwheel.moc"
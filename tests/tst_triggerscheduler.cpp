@@ -0,0 +1,157 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "actionmanager.h"
+#include "jobscheduler.h"
+#include "triggerscheduler.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+#include <ctime>
+
+class TriggerSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void thousandsOfSchedulesStayIdle();
+    void watchIsDebounced();
+    void recreatedFolderIsWatchedAgain();
+
+private:
+    static const int DebounceMs = 300;
+
+    static QString watchCatalog(const QTemporaryDir &dir, const QString &path, bool recursive);
+};
+
+// Counts timer events for every object of the main thread
+class TimerEventCounter : public QObject
+{
+public:
+    int count = 0;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Timer) ++count;
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+QString TriggerSchedulerTest::watchCatalog(const QTemporaryDir &dir, const QString &path, bool recursive)
+{
+    const QJsonObject action {
+        { "id", "watcher" },
+        { "name", "Watcher" },
+        { "type", "exe" },
+        { "command", "true" },
+        { "watch", QJsonObject {
+                       { "path", path },
+                       { "patterns", QJsonArray { "*.txt" } },
+                       { "recursive", recursive },
+                       { "debounce_ms", DebounceMs },
+                   } },
+    };
+    const QJsonObject root { { "actions", QJsonArray { action } } };
+    return TestUtil::writeFile(dir.path(), "actions.json", QJsonDocument(root).toJson());
+}
+
+void TriggerSchedulerTest::thousandsOfSchedulesStayIdle()
+{
+    QTemporaryDir dir;
+    const QString catalog = TestUtil::writeFile(dir.path(), "actions.json",
+                                                TestUtil::catalogJson(5000, QJsonObject { { "schedule", "@every 1h" } }));
+    ActionManager manager;
+    QVERIFY(manager.loadActions(catalog));
+    TriggerScheduler triggers(&manager);
+    QSignalSpy fired(&triggers, &TriggerScheduler::triggered);
+    QCOMPARE(triggers.rowCount(), 5000);
+
+    const QVariantList upcoming = triggers.upcoming(3);
+    QCOMPARE(upcoming.size(), 3);
+    const QDateTime first = upcoming.first().toMap().value("nextRun").toDateTime();
+    QVERIFY(first > QDateTime::currentDateTime().addSecs(3500));
+    QVERIFY(first <= upcoming.last().toMap().value("nextRun").toDateTime());
+
+    // One wheel behind one timer: nothing wakes up while nothing is due
+    TimerEventCounter counter;
+    QCoreApplication::instance()->installEventFilter(&counter);
+    const std::clock_t cpuStart = std::clock();
+    QTest::qWait(2000);
+    const double cpuMs = double(std::clock() - cpuStart) * 1000 / CLOCKS_PER_SEC;
+    QCoreApplication::instance()->removeEventFilter(&counter);
+
+    qInfo() << "5000 idle schedules:" << counter.count << "timer events," << cpuMs << "ms CPU in 2 s";
+    QVERIFY2(counter.count <= 2, qPrintable(QString("%1 timer events").arg(counter.count)));
+    QVERIFY2(cpuMs < 100, qPrintable(QString("%1 ms CPU").arg(cpuMs)));
+    QCOMPARE(fired.count(), 0);
+}
+
+void TriggerSchedulerTest::watchIsDebounced()
+{
+    QTemporaryDir dir;
+    const QString inbox = dir.filePath("inbox");
+    QVERIFY(QDir().mkpath(inbox));
+
+    JobScheduler scheduler;
+    ActionManager manager;
+    manager.setJobScheduler(&scheduler);
+    QVERIFY(manager.loadActions(watchCatalog(dir, inbox, false)));
+    TriggerScheduler triggers(&manager);
+    QSignalSpy fired(&triggers, &TriggerScheduler::triggered);
+    QTest::qWait(DebounceMs); // Baseline scan
+
+    // Files keep arriving within the debounce; one run once they stop
+    QElapsedTimer sinceLastFile;
+    qint64 settledAfterMs = -1;
+    connect(&triggers, &TriggerScheduler::triggered, this, [&]() { settledAfterMs = sinceLastFile.elapsed(); });
+
+    QStringList files;
+    for (int i = 0; i < 5; ++i) {
+        files.append(TestUtil::writeFile(inbox, QString("data-%1.txt").arg(i), "x"));
+        sinceLastFile.start();
+        QTest::qWait(DebounceMs / 4);
+    }
+    TestUtil::writeFile(inbox, "notes.csv", "x"); // Not matched by the pattern
+
+    QTRY_COMPARE_WITH_TIMEOUT(fired.count(), 1, 5000);
+    QCOMPARE(fired.first().at(0).toString(), QString("watcher"));
+    QCOMPARE(fired.first().at(1).toStringList(), files);
+    QVERIFY2(settledAfterMs >= DebounceMs, qPrintable(QString("fired %1 ms after the last file").arg(settledAfterMs)));
+
+    // Nothing new, nothing more
+    QTest::qWait(DebounceMs * 3);
+    QCOMPARE(fired.count(), 1);
+}
+
+void TriggerSchedulerTest::recreatedFolderIsWatchedAgain()
+{
+    QTemporaryDir dir;
+    const QString inbox = dir.filePath("inbox");
+    const QString sub = inbox + "/sub";
+    QVERIFY(QDir().mkpath(sub));
+
+    JobScheduler scheduler;
+    ActionManager manager;
+    manager.setJobScheduler(&scheduler);
+    QVERIFY(manager.loadActions(watchCatalog(dir, inbox, true)));
+    TriggerScheduler triggers(&manager);
+    QSignalSpy fired(&triggers, &TriggerScheduler::triggered);
+    QTest::qWait(DebounceMs);
+
+    // Deleted, then created again under the same name
+    QVERIFY(QDir(sub).removeRecursively());
+    QTest::qWait(DebounceMs * 2);
+    QVERIFY(QDir().mkpath(sub));
+    QTest::qWait(DebounceMs * 2);
+    QCOMPARE(fired.count(), 0);
+
+    // Only the new folder's own watch reports this file
+    const QString file = TestUtil::writeFile(sub, "late.txt", "x");
+    QTRY_COMPARE_WITH_TIMEOUT(fired.count(), 1, 5000);
+    QCOMPARE(fired.first().at(1).toStringList(), QStringList { file });
+}
+
+SCRIPTRUNNER_TEST(TriggerSchedulerTest)
+#include "tst_triggerscheduler.moc"
@@ -0,0 +1,84 @@
+#include "testsuite.h"
+#include "testutil.h"
+#include "actionmanager.h"
+#include "jobscheduler.h"
+#include "workflowrunner.h"
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+class WorkflowRunnerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stepInputsAreResolved();
+    void missingStepInputFailsRun();
+
+private:
+    static QString catalog(const QTemporaryDir &dir, const QJsonArray &steps);
+};
+
+// "mark" touches {dir}/{name}{verbose}, so the file name shows the resolved inputs
+QString WorkflowRunnerTest::catalog(const QTemporaryDir &dir, const QJsonArray &steps)
+{
+    const QJsonObject mark {
+        { "id", "mark" },
+        { "type", "exe_with_args" },
+        { "command", "touch {dir}/{name}{verbose}" },
+        { "inputs", QJsonArray {
+                        QJsonObject { { "id", "dir" }, { "required", true } },
+                        QJsonObject { { "id", "name" }, { "default", "world" } },
+                        QJsonObject { { "id", "verbose" }, { "type", "bool" }, { "default", false },
+                                      { "true_value", "-v" }, { "false_value", "" } },
+                    } },
+    };
+    const QJsonObject workflow { { "id", "flow" }, { "type", "workflow" }, { "steps", steps } };
+    const QJsonObject root { { "actions", QJsonArray { mark, workflow } } };
+    return TestUtil::writeFile(dir.path(), "actions.json", QJsonDocument(root).toJson());
+}
+
+void WorkflowRunnerTest::stepInputsAreResolved()
+{
+    QTemporaryDir dir;
+    const QJsonArray steps {
+        QJsonObject { { "id", "loud" }, { "action", "mark" }, { "inputs", QJsonObject { { "verbose", true } } } },
+        QJsonObject { { "id", "quiet" }, { "action", "mark" }, { "after", "loud" },
+                      { "inputs", QJsonObject { { "name", "quiet" } } } },
+    };
+    ActionManager manager;
+    QVERIFY(manager.loadActions(catalog(dir, steps)));
+    JobScheduler scheduler;
+    WorkflowRunner runner(&manager, &scheduler);
+    QSignalSpy finished(&runner, &WorkflowRunner::workflowFinished);
+
+    QString error;
+    QVERIFY2(runner.start(*manager.findAction("flow"), { { "dir", dir.path() } }, &error) > 0, qPrintable(error));
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 10000);
+    QVERIFY(finished.first().at(2).toBool());
+
+    // Bool mapped to its true_value, the default name and the false_value filled in
+    QVERIFY(QFile::exists(dir.filePath("world-v")));
+    QVERIFY(QFile::exists(dir.filePath("quiet")));
+}
+
+void WorkflowRunnerTest::missingStepInputFailsRun()
+{
+    QTemporaryDir dir;
+    const QJsonArray steps { QJsonObject { { "id", "only" }, { "action", "mark" } } };
+    ActionManager manager;
+    QVERIFY(manager.loadActions(catalog(dir, steps)));
+    JobScheduler scheduler;
+    WorkflowRunner runner(&manager, &scheduler);
+    QSignalSpy finished(&runner, &WorkflowRunner::workflowFinished);
+    QSignalSpy started(&runner, &WorkflowRunner::stepStarted);
+
+    // No dir anywhere: the step is not run, the workflow fails
+    QVERIFY(runner.start(*manager.findAction("flow"), QVariantMap()) > 0);
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 5000);
+    QVERIFY(!finished.first().at(2).toBool());
+    QCOMPARE(started.count(), 0);
+}
+
+SCRIPTRUNNER_TEST(WorkflowRunnerTest)
+#include "tst_workflowrunner.moc"
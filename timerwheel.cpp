@@ -0,0 +1,159 @@
+#include "timerwheel.h"
+#include <QtAlgorithms>
+
+TimerWheel::TimerWheel(qint64 nowMs, qint64 resolutionMs)
+    : m_resolution(qMax<qint64>(1, resolutionMs))
+    , m_currentTick(nowMs / m_resolution)
+{
+}
+
+qint64 TimerWheel::tickOf(qint64 dueMs) const
+{
+    // Rounded up, so a timer never fires before its due time
+    const qint64 tick = dueMs <= 0 ? 0 : (dueMs + m_resolution - 1) / m_resolution;
+    return qMax(tick, m_currentTick);
+}
+
+void TimerWheel::schedule(quint64 id, qint64 dueMs)
+{
+    auto it = m_due.find(id);
+    if (it != m_due.end()) {
+        unplace(id, it.value());
+        it.value() = dueMs;
+    } else {
+        m_due.insert(id, dueMs);
+    }
+    place(id, dueMs);
+}
+
+bool TimerWheel::cancel(quint64 id)
+{
+    auto it = m_due.find(id);
+    if (it == m_due.end()) return false;
+    unplace(id, it.value());
+    m_due.erase(it);
+    return true;
+}
+
+void TimerWheel::clear()
+{
+    for (QVector<Timer> &slot : m_slots) slot.clear();
+    for (quint64 &word : m_occupied) word = 0;
+    m_overflow.clear();
+    m_due.clear();
+}
+
+void TimerWheel::place(quint64 id, qint64 dueMs)
+{
+    const qint64 tick = tickOf(dueMs);
+    if (tick >= m_currentTick + SlotCount) {
+        m_overflow.insert(tick, id);
+        return;
+    }
+
+    const int slot = int(tick % SlotCount);
+    m_slots[slot].append({ id, dueMs });
+    m_occupied[slot / 64] |= quint64(1) << (slot % 64);
+}
+
+void TimerWheel::unplace(quint64 id, qint64 dueMs)
+{
+    // Overflow entries always lie past the ring, see refill()
+    const qint64 tick = tickOf(dueMs);
+    if (tick >= m_currentTick + SlotCount) {
+        for (auto it = m_overflow.find(tick); it != m_overflow.end() && it.key() == tick; ++it) {
+            if (it.value() == id) {
+                m_overflow.erase(it);
+                return;
+            }
+        }
+        return;
+    }
+
+    const int slot = int(tick % SlotCount);
+    QVector<Timer> &timers = m_slots[slot];
+    for (qsizetype i = 0; i < timers.size(); ++i) {
+        if (timers.at(i).id != id) continue;
+        timers[i] = timers.constLast();
+        timers.removeLast();
+        break;
+    }
+    if (timers.isEmpty()) m_occupied[slot / 64] &= ~(quint64(1) << (slot % 64));
+}
+
+int TimerWheel::nextOccupiedSlot() const
+{
+    // Search from the current slot to the end of the ring, then wrap
+    const int start = int(m_currentTick % SlotCount);
+    for (int pass = 0; pass < 2; ++pass) {
+        const int from = pass == 0 ? start : 0;
+        const int to = pass == 0 ? SlotCount : start;
+        for (int word = from / 64; word * 64 < to; ++word) {
+            quint64 bits = m_occupied[word];
+            if (word == from / 64) bits &= ~quint64(0) << (from % 64);
+            if (!bits) continue;
+            const int slot = word * 64 + int(qCountTrailingZeroBits(bits));
+            if (slot < to) return slot;
+        }
+    }
+    return -1;
+}
+
+qint64 TimerWheel::nextDue() const
+{
+    // Reported at tick granularity: advance() expires whole ticks
+    const int slot = nextOccupiedSlot();
+    if (slot >= 0) {
+        const qint64 offset = (slot - m_currentTick % SlotCount + SlotCount) % SlotCount;
+        return (m_currentTick + offset) * m_resolution;
+    }
+    if (!m_overflow.isEmpty()) return m_overflow.firstKey() * m_resolution;
+    return -1;
+}
+
+QVector<quint64> TimerWheel::advance(qint64 nowMs)
+{
+    QVector<quint64> fired;
+    const qint64 nowTick = nowMs / m_resolution;
+    if (nowTick < m_currentTick) return fired;
+
+    // One turn of the ring at most; anything further out is in the overflow
+    const qint64 last = qMin(nowTick, m_currentTick + SlotCount - 1);
+    for (qint64 tick = m_currentTick; tick <= last; ++tick) {
+        const int slot = int(tick % SlotCount);
+        if (!(m_occupied[slot / 64] & (quint64(1) << (slot % 64)))) continue;
+
+        for (const Timer &timer : std::as_const(m_slots[slot])) {
+            fired.append(timer.id);
+            m_due.remove(timer.id);
+        }
+        m_slots[slot].clear();
+        m_occupied[slot / 64] &= ~(quint64(1) << (slot % 64));
+    }
+
+    // After a long gap some overflow timers are due outright
+    while (!m_overflow.isEmpty() && m_overflow.firstKey() <= nowTick) {
+        const quint64 id = m_overflow.first();
+        m_overflow.erase(m_overflow.begin());
+        fired.append(id);
+        m_due.remove(id);
+    }
+
+    m_currentTick = nowTick + 1;
+    refill();
+    return fired;
+}
+
+void TimerWheel::refill()
+{
+    // Pull overflow timers that now fall within one turn of the ring
+    while (!m_overflow.isEmpty() && m_overflow.firstKey() < m_currentTick + SlotCount) {
+        const qint64 tick = m_overflow.firstKey();
+        const quint64 id = m_overflow.first();
+        m_overflow.erase(m_overflow.begin());
+
+        const int slot = int(tick % SlotCount);
+        m_slots[slot].append({ id, m_due.value(id) });
+        m_occupied[slot / 64] |= quint64(1) << (slot % 64);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QHash>
+#include <QMultiMap>
+#include <QVector>
+
+// Hashed timer wheel keyed by caller ids. Timers within SlotCount ticks of
+// now sit in a ring of slots; later ones wait in an ordered overflow map and
+// move onto the ring as it turns. An occupancy bitmap finds the next busy
+// slot without scanning, so the owner only needs one wakeup at nextDue().
+// Times are absolute milliseconds; timers fire at most one tick late and
+// never early.
+class TimerWheel
+{
+public:
+    static const int SlotCount = 512;
+
+    // nowMs anchors the ring; pass the same clock to advance()
+    explicit TimerWheel(qint64 nowMs, qint64 resolutionMs = 100);
+
+    // Re-scheduling an id replaces its previous due time
+    void schedule(quint64 id, qint64 dueMs);
+    bool cancel(quint64 id);
+    void clear();
+
+    bool contains(quint64 id) const { return m_due.contains(id); }
+    qint64 dueTime(quint64 id) const { return m_due.value(id, -1); }
+    int size() const { return int(m_due.size()); }
+
+    // Earliest due time, -1 when empty
+    qint64 nextDue() const;
+    // Removes and returns every timer due at nowMs, earliest tick first
+    QVector<quint64> advance(qint64 nowMs);
+
+private:
+    struct Timer {
+        quint64 id;
+        qint64 due;
+    };
+
+    qint64 m_resolution;
+    qint64 m_currentTick; // First tick not yet expired
+    QVector<Timer> m_slots[SlotCount];
+    quint64 m_occupied[SlotCount / 64] = {};
+    QMultiMap<qint64, quint64> m_overflow; // tick -> id, beyond the ring
+    QHash<quint64, qint64> m_due;
+
+    qint64 tickOf(qint64 dueMs) const;
+    void place(quint64 id, qint64 dueMs);
+    void unplace(quint64 id, qint64 dueMs);
+    int nextOccupiedSlot() const;
+    void refill();
+};
+
+#endif // TIMERWHEEL_H
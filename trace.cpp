@@ -0,0 +1,173 @@
+#include "trace.h"
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+#include <chrono>
+#include <memory>
+
+// A runaway loop shouldn't take the process down with it
+static const qsizetype MaxEventsPerThread = 1 << 20;
+
+std::atomic<bool> Trace::s_enabled { false };
+
+namespace {
+
+struct Event {
+    const char *name;
+    const char *category;
+    qint64 startNs;
+    qint64 durationNs; // -1 for instant events
+    QString detail;
+};
+
+// Only its own thread appends; the lock is taken by finish() as well, so
+// it is never contended while recording
+struct ThreadBuffer {
+    QMutex mutex;
+    QVector<Event> events;
+    qint64 dropped = 0;
+    QString threadName;
+    int tid = 0;
+};
+
+// Buffers are shared with the registry so events survive thread exit,
+// e.g. a QThreadPool thread expiring before the trace is written
+struct Registry {
+    QMutex mutex;
+    QVector<std::shared_ptr<ThreadBuffer>> buffers;
+    QString path;
+    qint64 originNs = 0;
+    QThread *mainThread = nullptr; // The one that called start()
+    int nextTid = 1;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer *threadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (buffer) return buffer.get();
+
+    buffer = std::make_shared<ThreadBuffer>();
+    QThread *thread = QThread::currentThread();
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    buffer->tid = reg.nextTid++;
+    buffer->threadName = thread == reg.mainThread ? QStringLiteral("main") : thread->objectName();
+    if (buffer->threadName.isEmpty()) buffer->threadName = QString("thread %1").arg(buffer->tid);
+    reg.buffers.append(buffer);
+    return buffer.get();
+}
+
+void record(Event &&event)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    QMutexLocker locker(&buffer->mutex);
+    if (buffer->events.size() >= MaxEventsPerThread) {
+        ++buffer->dropped;
+        return;
+    }
+    buffer->events.append(std::move(event));
+}
+
+} // namespace
+
+void Trace::start(const QString &path)
+{
+    Registry &reg = registry();
+    {
+        QMutexLocker locker(&reg.mutex);
+        reg.path = path;
+        reg.originNs = nowNs();
+        reg.mainThread = QThread::currentThread();
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool Trace::finish()
+{
+    if (!s_enabled.exchange(false)) return false;
+
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    auto microseconds = [](qint64 ns) { return double(ns) / 1000.0; };
+
+    QJsonArray events;
+    events.append(QJsonObject { { "ph", "M" }, { "name", "process_name" }, { "pid", pid },
+                                { "args", QJsonObject { { "name", "ScriptRunner" } } } });
+
+    qint64 total = 0;
+    qint64 dropped = 0;
+    for (const std::shared_ptr<ThreadBuffer> &buffer : std::as_const(reg.buffers)) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        events.append(QJsonObject { { "ph", "M" }, { "name", "thread_name" }, { "pid", pid },
+                                    { "tid", buffer->tid },
+                                    { "args", QJsonObject { { "name", buffer->threadName } } } });
+
+        for (const Event &event : std::as_const(buffer->events)) {
+            QJsonObject object { { "name", event.name }, { "cat", event.category }, { "pid", pid },
+                                 { "tid", buffer->tid }, { "ts", microseconds(event.startNs - reg.originNs) } };
+            if (event.durationNs >= 0) {
+                object.insert("ph", "X");
+                object.insert("dur", microseconds(event.durationNs));
+            } else {
+                object.insert("ph", "i");
+                object.insert("s", "t");
+            }
+            if (!event.detail.isEmpty()) object.insert("args", QJsonObject { { "detail", event.detail } });
+            events.append(object);
+        }
+        total += buffer->events.size();
+        dropped += buffer->dropped;
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+
+    QSaveFile file(reg.path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write trace to" << reg.path << file.errorString();
+        return false;
+    }
+    const QJsonObject root { { "traceEvents", events }, { "displayTimeUnit", "ms" } };
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "Could not write trace to" << reg.path << file.errorString();
+        return false;
+    }
+
+    if (dropped > 0) qWarning() << "Trace buffer full," << dropped << "events dropped";
+    qDebug() << "Trace with" << total << "events written to" << reg.path;
+    return true;
+}
+
+qint64 Trace::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::complete(const char *name, const char *category, qint64 startNs, qint64 endNs,
+                     const QString &detail)
+{
+    if (!isEnabled()) return;
+    record({ name, category, startNs, endNs - startNs, detail });
+}
+
+void Trace::instant(const char *name, const char *category, const QString &detail)
+{
+    if (!isEnabled()) return;
+    record({ name, category, nowNs(), -1, detail });
+}
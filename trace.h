@@ -0,0 +1,67 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// Scoped spans for startup and execution profiling, written as Chrome trace
+// JSON for chrome://tracing or ui.perfetto.dev. Every thread records into
+// its own buffer, so spans on worker threads don't contend with the UI
+// thread; with tracing off a span costs one relaxed load and a branch.
+// Turned on with SCRIPTRUNNER_TRACE=<file> or --trace <file>.
+class Trace
+{
+public:
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Starts recording; finish() writes everything recorded so far to path
+    static void start(const QString &path);
+    static bool finish();
+
+    static qint64 nowNs();
+
+    // Names and categories must be string literals, only the pointer is kept
+    static void complete(const char *name, const char *category, qint64 startNs, qint64 endNs,
+                         const QString &detail = QString());
+    static void instant(const char *name, const char *category, const QString &detail = QString());
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceSpan
+{
+public:
+    TraceSpan(const char *name, const char *category)
+        : m_name(name)
+        , m_category(category)
+        , m_startNs(Trace::isEnabled() ? Trace::nowNs() : -1)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (m_startNs >= 0) Trace::complete(m_name, m_category, m_startNs, Trace::nowNs(), m_detail);
+    }
+
+    // Shown as args.detail in the viewer, e.g. the action id
+    void setDetail(const QString &detail)
+    {
+        if (m_startNs >= 0) m_detail = detail;
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *m_name;
+    const char *m_category;
+    qint64 m_startNs;
+    QString m_detail;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name, category) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name, category)
+
+#endif // TRACE_H
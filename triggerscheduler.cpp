@@ -0,0 +1,409 @@
+#include "triggerscheduler.h"
+#include "actionmanager.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QSet>
+#include <QThreadPool>
+#include <QDebug>
+#include <algorithm>
+
+// Wall-clock changes and suspends are noticed within this long
+static const qint64 MaxSleepMs = 60 * 1000;
+
+TriggerScheduler::TriggerScheduler(ActionManager *manager, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_manager(manager)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_wheel(QDateTime::currentMSecsSinceEpoch())
+{
+    m_wakeup.setSingleShot(true);
+    m_wakeup.setTimerType(Qt::PreciseTimer);
+    connect(&m_wakeup, &QTimer::timeout, this, &TriggerScheduler::expire);
+
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &TriggerScheduler::pathChanged);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &TriggerScheduler::pathChanged);
+
+    connect(m_manager, &ActionManager::actionsChanged, this, &TriggerScheduler::rebuild);
+    connect(m_manager, &ActionManager::actionsReloaded, this, &TriggerScheduler::rebuild);
+    rebuild();
+}
+
+int TriggerScheduler::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return int(m_triggers.size());
+}
+
+QVariant TriggerScheduler::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_triggers.size()) return QVariant();
+
+    const Trigger &trigger = m_triggers.at(index.row());
+    switch (role) {
+    case ActionIdRole:
+        return trigger.actionId;
+    case NameRole:
+    case Qt::DisplayRole:
+        return trigger.name;
+    case KindRole:
+        return trigger.watchPath.isEmpty() ? QStringLiteral("schedule") : QStringLiteral("watch");
+    case TriggerRole:
+        return trigger.watchPath.isEmpty() ? trigger.schedule.text() : trigger.watchPath;
+    case NextRunRole:
+        return trigger.nextRun;
+    case LastRunRole:
+        return trigger.lastRun;
+    case RunCountRole:
+        return trigger.runCount;
+    case ErrorRole:
+        return trigger.error;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> TriggerScheduler::roleNames() const
+{
+    return {
+        { ActionIdRole, "actionId" },
+        { NameRole, "name" },
+        { KindRole, "kind" },
+        { TriggerRole, "trigger" },
+        { NextRunRole, "nextRun" },
+        { LastRunRole, "lastRun" },
+        { RunCountRole, "runCount" },
+        { ErrorRole, "error" }
+    };
+}
+
+QVariantList TriggerScheduler::upcoming(int limit) const
+{
+    QVector<int> rows;
+    for (int row = 0; row < m_triggers.size(); ++row) {
+        if (m_triggers.at(row).nextRun.isValid()) rows.append(row);
+    }
+
+    const auto byNextRun = [this](int a, int b) {
+        return m_triggers.at(a).nextRun < m_triggers.at(b).nextRun;
+    };
+    const qsizetype count = qBound<qsizetype>(0, limit, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), byNextRun);
+
+    QVariantList result;
+    const QHash<int, QByteArray> roles = roleNames();
+    for (qsizetype i = 0; i < count; ++i) {
+        QVariantMap entry;
+        for (auto role = roles.cbegin(); role != roles.cend(); ++role)
+            entry.insert(QString::fromLatin1(role.value()), data(index(rows.at(i)), role.key()));
+        result.append(entry);
+    }
+    return result;
+}
+
+bool TriggerScheduler::trigger(const QString &actionId)
+{
+    for (int row = 0; row < m_triggers.size(); ++row) {
+        if (m_triggers.at(row).actionId == actionId) {
+            fire(row, QStringList());
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TriggerScheduler::enabled() const
+{
+    return m_enabled;
+}
+
+void TriggerScheduler::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) return;
+    m_enabled = enabled;
+
+    if (m_enabled) {
+        // Missed runs are skipped and changes made meanwhile are not replayed
+        const QDateTime now = QDateTime::currentDateTime();
+        for (int row = 0; row < m_triggers.size(); ++row) {
+            if (m_triggers.at(row).schedule.isValid()) scheduleNext(row, now);
+            if (!m_triggers.at(row).watchPath.isEmpty()) {
+                m_triggers[row].primed = false;
+                scan(row);
+            }
+        }
+    }
+    armWakeup();
+    emit enabledChanged();
+}
+
+void TriggerScheduler::rebuild()
+{
+    ++m_generation;
+
+    // Run history survives a reload of the catalog
+    QHash<QString, Trigger> previous;
+    for (const Trigger &trigger : std::as_const(m_triggers)) previous.insert(trigger.actionId, trigger);
+
+    const int previousCount = int(m_triggers.size());
+    const QString baseDir = QFileInfo(m_manager->actionsPath()).absolutePath();
+
+    beginResetModel();
+    m_triggers.clear();
+    m_wheel.clear();
+    m_watchedPaths.clear();
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    if (!watched.isEmpty()) m_watcher->removePaths(watched);
+
+    for (const ActionDefinition &action : m_manager->actions()) {
+        if (action.schedule.isEmpty() && action.watch.isEmpty()) continue;
+        if (m_manager->findAction(action.id) != &action) continue; // Shadowed duplicate id
+
+        Trigger trigger;
+        trigger.actionId = action.id;
+        trigger.name = action.name;
+
+        if (!action.schedule.isEmpty()) {
+            trigger.schedule = CronExpression::parse(action.schedule, &trigger.error);
+            if (!trigger.schedule.isValid()) qWarning() << "Schedule of" << action.id << ":" << trigger.error;
+        }
+
+        if (!action.watch.isEmpty()) {
+            const QString path = action.watch.value("path").toString();
+            trigger.watchPath = path.isEmpty() ? QString() : QDir(baseDir).absoluteFilePath(path);
+            for (const QJsonValue &pattern : action.watch.value("patterns").toArray())
+                trigger.patterns.append(pattern.toString());
+            if (action.watch.contains("pattern")) trigger.patterns.append(action.watch.value("pattern").toString());
+            trigger.recursive = action.watch.value("recursive").toBool(false);
+            trigger.debounceMs = qMax(0, action.watch.value("debounce_ms").toInt(trigger.debounceMs));
+            if (trigger.watchPath.isEmpty()) trigger.error = "Watch has no path";
+        }
+
+        for (const InputDefinition &input : action.inputDefs) {
+            if (input.defaultValue.isValid()) trigger.defaults.insert(input.id, input.defaultValue);
+        }
+
+        auto old = previous.constFind(action.id);
+        if (old != previous.constEnd()) {
+            trigger.lastRun = old->lastRun;
+            trigger.runCount = old->runCount;
+        }
+        m_triggers.append(std::move(trigger));
+    }
+    endResetModel();
+
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int row = 0; row < m_triggers.size(); ++row) {
+        const Trigger &trigger = m_triggers.at(row);
+        if (trigger.schedule.isValid()) scheduleNext(row, now);
+        if (!trigger.watchPath.isEmpty()) {
+            watchPath(row, trigger.watchPath);
+            scan(row); // Baseline, nothing fires for files already there
+        }
+    }
+    armWakeup();
+
+    if (m_triggers.size() != previousCount) emit countChanged();
+    qDebug() << "Triggers armed:" << m_triggers.size();
+}
+
+void TriggerScheduler::watchPath(int row, const QString &path)
+{
+    if (!QFileInfo::exists(path)) {
+        m_triggers[row].error = QString("Watched path %1 does not exist").arg(path);
+        qWarning() << "Trigger" << m_triggers.at(row).actionId << ":" << m_triggers.at(row).error;
+        return;
+    }
+
+    QVector<int> &rows = m_watchedPaths[path];
+    if (rows.contains(row)) return;
+    rows.append(row);
+    if (rows.size() == 1) m_watcher->addPath(path);
+}
+
+void TriggerScheduler::pruneWatchedPaths()
+{
+    // A deleted path drops out of the watcher on its own; forget it here as
+    // well, or watchPath() takes it for watched and never adds it back
+    const QStringList reported = m_watcher->files() + m_watcher->directories();
+    const QSet<QString> watched(reported.cbegin(), reported.cend());
+    for (auto it = m_watchedPaths.begin(); it != m_watchedPaths.end();) {
+        if (watched.contains(it.key()))
+            ++it;
+        else
+            it = m_watchedPaths.erase(it);
+    }
+}
+
+void TriggerScheduler::pathChanged(const QString &path)
+{
+    // Save-by-rename drops a watched file from the watcher
+    if (!m_watcher->files().contains(path) && !m_watcher->directories().contains(path)
+        && QFileInfo::exists(path)) {
+        m_watcher->addPath(path);
+    }
+    if (!m_enabled) return;
+
+    // Restart the debounce on every event; the scan runs once things settle
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int row : m_watchedPaths.value(path))
+        m_wheel.schedule(debounceTimer(row), now + m_triggers.at(row).debounceMs);
+    armWakeup();
+}
+
+void TriggerScheduler::scheduleNext(int row, const QDateTime &after)
+{
+    Trigger &trigger = m_triggers[row];
+    trigger.nextRun = trigger.schedule.next(after);
+    if (trigger.nextRun.isValid())
+        m_wheel.schedule(scheduleTimer(row), trigger.nextRun.toMSecsSinceEpoch());
+    else
+        m_wheel.cancel(scheduleTimer(row));
+
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { NextRunRole });
+}
+
+void TriggerScheduler::armWakeup()
+{
+    const qint64 due = m_wheel.nextDue();
+    if (!m_enabled || due < 0) {
+        m_wakeup.stop();
+        return;
+    }
+
+    const qint64 wait = qBound<qint64>(0, due - QDateTime::currentMSecsSinceEpoch(), MaxSleepMs);
+    m_wakeup.start(int(wait));
+}
+
+void TriggerScheduler::expire()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    const QVector<quint64> due = m_wheel.advance(now.toMSecsSinceEpoch());
+
+    const quint64 generation = m_generation;
+    for (quint64 id : due) {
+        const int row = int(id / 2);
+        if (row >= m_triggers.size()) continue;
+
+        if (id == scheduleTimer(row)) {
+            fire(row, QStringList());
+            // Running the action reloaded the catalog; rebuild() re-armed everything
+            if (m_generation != generation) return;
+            // From now, not from the missed slot: a late wakeup runs once
+            scheduleNext(row, now);
+        } else {
+            scan(row);
+        }
+    }
+    armWakeup();
+}
+
+void TriggerScheduler::fire(int row, const QStringList &files)
+{
+    if (!m_enabled) return;
+
+    Trigger &trigger = m_triggers[row];
+    trigger.lastRun = QDateTime::currentDateTime();
+    ++trigger.runCount;
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { LastRunRole, RunCountRole });
+
+    // Copies: running the action can reload the catalog and rebuild the rows
+    const QString actionId = trigger.actionId;
+    const QVariantMap defaults = trigger.defaults;
+    qDebug() << "Trigger fired:" << actionId << "files:" << files.size();
+    emit triggered(actionId, files);
+
+    if (files.isEmpty())
+        m_manager->executeActionWithInputs(actionId, defaults);
+    else
+        m_manager->executeActionWithFiles(actionId, files, defaults);
+}
+
+void TriggerScheduler::scan(int row)
+{
+    Trigger &trigger = m_triggers[row];
+    if (trigger.scanning) {
+        trigger.rescan = true;
+        return;
+    }
+    trigger.scanning = true;
+
+    // A recursive folder can be large; walk it on the thread pool
+    const quint64 generation = m_generation;
+    const QString path = trigger.watchPath;
+    const QStringList patterns = trigger.patterns;
+    const bool recursive = trigger.recursive;
+    QPointer<TriggerScheduler> self(this);
+    QThreadPool::globalInstance()->start([self, generation, row, path, patterns, recursive]() {
+        const ScanResult result = scanPath(path, patterns, recursive);
+        if (!self) return;
+        QMetaObject::invokeMethod(self.data(), [self, generation, row, result]() {
+            if (self && self->m_generation == generation) self->applyScan(row, result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+TriggerScheduler::ScanResult TriggerScheduler::scanPath(const QString &path, const QStringList &patterns,
+                                                        bool recursive)
+{
+    ScanResult result;
+    const QFileInfo root(path);
+    auto record = [&result](const QFileInfo &info) {
+        result.files.insert(info.absoluteFilePath(),
+                            qMakePair(info.lastModified().toMSecsSinceEpoch(), info.size()));
+    };
+
+    if (root.isFile()) {
+        record(root);
+        return result;
+    }
+    if (!root.isDir()) return result;
+
+    QDirIterator files(path, patterns, QDir::Files | QDir::NoDotAndDotDot,
+                       recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (files.hasNext()) {
+        files.next();
+        record(files.fileInfo());
+    }
+
+    if (recursive) {
+        QDirIterator directories(path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (directories.hasNext()) result.directories.append(directories.next());
+    }
+    return result;
+}
+
+void TriggerScheduler::applyScan(int row, const ScanResult &result)
+{
+    Trigger &trigger = m_triggers[row];
+    trigger.scanning = false;
+
+    QStringList changed;
+    if (trigger.primed) {
+        for (auto it = result.files.cbegin(); it != result.files.cend(); ++it) {
+            auto old = trigger.snapshot.constFind(it.key());
+            if (old == trigger.snapshot.constEnd() || old.value() != it.value()) changed.append(it.key());
+        }
+    }
+    trigger.snapshot = result.files;
+    trigger.primed = true;
+
+    // New subfolders of a recursive watch, including ones deleted and
+    // created again under the same name
+    if (trigger.recursive) pruneWatchedPaths();
+    for (const QString &directory : result.directories) watchPath(row, directory);
+
+    const bool rescan = trigger.rescan;
+    trigger.rescan = false;
+
+    const quint64 generation = m_generation;
+    if (!changed.isEmpty()) {
+        std::sort(changed.begin(), changed.end());
+        fire(row, changed);
+    }
+    if (rescan && m_generation == generation) scan(row);
+}
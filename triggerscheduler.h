@@ -0,0 +1,114 @@
+#ifndef TRIGGERSCHEDULER_H
+#define TRIGGERSCHEDULER_H
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+
+#include "cronexpression.h"
+#include "timerwheel.h"
+
+class ActionManager;
+class QFileSystemWatcher;
+
+// Runs actions on their own: "schedule" (see CronExpression) and
+// "watch": { "path": "...", "patterns": ["*.csv"], "recursive": false,
+// "debounce_ms": 500 }. Every due time, schedules and watch debounces
+// alike, lives on one TimerWheel behind a single QTimer, so an idle
+// catalog of thousands of triggers costs one wakeup. Watched folders go
+// through QFileSystemWatcher (inotify on Linux); once a folder settles it
+// is rescanned off the UI thread and only new or modified files are run.
+// One row per trigger, for the next-run table in QML.
+class TriggerScheduler : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+
+public:
+    enum Roles {
+        ActionIdRole = Qt::UserRole + 1,
+        NameRole,
+        KindRole,     // "schedule" or "watch"
+        TriggerRole,  // Schedule text or watched path
+        NextRunRole,
+        LastRunRole,
+        RunCountRole,
+        ErrorRole
+    };
+
+    explicit TriggerScheduler(ActionManager *manager, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // Scheduled triggers soonest first, as maps with the role names
+    Q_INVOKABLE QVariantList upcoming(int limit = 10) const;
+    // Fire now, outside the schedule
+    Q_INVOKABLE bool trigger(const QString &actionId);
+
+    bool enabled() const;
+    void setEnabled(bool enabled);
+
+signals:
+    void countChanged();
+    void enabledChanged();
+    void triggered(const QString &actionId, const QStringList &files);
+
+private:
+    struct Trigger {
+        QString actionId;
+        QString name;
+        CronExpression schedule;
+        QString watchPath;
+        QStringList patterns;
+        bool recursive = false;
+        int debounceMs = 500;
+        QVariantMap defaults; // Input defaults; nobody is around to ask
+        QDateTime nextRun;
+        QDateTime lastRun;
+        int runCount = 0;
+        QString error;
+        bool scanning = false;
+        bool rescan = false; // Changed again while scanning
+        bool primed = false; // First scan only records the baseline
+        QHash<QString, QPair<qint64, qint64>> snapshot; // file -> (mtime, size)
+    };
+
+    struct ScanResult {
+        QHash<QString, QPair<qint64, qint64>> files;
+        QStringList directories;
+    };
+
+    ActionManager *m_manager;
+    QVector<Trigger> m_triggers;
+    QHash<QString, QVector<int>> m_watchedPaths; // path -> trigger rows
+    QFileSystemWatcher *m_watcher;
+    TimerWheel m_wheel;
+    QTimer m_wakeup;
+    quint64 m_generation = 0; // Bumped on rebuild; stale scans are dropped
+    bool m_enabled = true;
+
+    // Wheel ids: row * 2 for the schedule, row * 2 + 1 for a watch debounce
+    static quint64 scheduleTimer(int row) { return quint64(row) * 2; }
+    static quint64 debounceTimer(int row) { return quint64(row) * 2 + 1; }
+
+    void rebuild();
+    void watchPath(int row, const QString &path);
+    void pruneWatchedPaths();
+    void pathChanged(const QString &path);
+    void scheduleNext(int row, const QDateTime &after);
+    void armWakeup();
+    void expire();
+    void fire(int row, const QStringList &files);
+    void scan(int row);
+    void applyScan(int row, const ScanResult &result);
+    static ScanResult scanPath(const QString &path, const QStringList &patterns, bool recursive);
+};
+
+#endif // TRIGGERSCHEDULER_H
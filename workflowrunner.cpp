@@ -0,0 +1,346 @@
+#include "workflowrunner.h"
+#include "actionmanager.h"
+#include "jobscheduler.h"
+#include <QJsonArray>
+#include <QQueue>
+#include <QSet>
+#include <QDebug>
+
+// Substitute {name} references in a step input without quoting; the final
+// command template decides how the value is escaped
+static QString substitute(const QString &text, const QVariantMap &values)
+{
+    const CommandTemplate compiled = CommandTemplate::compile(text);
+    if (!compiled.hasPlaceholders()) return text;
+
+    QString result;
+    for (const CommandTemplate::Segment &segment : compiled.segments()) {
+        if (segment.isPlaceholder)
+            result.append(values.value(segment.name).toString());
+        else
+            result.append(QStringView(compiled.source()).mid(segment.offset, segment.length));
+    }
+    return result;
+}
+
+static void setError(QString *error, const QString &message)
+{
+    if (error) *error = message;
+}
+
+bool WorkflowDefinition::fromJson(const QJsonObject &object, WorkflowDefinition *workflow, QString *error)
+{
+    const QJsonArray steps = object.value("steps").toArray();
+    if (steps.isEmpty()) {
+        setError(error, "workflow has no steps");
+        return false;
+    }
+
+    WorkflowDefinition result;
+    result.maxParallel = qMax(0, object.value("max_parallel").toInt());
+
+    QHash<QString, int> stepIndex;
+    for (const QJsonValue &value : steps) {
+        const QJsonObject stepObject = value.toObject();
+
+        WorkflowStep step;
+        step.id = stepObject.value("id").toString();
+        step.action = stepObject.value("action").toString();
+        step.inputs = stepObject.value("inputs").toObject().toVariantMap();
+
+        const QJsonValue after = stepObject.value("after");
+        if (after.isString()) {
+            step.after.append(after.toString());
+        } else {
+            for (const QJsonValue &dependency : after.toArray())
+                step.after.append(dependency.toString());
+        }
+
+        const QString policy = stepObject.value("on_failure").toString("stop");
+        if (policy == "stop") {
+            step.onFailure = WorkflowStep::Stop;
+        } else if (policy == "continue") {
+            step.onFailure = WorkflowStep::Continue;
+        } else if (policy == "retry") {
+            step.onFailure = WorkflowStep::Retry;
+            step.retries = qMax(1, stepObject.value("retries").toInt(1));
+        } else {
+            setError(error, QString("step '%1': unknown on_failure '%2'").arg(step.id, policy));
+            return false;
+        }
+
+        if (step.id.isEmpty() || step.action.isEmpty()) {
+            setError(error, "every step needs an id and an action");
+            return false;
+        }
+        if (stepIndex.contains(step.id)) {
+            setError(error, QString("duplicate step id '%1'").arg(step.id));
+            return false;
+        }
+
+        stepIndex.insert(step.id, result.steps.size());
+        result.steps.append(step);
+    }
+
+    // Kahn's algorithm: every step must be reachable from the roots
+    QVector<int> waiting(result.steps.size(), 0);
+    QVector<QVector<int>> dependents(result.steps.size());
+    for (int i = 0; i < result.steps.size(); ++i) {
+        for (const QString &dependency : std::as_const(result.steps[i].after)) {
+            if (!stepIndex.contains(dependency)) {
+                setError(error, QString("step '%1' depends on unknown step '%2'")
+                                    .arg(result.steps[i].id, dependency));
+                return false;
+            }
+            dependents[stepIndex.value(dependency)].append(i);
+            ++waiting[i];
+        }
+    }
+
+    QQueue<int> ready;
+    for (int i = 0; i < waiting.size(); ++i) {
+        if (waiting[i] == 0) ready.enqueue(i);
+    }
+
+    int ordered = 0;
+    while (!ready.isEmpty()) {
+        const int step = ready.dequeue();
+        ++ordered;
+        for (int dependent : std::as_const(dependents[step])) {
+            if (--waiting[dependent] == 0) ready.enqueue(dependent);
+        }
+    }
+
+    if (ordered != result.steps.size()) {
+        setError(error, "workflow steps form a cycle");
+        return false;
+    }
+
+    *workflow = result;
+    return true;
+}
+
+WorkflowRunner::WorkflowRunner(const ActionManager *actions, JobScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_actions(actions)
+    , m_scheduler(scheduler)
+{
+    connect(m_scheduler, &JobScheduler::jobFinished, this,
+            [this](int jobId, int exitCode, QProcess::ExitStatus exitStatus) {
+                completeStep(jobId, exitStatus == QProcess::NormalExit && exitCode == 0, exitCode);
+            });
+    connect(m_scheduler, &JobScheduler::jobError, this, [this](int jobId) {
+        completeStep(jobId, false, -1);
+    });
+    connect(m_scheduler, &JobScheduler::jobCanceled, this, [this](int jobId) {
+        completeStep(jobId, false, -1);
+    });
+}
+
+int WorkflowRunner::start(const ActionDefinition &workflow, const QVariantMap &inputs, QString *error)
+{
+    Run run;
+    if (!WorkflowDefinition::fromJson(workflow.object(), &run.definition, error))
+        return 0;
+
+    // Resolve the steps now so a catalog reload cannot change a running workflow
+    QHash<QString, int> stepIndex;
+    run.steps.resize(run.definition.steps.size());
+    for (int i = 0; i < run.definition.steps.size(); ++i) {
+        const WorkflowStep &step = run.definition.steps.at(i);
+        const ActionDefinition *action = m_actions->findAction(step.action);
+        if (!action) {
+            setError(error, QString("step '%1': action '%2' not found").arg(step.id, step.action));
+            return 0;
+        }
+        if (!action->runsAsJob()) {
+            setError(error, QString("step '%1': action type '%2' cannot run in a workflow")
+                                .arg(step.id, action->type));
+            return 0;
+        }
+        run.steps[i].action = *action;
+        run.steps[i].waitingOn = step.after.size();
+        stepIndex.insert(step.id, i);
+    }
+    for (int i = 0; i < run.definition.steps.size(); ++i) {
+        for (const QString &dependency : run.definition.steps.at(i).after)
+            run.steps[stepIndex.value(dependency)].dependents.append(i);
+    }
+
+    run.id = m_nextRunId++;
+    run.workflowId = workflow.id;
+    run.variables = inputs;
+
+    const int runId = run.id;
+    m_runs.insert(runId, run);
+    emit workflowStarted(runId, workflow.id);
+
+    auto it = m_runs.find(runId);
+    if (it != m_runs.end()) advance(it.value());
+    return runId;
+}
+
+bool WorkflowRunner::cancel(int runId)
+{
+    auto it = m_runs.find(runId);
+    if (it == m_runs.end()) return false;
+
+    it->stopping = true;
+    it->failed = true;
+
+    QList<int> jobs;
+    for (const StepState &state : std::as_const(it->steps)) {
+        if (state.status == StepState::Running) jobs.append(state.jobId);
+    }
+
+    // Cancellation reports back through completeStep, which may end the run
+    for (int jobId : std::as_const(jobs)) m_scheduler->cancel(jobId);
+    return true;
+}
+
+bool WorkflowRunner::isRunning(int runId) const
+{
+    return m_runs.contains(runId);
+}
+
+void WorkflowRunner::advance(Run &run)
+{
+    const int limit = run.definition.maxParallel;
+
+    // A step that fails to start settles at once and may release others
+    bool progressed = true;
+    while (progressed && !run.stopping) {
+        progressed = false;
+        for (int i = 0; i < run.steps.size(); ++i) {
+            if (limit > 0 && run.running >= limit) break;
+
+            const StepState &state = run.steps.at(i);
+            if (state.status != StepState::Pending || state.waitingOn > 0) continue;
+
+            if (!startStep(run, i)) {
+                settleStep(run, i, false);
+                progressed = true;
+            }
+        }
+    }
+
+    if (run.running == 0) finishRun(run.id);
+}
+
+bool WorkflowRunner::startStep(Run &run, int step)
+{
+    StepState &state = run.steps[step];
+    const WorkflowStep &definition = run.definition.steps.at(step);
+
+    QVariantMap given = run.variables;
+    for (auto it = definition.inputs.cbegin(); it != definition.inputs.cend(); ++it)
+        given.insert(it.key(), substitute(it.value().toString(), run.variables));
+    ++state.attempts;
+
+    // Defaults and bool values of the step's action, as for a direct run
+    QVariantMap values;
+    QString error;
+    if (!state.action.resolveInputs(given, &values, &error)) {
+        qWarning() << "Workflow" << run.workflowId << "step" << definition.id << "not run:" << error;
+        return false;
+    }
+
+    // Values such as {build.output} can hold quotes; they must stay one argument
+    QStringList argv = state.action.commandTemplate.renderArguments(values);
+    const QString command = argv.join(' ');
+
+    int jobId = 0;
+    if (!argv.isEmpty()) {
+        JobScheduler::JobSpec spec;
+        spec.program = argv.takeFirst();
+        spec.arguments = argv;
+        spec.tag = run.workflowId + "/" + definition.id;
+        spec.pool = state.action.pool;
+        spec.limits = state.action.limits;
+        jobId = m_scheduler->submit(spec);
+    }
+    if (jobId <= 0) {
+        qWarning() << "Workflow" << run.workflowId << "step" << definition.id << "could not be queued";
+        return false;
+    }
+
+    state.status = StepState::Running;
+    state.jobId = jobId;
+    ++run.running;
+    m_jobSteps.insert(jobId, { run.id, step });
+
+    qDebug() << "Workflow" << run.workflowId << "step" << definition.id
+             << "attempt" << state.attempts << "job" << jobId << ":" << command;
+    emit stepStarted(run.id, definition.id, jobId);
+    return true;
+}
+
+void WorkflowRunner::settleStep(Run &run, int step, bool success)
+{
+    StepState &state = run.steps[step];
+    const WorkflowStep &definition = run.definition.steps.at(step);
+
+    if (!success && definition.onFailure == WorkflowStep::Retry
+        && state.attempts <= definition.retries && !run.stopping) {
+        qDebug() << "Workflow" << run.workflowId << "retrying step" << definition.id;
+        state.status = StepState::Pending;
+        return;
+    }
+
+    state.status = success ? StepState::Succeeded : StepState::Failed;
+    run.variables.insert(definition.id + ".status", success ? "succeeded" : "failed");
+
+    if (success || definition.onFailure == WorkflowStep::Continue) {
+        for (int dependent : std::as_const(state.dependents))
+            --run.steps[dependent].waitingOn;
+        return;
+    }
+
+    run.failed = true;
+    run.stopping = true;
+}
+
+void WorkflowRunner::completeStep(int jobId, bool success, int exitCode)
+{
+    auto job = m_jobSteps.constFind(jobId);
+    if (job == m_jobSteps.constEnd()) return;
+
+    const auto [runId, step] = job.value();
+    m_jobSteps.erase(job);
+
+    auto it = m_runs.find(runId);
+    if (it == m_runs.end()) return;
+    Run &run = it.value();
+
+    const QString stepId = run.definition.steps.at(step).id;
+    run.steps[step].jobId = 0;
+    --run.running;
+
+    // Later steps read these as {step.exit_code} and {step.output}
+    run.variables.insert(stepId + ".exit_code", exitCode);
+    if (const auto output = m_scheduler->output(jobId))
+        run.variables.insert(stepId + ".output",
+                             QString::fromLocal8Bit(output->standardOutput.contents()).trimmed());
+
+    settleStep(run, step, success);
+    emit stepFinished(runId, stepId, success, exitCode);
+
+    it = m_runs.find(runId);
+    if (it != m_runs.end()) advance(it.value());
+}
+
+void WorkflowRunner::finishRun(int runId)
+{
+    Run run = m_runs.take(runId);
+
+    int skipped = 0;
+    for (StepState &state : run.steps) {
+        if (state.status == StepState::Pending) {
+            state.status = StepState::Skipped;
+            ++skipped;
+        }
+    }
+
+    qDebug() << "Workflow" << run.workflowId << "finished, success:" << !run.failed << "skipped steps:" << skipped;
+    emit workflowFinished(runId, run.workflowId, !run.failed);
+}
@@ -0,0 +1,101 @@
+#ifndef WORKFLOWRUNNER_H
+#define WORKFLOWRUNNER_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QPair>
+#include <QProcess>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+#include "actiondefinition.h"
+
+class ActionManager;
+class JobScheduler;
+
+// One node of a "workflow" action. The step runs another catalog action;
+// its inputs may refer to earlier steps as {step.exit_code} and {step.output}.
+struct WorkflowStep
+{
+    enum FailurePolicy {
+        Stop,     // Start nothing new, let running steps finish
+        Continue, // Treat the failure as done and keep going
+        Retry     // Run again up to `retries` times, then stop
+    };
+
+    QString id;
+    QString action;
+    QStringList after;
+    QVariantMap inputs;
+    FailurePolicy onFailure = Stop;
+    int retries = 0;
+};
+
+struct WorkflowDefinition
+{
+    QVector<WorkflowStep> steps;
+    int maxParallel = 0; // 0 leaves the limit to the job scheduler
+
+    // Validates ids and dependencies and rejects cycles
+    static bool fromJson(const QJsonObject &object, WorkflowDefinition *workflow, QString *error);
+};
+
+// Executes workflow actions as a DAG on the job scheduler. Independent
+// steps run concurrently up to the workflow's max_parallel; a step starts
+// as soon as every step it depends on has completed.
+class WorkflowRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    WorkflowRunner(const ActionManager *actions, JobScheduler *scheduler, QObject *parent = nullptr);
+
+    // Returns a run id, or 0 with *error set when the workflow is invalid
+    int start(const ActionDefinition &workflow, const QVariantMap &inputs, QString *error = nullptr);
+    bool cancel(int runId);
+    bool isRunning(int runId) const;
+
+signals:
+    void workflowStarted(int runId, const QString &workflowId);
+    void stepStarted(int runId, const QString &stepId, int jobId);
+    void stepFinished(int runId, const QString &stepId, bool success, int exitCode);
+    void workflowFinished(int runId, const QString &workflowId, bool success);
+
+private:
+    struct StepState {
+        enum Status { Pending, Running, Succeeded, Failed, Skipped };
+        Status status = Pending;
+        ActionDefinition action; // Resolved when the run starts
+        int attempts = 0;
+        int jobId = 0;
+        int waitingOn = 0; // Dependencies not completed yet
+        QVector<int> dependents;
+    };
+
+    struct Run {
+        int id = 0;
+        QString workflowId;
+        WorkflowDefinition definition;
+        QVector<StepState> steps;
+        QVariantMap variables; // Workflow inputs plus step results
+        int running = 0;
+        bool stopping = false;
+        bool failed = false;
+    };
+
+    const ActionManager *m_actions;
+    JobScheduler *m_scheduler;
+    QHash<int, Run> m_runs;
+    QHash<int, QPair<int, int>> m_jobSteps; // job id -> (run id, step index)
+    int m_nextRunId = 1;
+
+    void advance(Run &run);
+    bool startStep(Run &run, int step);
+    void settleStep(Run &run, int step, bool success);
+    void completeStep(int jobId, bool success, int exitCode);
+    void finishRun(int runId);
+};
+
+#endif // WORKFLOWRUNNER_H